@@ -0,0 +1,34 @@
+#include <stdint.h>
+#include "xip_bench.h"
+#include "latency_bench.h"
+#include "sched_bench.h"
+#include "dsp_bench.h"
+
+/* ── Benchmark firmware ──────────────────────────────────────────────────────
+   Built by `make bench` into a separate pico-baremetal-bench.uf2. It shares
+   startup, clocks and boot2 with the application, so it measures exactly
+   what the application would see, but replaces main() with a run of every
+   benchmark.
+
+   Results stay in RAM. Read them over SWD once bench_done is 1:
+       (gdb) print bench_done
+       (gdb) print xip_report
+       (gdb) print latency_report
+       (gdb) print dsp_report
+       (gdb) print sched_report
+   ────────────────────────────────────────────────────────────────────────── */
+struct xip_bench_report xip_report;
+struct latency_bench_report latency_report;
+struct dsp_bench_report dsp_report;
+struct sched_bench_report sched_report;
+volatile uint32_t bench_done;
+
+int main(void) {
+    xip_bench_run(&xip_report);
+    latency_bench_run(&latency_report);
+    dsp_bench_run(&dsp_report);
+
+    /* Last: it hands the CPU to the scheduler for good, and sets
+       bench_done from a task once it has finished                         */
+    sched_bench_start(&sched_report, &bench_done);
+}
@@ -0,0 +1,217 @@
+#include <stdint.h>
+#include "rp2040.h"
+#include "clocks.h"
+#include "sections.h"
+#include "dsp.h"
+#include "dsp_bench.h"
+
+#define BLOCK                   DSP_BENCH_BLOCK
+#define CALLS                   DSP_BENCH_SCALAR_CALLS
+
+static uint16_t adc_block[BLOCK];
+static q15_t in[BLOCK];
+static q15_t out[BLOCK];
+
+static q15_t fir_coeffs[64];
+static q15_t fir_state[2u * 64u];
+static float fir_coeffs_f[16];
+static float fir_state_f[16];
+static float in_f[BLOCK];
+static float out_f[BLOCK];
+
+static q15_t avg_window[16];
+
+/* Results are summed here so the compiler cannot drop the calls            */
+static volatile uint32_t bench_sink;
+
+static uint32_t systick_read_cost(void) {
+    const uint32_t a = SYST_CVR;
+    const uint32_t b = SYST_CVR;
+    return (a - b) & SYST_CVR_MASK;
+}
+
+/* The float reference: a plain delay-line FIR, as it would be written
+   without fixed point                                                      */
+static void fir16_float(const float *x, float *y, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        for (uint32_t k = 15; k; k--) {
+            fir_state_f[k] = fir_state_f[k - 1];
+        }
+        fir_state_f[0] = x[i];
+        float acc = 0.0f;
+        for (uint32_t k = 0; k < 16; k++) {
+            acc += fir_coeffs_f[k] * fir_state_f[k];
+        }
+        y[i] = acc;
+    }
+}
+
+static uint32_t TIME_CRITICAL udiv_calls(void) {
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < CALLS; i++) {
+        sum += (0xFFFFFFFFu - i * 0x01234567u) / (i * 37u + 3u);
+    }
+    return sum;
+}
+
+static uint32_t TIME_CRITICAL isqrt_calls(void) {
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < CALLS; i++) {
+        sum += dsp_isqrt32(i * 0x03FFFFFFu);
+    }
+    return sum;
+}
+
+static uint32_t TIME_CRITICAL atan2_calls(void) {
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < CALLS; i++) {
+        sum += (uint16_t)q15_atan2(in[i], in[i + CALLS]);
+    }
+    return sum;
+}
+
+static uint32_t TIME_CRITICAL magnitude_calls(void) {
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < CALLS; i++) {
+        sum += (uint16_t)q15_magnitude(in[i], in[i + CALLS]);
+    }
+    return sum;
+}
+
+enum kernel {
+    K_FROM_ADC,
+    K_FIR16,
+    K_FIR64,
+    K_FIR16_FLOAT,
+    K_BIQUAD_X2,
+    K_MOVING_AVG16,
+    K_MOVING_AVG10,
+    K_UDIV,
+    K_ISQRT32,
+    K_ATAN2,
+    K_MAGNITUDE,
+};
+
+static struct q15_fir fir;
+static struct q15_biquad biquad[2];
+static struct q15_moving_avg avg;
+
+/* Set up the kernel's state before each pass, outside the timed region     */
+static void prepare(enum kernel k) {
+    switch (k) {
+    case K_FIR16:
+        q15_fir_init(&fir, fir_coeffs, 16, fir_state);
+        break;
+    case K_FIR64:
+        q15_fir_init(&fir, fir_coeffs, 64, fir_state);
+        break;
+    case K_BIQUAD_X2:
+        /* Butterworth low-pass at fs/8, split into two sections            */
+        q15_biquad_init(&biquad[0], Q14(0.0299), Q14(0.0598), Q14(0.0299),
+                        Q14(-1.3658), Q14(0.4855));
+        q15_biquad_init(&biquad[1], Q14(0.0299), Q14(0.0598), Q14(0.0299),
+                        Q14(-1.6889), Q14(0.8125));
+        break;
+    case K_MOVING_AVG16:
+        q15_moving_avg_init(&avg, avg_window, 16);
+        break;
+    case K_MOVING_AVG10:
+        q15_moving_avg_init(&avg, avg_window, 10);
+        break;
+    default:
+        break;
+    }
+}
+
+static void execute(enum kernel k) {
+    switch (k) {
+    case K_FROM_ADC:
+        q15_from_adc(adc_block, out, BLOCK);
+        break;
+    case K_FIR16:
+    case K_FIR64:
+        q15_fir_process(&fir, in, out, BLOCK);
+        break;
+    case K_FIR16_FLOAT:
+        fir16_float(in_f, out_f, BLOCK);
+        break;
+    case K_BIQUAD_X2:
+        q15_biquad_process(biquad, 2, in, out, BLOCK);
+        break;
+    case K_MOVING_AVG16:
+    case K_MOVING_AVG10:
+        q15_moving_avg_process(&avg, in, out, BLOCK);
+        break;
+    case K_UDIV:
+        bench_sink += udiv_calls();
+        break;
+    case K_ISQRT32:
+        bench_sink += isqrt_calls();
+        break;
+    case K_ATAN2:
+        bench_sink += atan2_calls();
+        break;
+    case K_MAGNITUDE:
+        bench_sink += magnitude_calls();
+        break;
+    }
+}
+
+static void measure(struct dsp_bench_result *r, enum kernel k,
+                    uint32_t count, uint32_t overhead) {
+    uint32_t best = 0xFFFFFFFFu;
+
+    for (uint32_t run = 0; run < DSP_BENCH_RUNS; run++) {
+        prepare(k);
+        const uint32_t start = SYST_CVR;
+        execute(k);
+        const uint32_t cycles = (start - SYST_CVR) & SYST_CVR_MASK;
+        if (cycles < best) {
+            best = cycles;
+        }
+    }
+    r->cycles = best > overhead ? best - overhead : 0;
+    r->cycles_per_sample = r->cycles / count;
+}
+
+void dsp_bench_run(struct dsp_bench_report *report) {
+    /* A noisy ramp: any inputs will do, but not all zero, which would let
+       the float reference skip most of its work                            */
+    uint32_t x = 0x2545F491u;
+    for (uint32_t i = 0; i < BLOCK; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        adc_block[i] = (uint16_t)((i * 16u + (x & 0xFFu)) & 0xFFFu);
+        in[i] = (q15_t)(((int32_t)adc_block[i] - 2048) * 16);
+        in_f[i] = (float)in[i] * (1.0f / 32768.0f);
+    }
+    for (uint32_t k = 0; k < 64; k++) {
+        fir_coeffs[k] = (q15_t)(Q15(1.0 / 64.0) + (int32_t)k * 8);
+    }
+    for (uint32_t k = 0; k < 16; k++) {
+        fir_coeffs_f[k] = (float)fir_coeffs[k] * (1.0f / 32768.0f);
+        fir_state_f[k] = 0.0f;
+    }
+
+    /* Free-running cycle counter, no interrupt                             */
+    SYST_RVR = SYST_CVR_MASK;
+    SYST_CVR = 0;
+    SYST_CSR = SYST_CSR_CLKSOURCE | SYST_CSR_ENABLE;
+
+    report->clk_sys_hz = clock_get_hz(CLK_SYS);
+    report->overhead_cycles = systick_read_cost();
+    const uint32_t overhead = report->overhead_cycles;
+
+    measure(&report->from_adc,     K_FROM_ADC,     BLOCK, overhead);
+    measure(&report->fir16,        K_FIR16,        BLOCK, overhead);
+    measure(&report->fir64,        K_FIR64,        BLOCK, overhead);
+    measure(&report->fir16_float,  K_FIR16_FLOAT,  BLOCK, overhead);
+    measure(&report->biquad_x2,    K_BIQUAD_X2,    BLOCK, overhead);
+    measure(&report->moving_avg16, K_MOVING_AVG16, BLOCK, overhead);
+    measure(&report->moving_avg10, K_MOVING_AVG10, BLOCK, overhead);
+    measure(&report->udiv,         K_UDIV,         CALLS, overhead);
+    measure(&report->isqrt32,      K_ISQRT32,      CALLS, overhead);
+    measure(&report->atan2,        K_ATAN2,        CALLS, overhead);
+    measure(&report->magnitude,    K_MAGNITUDE,    CALLS, overhead);
+}
@@ -0,0 +1,47 @@
+#ifndef DSP_BENCH_H
+#define DSP_BENCH_H
+
+#include <stdint.h>
+
+/* ── DSP kernel benchmark ────────────────────────────────────────────────────
+   clk_sys cycles for each kernel in src/dsp.h, counted with SysTick as in
+   latency_bench. Block kernels run over one DSP_BENCH_BLOCK-sample block,
+   the size an ADC stream would hand over; scalar functions are timed over
+   DSP_BENCH_SCALAR_CALLS calls on varied inputs. Each figure is the best
+   of DSP_BENCH_RUNS passes, so an interrupt landing in one pass does not
+   count, and has the SysTick read overhead taken off.
+
+   Real time at a given rate needs cycles_per_sample below
+   clk_sys / sample rate: 250 cycles at 500 ksps and 125 MHz.
+
+   fir16_float runs the same 16-tap filter in float, as a reference for
+   what the soft-float ABI costs.
+   ────────────────────────────────────────────────────────────────────────── */
+#define DSP_BENCH_BLOCK         256u
+#define DSP_BENCH_SCALAR_CALLS  64u
+#define DSP_BENCH_RUNS          8u
+
+struct dsp_bench_result {
+    uint32_t cycles;                /* whole block / all calls              */
+    uint32_t cycles_per_sample;     /* per sample / per call                */
+};
+
+struct dsp_bench_report {
+    uint32_t clk_sys_hz;
+    uint32_t overhead_cycles;
+    struct dsp_bench_result from_adc;
+    struct dsp_bench_result fir16;
+    struct dsp_bench_result fir64;
+    struct dsp_bench_result fir16_float;
+    struct dsp_bench_result biquad_x2;      /* two cascaded sections        */
+    struct dsp_bench_result moving_avg16;   /* shift                        */
+    struct dsp_bench_result moving_avg10;   /* hardware divider             */
+    struct dsp_bench_result udiv;           /* one '/' through divider.S    */
+    struct dsp_bench_result isqrt32;
+    struct dsp_bench_result atan2;
+    struct dsp_bench_result magnitude;
+};
+
+void dsp_bench_run(struct dsp_bench_report *report);
+
+#endif
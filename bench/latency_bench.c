@@ -0,0 +1,197 @@
+#include <stdint.h>
+#include "rp2040.h"
+#include "clocks.h"
+#include "irq.h"
+#include "sections.h"
+#include "gpio.h"
+#include "xip.h"
+#include "latency_bench.h"
+
+#if !RAM_VECTOR_TABLE
+#error "latency_bench swaps handlers at runtime and needs RAM_VECTOR_TABLE=1"
+#endif
+
+#define PIN                     LATENCY_BENCH_PIN
+#define PIN_MASK                (1u << PIN)
+#define PIN_EDGE                GPIO_IRQ_EDGE_RISE(PIN)
+
+/* NVIC lines 26-31 exist but no peripheral drives them. Software can still
+   pend one, which makes it a handy interrupt to trigger the edge from.    */
+#define SPARE_IRQ               ((enum irq_num)26)
+
+static volatile uint32_t entry_cvr;
+static volatile uint32_t trigger_cvr;
+static volatile uint32_t fired;
+
+static uint16_t samples[LATENCY_BENCH_SAMPLES];
+
+/* ── The handler under test ──────────────────────────────────────────────────
+   Two copies of one body: only where the code lives differs. The SysTick
+   read is the first thing each does; the rest acknowledges the edge.
+   ────────────────────────────────────────────────────────────────────────── */
+#define LATENCY_HANDLER_BODY()          \
+    do {                                \
+        entry_cvr = SYST_CVR;           \
+        gpio_clr_mask(PIN_MASK);        \
+        IO_INTR(PIN) = PIN_EDGE;        \
+        fired = 1;                      \
+    } while (0)
+
+static void TIME_CRITICAL latency_handler_ram(void) {
+    LATENCY_HANDLER_BODY();
+}
+
+static void __attribute__((noinline)) latency_handler_flash(void) {
+    LATENCY_HANDLER_BODY();
+}
+
+/* Read SysTick, raise the pin; the timestamp is stored only after the SIO
+   write so nothing sits between the two. Runs from RAM so flushing the XIP
+   cache affects only the handler.                                          */
+static void TIME_CRITICAL trigger(void) {
+    const uint32_t start = SYST_CVR;
+    gpio_set_mask(PIN_MASK);
+    trigger_cvr = start;
+}
+
+/* Spare interrupt handlers. For preempt, stay in the handler until the
+   edge's handler has run, so it really has to preempt; for tail_chain,
+   return at once and let the edge's handler follow.                       */
+static void TIME_CRITICAL spare_handler_wait(void) {
+    trigger();
+    while (!fired);
+}
+
+static void TIME_CRITICAL spare_handler_return(void) {
+    trigger();
+}
+
+static uint32_t TIME_CRITICAL systick_read_cost(void) {
+    const uint32_t a = SYST_CVR;
+    const uint32_t b = SYST_CVR;
+    return (a - b) & SYST_CVR_MASK;
+}
+
+static uint32_t TIME_CRITICAL sample_from_thread(int flush_cache) {
+    fired = 0;
+    if (flush_cache) {
+        xip_cache_flush();
+    }
+
+    trigger();
+    while (!fired);
+
+    return (trigger_cvr - entry_cvr) & SYST_CVR_MASK;
+}
+
+static uint32_t TIME_CRITICAL sample_from_spare_irq(void) {
+    fired = 0;
+    irq_set_pending(SPARE_IRQ);
+    while (!fired);
+
+    return (trigger_cvr - entry_cvr) & SYST_CVR_MASK;
+}
+
+static void summarise(struct latency_bench_result *r, uint32_t overhead) {
+    uint32_t min = 0xFFFFFFFFu;
+    uint32_t max = 0;
+    uint32_t sum = 0;
+
+    for (uint32_t i = 0; i < LATENCY_BENCH_SAMPLES; i++) {
+        const uint32_t s = samples[i] > overhead ? samples[i] - overhead : 0;
+        samples[i] = (uint16_t)s;
+        sum += s;
+        if (s < min) {
+            min = s;
+        }
+        if (s > max) {
+            max = s;
+        }
+    }
+
+    r->min_cycles    = min;
+    r->max_cycles    = max;
+    r->mean_cycles   = sum / LATENCY_BENCH_SAMPLES;
+    r->jitter_cycles = max - min;
+
+    for (uint32_t b = 0; b < LATENCY_BENCH_BINS; b++) {
+        r->hist[b] = 0;
+    }
+    for (uint32_t i = 0; i < LATENCY_BENCH_SAMPLES; i++) {
+        uint32_t bin = (samples[i] - min) / LATENCY_BENCH_BIN_CYCLES;
+        if (bin >= LATENCY_BENCH_BINS) {
+            bin = LATENCY_BENCH_BINS - 1;
+        }
+        r->hist[bin]++;
+    }
+}
+
+/* One untimed sample first, so every scenario starts from the same state
+   (handler installed, its cache lines resident if it is going to be)       */
+static void run_thread(struct latency_bench_result *r, uint32_t overhead,
+                       int flush_cache) {
+    (void)sample_from_thread(flush_cache);
+    for (uint32_t i = 0; i < LATENCY_BENCH_SAMPLES; i++) {
+        samples[i] = (uint16_t)sample_from_thread(flush_cache);
+    }
+    summarise(r, overhead);
+}
+
+static void run_spare_irq(struct latency_bench_result *r, uint32_t overhead) {
+    (void)sample_from_spare_irq();
+    for (uint32_t i = 0; i < LATENCY_BENCH_SAMPLES; i++) {
+        samples[i] = (uint16_t)sample_from_spare_irq();
+    }
+    summarise(r, overhead);
+}
+
+void latency_bench_run(struct latency_bench_report *report) {
+    unreset_block_wait(RESET_IO_BANK0 | RESET_PADS_BANK0);
+
+    gpio_clr_mask(PIN_MASK);
+    gpio_set_function(PIN, GPIO_FUNC_SIO);  /* also enables the pad input */
+    gpio_set_dir_out_masked(PIN_MASK);
+
+    IO_INTR(PIN) = PIN_EDGE;
+    IO_PROC0_INTE_SET(PIN) = PIN_EDGE;
+
+    /* Free-running cycle counter, no interrupt                             */
+    SYST_RVR = SYST_CVR_MASK;
+    SYST_CVR = 0;
+    SYST_CSR = SYST_CSR_CLKSOURCE | SYST_CSR_ENABLE;
+
+    report->clk_sys_hz = clock_get_hz(CLK_SYS);
+    report->overhead_cycles = systick_read_cost();
+    const uint32_t overhead = report->overhead_cycles;
+
+    /* The spare line's vector is 0 in the Flash table: install a handler
+       before enabling it                                                    */
+    irq_set_handler(SPARE_IRQ, spare_handler_wait);
+    irq_set_enabled(SPARE_IRQ, 1);
+
+    irq_set_handler(IO_IRQ_BANK0, latency_handler_ram);
+    irq_set_enabled(IO_IRQ_BANK0, 1);
+    run_thread(&report->ram, overhead, 0);
+
+    irq_set_handler(IO_IRQ_BANK0, latency_handler_flash);
+    run_thread(&report->flash_warm, overhead, 0);
+    run_thread(&report->flash_cold, overhead, 1);
+
+    irq_set_handler(IO_IRQ_BANK0, latency_handler_ram);
+    irq_set_priority(IO_IRQ_BANK0, IRQ_PRIORITY_HIGHEST);
+    irq_set_priority(SPARE_IRQ, IRQ_PRIORITY_LOWEST);
+    run_spare_irq(&report->preempt, overhead);
+
+    irq_set_priority(IO_IRQ_BANK0, IRQ_PRIORITY_LOWEST);
+    irq_set_priority(SPARE_IRQ, IRQ_PRIORITY_HIGHEST);
+    irq_set_handler(SPARE_IRQ, spare_handler_return);
+    run_spare_irq(&report->tail_chain, overhead);
+
+    /* Leave nothing behind for the next benchmark                          */
+    irq_set_enabled(IO_IRQ_BANK0, 0);
+    irq_set_enabled(SPARE_IRQ, 0);
+    irq_set_priority(IO_IRQ_BANK0, IRQ_PRIORITY_DEFAULT);
+    irq_set_priority(SPARE_IRQ, IRQ_PRIORITY_DEFAULT);
+    IO_PROC0_INTE_CLR(PIN) = PIN_EDGE;
+    gpio_set_dir_in_masked(PIN_MASK);
+}
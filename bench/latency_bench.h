@@ -0,0 +1,57 @@
+#ifndef LATENCY_BENCH_H
+#define LATENCY_BENCH_H
+
+#include <stdint.h>
+
+/* ── Interrupt latency benchmark ─────────────────────────────────────────────
+   Measures the time from a hardware event to the first instruction of its
+   handler, in clk_sys cycles.
+
+   The event is a rising edge on LATENCY_BENCH_PIN, raised by the CPU itself
+   through SIO: the pad's input sees its own output, and IO_BANK0 turns the
+   edge into IO_IRQ_BANK0. SysTick is read just before the SIO write and
+   again as the handler's first action. That path includes the GPIO input
+   synchroniser (2 cycles) and is timed with SysTick rather than the 1 µs
+   TIMER, which is far too coarse for a ~20-cycle interval.
+
+   Each scenario changes one thing, so the difference between two of them
+   is the cost of that thing:
+   - ram:        handler in SRAM, triggered from thread mode
+   - flash_warm: same handler code in flash, XIP cache already holding it
+   - flash_cold: flash handler with the XIP cache flushed before each edge
+   - preempt:    RAM handler at high priority, triggered from inside a
+                 low-priority handler it has to preempt
+   - tail_chain: RAM handler at low priority, triggered from a
+                 high-priority handler that returns straight away — the
+                 edge waits for it, then the core tail-chains in
+   ────────────────────────────────────────────────────────────────────────── */
+#define LATENCY_BENCH_PIN       15u     /* unconnected on the Pico board    */
+#define LATENCY_BENCH_SAMPLES   256u
+#define LATENCY_BENCH_BINS      16u
+#define LATENCY_BENCH_BIN_CYCLES 2u     /* histogram resolution             */
+
+struct latency_bench_result {
+    uint32_t min_cycles;
+    uint32_t max_cycles;
+    uint32_t mean_cycles;
+    uint32_t jitter_cycles;             /* max - min                        */
+    /* hist[i] counts samples in [min + 2i, min + 2i + 2); the last bin
+       also takes everything beyond                                         */
+    uint16_t hist[LATENCY_BENCH_BINS];
+};
+
+struct latency_bench_report {
+    uint32_t clk_sys_hz;
+    uint32_t overhead_cycles;           /* subtracted from every sample:
+                                           the cost of one SysTick read     */
+    struct latency_bench_result ram;
+    struct latency_bench_result flash_warm;
+    struct latency_bench_result flash_cold;
+    struct latency_bench_result preempt;
+    struct latency_bench_result tail_chain;
+};
+
+/* Needs RAM_VECTOR_TABLE=1: handlers are swapped with irq_set_handler().   */
+void latency_bench_run(struct latency_bench_report *report);
+
+#endif
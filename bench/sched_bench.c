@@ -0,0 +1,69 @@
+#include <stdint.h>
+#include "rp2040.h"
+#include "clocks.h"
+#include "sched.h"
+#include "sched_bench.h"
+
+#define ROUND_TRIPS         1000u
+#define BENCH_STACK_WORDS   128u
+
+static struct task ping_task;
+static struct task pong_task;
+static uint32_t ping_stack[BENCH_STACK_WORDS] __attribute__((aligned(8)));
+static uint32_t pong_stack[BENCH_STACK_WORDS] __attribute__((aligned(8)));
+
+static struct sched_bench_report *bench_report;
+static volatile uint32_t *bench_done_flag;
+static volatile int ping_finished;
+
+static void ping(void *arg) {
+    (void)arg;
+
+    /* Hand over once first so pong is in its loop before timing starts    */
+    task_yield();
+
+    const uint32_t start = SYST_CVR;
+    for (uint32_t i = 0; i < ROUND_TRIPS; i++) {
+        task_yield();
+    }
+    const uint32_t end = SYST_CVR;
+    ping_finished = 1;
+
+    /* SysTick counts down; a 24-bit wrap is absorbed by the mask. 2000
+       switches are far below one wrap (~134 ms at 125 MHz).                */
+    struct sched_bench_report *r = bench_report;
+    r->clk_sys_hz        = clock_get_hz(CLK_SYS);
+    r->round_trips       = ROUND_TRIPS;
+    r->total_cycles      = (start - end) & SYST_CVR_MASK;
+    r->cycles_per_switch = r->total_cycles / (2u * ROUND_TRIPS);
+    r->ping_stack_unused = task_stack_unused_words(&ping_task);
+    r->pong_stack_unused = task_stack_unused_words(&pong_task);
+
+    *bench_done_flag = 1;
+}
+
+static void pong(void *arg) {
+    (void)arg;
+
+    while (!ping_finished) {
+        task_yield();
+    }
+}
+
+void sched_bench_start(struct sched_bench_report *report,
+                       volatile uint32_t *done) {
+    bench_report = report;
+    bench_done_flag = done;
+
+    /* Free-running cycle counter, no interrupt                             */
+    SYST_RVR = SYST_CVR_MASK;
+    SYST_CVR = 0;
+    SYST_CSR = SYST_CSR_CLKSOURCE | SYST_CSR_ENABLE;
+
+    task_create(&ping_task, "ping", ping, 0,
+                ping_stack, BENCH_STACK_WORDS, 1);
+    task_create(&pong_task, "pong", pong, 0,
+                pong_stack, BENCH_STACK_WORDS, 1);
+
+    sched_start();
+}
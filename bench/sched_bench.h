@@ -0,0 +1,25 @@
+#ifndef SCHED_BENCH_H
+#define SCHED_BENCH_H
+
+#include <stdint.h>
+
+/* ── Context switch benchmark ────────────────────────────────────────────────
+   Two tasks of equal priority hand the CPU back and forth with task_yield().
+   Each round trip is two full PendSV switches plus two yield calls, timed
+   in clk_sys cycles with SysTick.
+   ────────────────────────────────────────────────────────────────────────── */
+struct sched_bench_report {
+    uint32_t clk_sys_hz;
+    uint32_t round_trips;
+    uint32_t total_cycles;
+    uint32_t cycles_per_switch;     /* total / (2 * round_trips)          */
+    uint32_t ping_stack_unused;     /* stack watermarks after the run, in  */
+    uint32_t pong_stack_unused;     /* words never touched                 */
+};
+
+/* Start the scheduler and run the benchmark in tasks. Never returns: once
+   the report is filled in, *done is set and the CPU idles.                 */
+void sched_bench_start(struct sched_bench_report *report,
+                       volatile uint32_t *done) __attribute__((noreturn));
+
+#endif
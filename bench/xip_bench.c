@@ -0,0 +1,106 @@
+#include <stdint.h>
+#include "rp2040.h"
+#include "clocks.h"
+#include "sections.h"
+#include "timer.h"
+#include "xip.h"
+#include "xip_bench.h"
+
+/* Read from 1 MiB into flash, well clear of the image itself: what the
+   bytes contain does not matter, only how fast they arrive                  */
+#define BENCH_FLASH_OFFSET          0x00100000u
+#define BENCH_RANDOM_WINDOW         0x00100000u    /* 1 MiB, power of two   */
+
+#define SEQ_BYTES                   (256u * 1024u)
+#define HOT_BYTES                   (8u * 1024u)   /* fits in the 16 KiB cache */
+#define RANDOM_READS                16384u
+
+/* ── SSI (read back what boot2 configured) ───────────────────────────────── */
+#define XIP_SSI_BASE                0x18000000u
+#define SSI_BAUDR                   MMIO32(XIP_SSI_BASE + 0x14)
+#define SSI_RX_SAMPLE_DLY           MMIO32(XIP_SSI_BASE + 0xF0)
+#define SSI_SPI_CTRLR0              MMIO32(XIP_SSI_BASE + 0xF4)
+#define SSI_SPI_CTRLR0_WAIT_CYCLES_LSB  11
+#define SSI_SPI_CTRLR0_WAIT_CYCLES_MASK (0x1Fu << SSI_SPI_CTRLR0_WAIT_CYCLES_LSB)
+
+/* Results are summed here so the compiler cannot drop the reads            */
+static volatile uint32_t bench_sink;
+
+/* The read loops run from RAM: fetching their own instructions through XIP
+   would compete with the very traffic being measured and evict the lines
+   the cached tests rely on.                                                 */
+static uint32_t TIME_CRITICAL read_sequential(uint32_t base, uint32_t bytes) {
+    const volatile uint32_t *p   = (const volatile uint32_t *)base;
+    const volatile uint32_t *end = p + bytes / 4u;
+    uint32_t sum = 0;
+
+    while (p < end) {
+        sum += p[0];
+        sum += p[1];
+        sum += p[2];
+        sum += p[3];
+        p += 4;
+    }
+    return sum;
+}
+
+static uint32_t TIME_CRITICAL read_random(uint32_t base, uint32_t reads) {
+    uint32_t x   = 0x2545F491u;   /* xorshift32 seed: any nonzero value    */
+    uint32_t sum = 0;
+
+    for (uint32_t i = 0; i < reads; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        sum += MMIO32(base + (x & (BENCH_RANDOM_WINDOW - 4u)));
+    }
+    return sum;
+}
+
+static void finish(struct xip_bench_result *r, uint32_t bytes,
+                   uint32_t start_us) {
+    r->elapsed_us = time_us_32() - start_us;
+    r->bytes      = bytes;
+    r->kib_per_s  = r->elapsed_us
+                  ? (uint32_t)(((uint64_t)bytes * 1000000u / 1024u)
+                               / r->elapsed_us)
+                  : 0;
+}
+
+void xip_bench_run(struct xip_bench_report *report) {
+    const uint32_t cached   = XIP_BASE + BENCH_FLASH_OFFSET;
+    const uint32_t uncached = XIP_NOCACHE_NOALLOC_BASE + BENCH_FLASH_OFFSET;
+    uint32_t start;
+
+    report->clk_sys_hz      = clock_get_hz(CLK_SYS);
+    report->clkdiv          = SSI_BAUDR;
+    report->rx_sample_delay = SSI_RX_SAMPLE_DLY;
+    report->wait_cycles     = (SSI_SPI_CTRLR0 & SSI_SPI_CTRLR0_WAIT_CYCLES_MASK)
+                            >> SSI_SPI_CTRLR0_WAIT_CYCLES_LSB;
+
+    start = time_us_32();
+    bench_sink += read_sequential(uncached, SEQ_BYTES);
+    finish(&report->seq_uncached, SEQ_BYTES, start);
+
+    xip_cache_flush();
+    start = time_us_32();
+    bench_sink += read_sequential(cached, SEQ_BYTES);
+    finish(&report->seq_cold_cache, SEQ_BYTES, start);
+
+    bench_sink += read_sequential(cached, HOT_BYTES);
+    start = time_us_32();
+    bench_sink += read_sequential(cached, HOT_BYTES);
+    finish(&report->seq_hot_cache, HOT_BYTES, start);
+
+    start = time_us_32();
+    bench_sink += read_random(uncached, RANDOM_READS);
+    finish(&report->random_uncached, RANDOM_READS * 4u, start);
+
+    xip_cache_flush();
+    start = time_us_32();
+    bench_sink += read_random(cached, RANDOM_READS);
+    finish(&report->random_cached, RANDOM_READS * 4u, start);
+
+    /* Leave the cache clean for whatever runs next                          */
+    xip_cache_flush();
+}
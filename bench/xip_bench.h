@@ -0,0 +1,41 @@
+#ifndef XIP_BENCH_H
+#define XIP_BENCH_H
+
+#include <stdint.h>
+
+/* ── XIP read throughput benchmark ───────────────────────────────────────────
+   Measures how fast the CPU can pull data out of external flash through the
+   XIP window with the QSPI settings boot2 was built with (FLASH_PROFILE in
+   the Makefile). Build and flash once per profile, then compare reports.
+   ────────────────────────────────────────────────────────────────────────── */
+struct xip_bench_result {
+    uint32_t bytes;           /* bytes read                                 */
+    uint32_t elapsed_us;      /* wall time for the whole pass               */
+    uint32_t kib_per_s;       /* bytes / elapsed, in KiB per second         */
+};
+
+struct xip_bench_report {
+    /* QSPI configuration actually found in the SSI at runtime              */
+    uint32_t clk_sys_hz;
+    uint32_t clkdiv;          /* SCK = clk_sys / clkdiv                     */
+    uint32_t rx_sample_delay;
+    uint32_t wait_cycles;
+
+    /* Sequential word reads that bypass the cache: one QSPI transfer per
+       word, so this is bound by per-transfer latency                       */
+    struct xip_bench_result seq_uncached;
+    /* Sequential reads through a freshly flushed cache: every 8-byte line
+       is a miss — the speed of streaming code or tables that do not fit   */
+    struct xip_bench_result seq_cold_cache;
+    /* The same 8 KiB read twice; the second pass is timed and all hits    */
+    struct xip_bench_result seq_hot_cache;
+    /* Pseudo-random word reads over 1 MiB, bypassing the cache            */
+    struct xip_bench_result random_uncached;
+    /* Pseudo-random word reads over 1 MiB through the cache (mostly misses,
+       each one filling a whole 8-byte line)                                */
+    struct xip_bench_result random_cached;
+};
+
+void xip_bench_run(struct xip_bench_report *report);
+
+#endif
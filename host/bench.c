@@ -0,0 +1,290 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "rp2040.h"
+#include "spsc.h"
+#include "sched.h"
+#include "kv.h"
+#include "dsp.h"
+#include "host.h"
+
+/* ── Host microbenchmarks ────────────────────────────────────────────────────
+   The same kernels bench/ measures in cycles on the target, timed here in
+   host nanoseconds; each result is the best of BENCH_RUNS runs, which
+   filters out most scheduling noise. Host time says nothing about M0+
+   cycles, but it moves when the code does: an accidental O(n^2), a lost
+   fast path or a kernel that stopped unrolling all show up as a jump.
+
+   A few results are counts rather than times — flash pages written per
+   kv_set(), erases per thousand sets — and are exact on any machine.
+
+   Each result is printed as
+       B <name> <value> <unit> <limit> OK|FAIL
+   against the limit for <name> in the thresholds file ("-" if it has
+   none). The file holds "<name> <max>" lines; # starts a comment.
+   ────────────────────────────────────────────────────────────────────────── */
+#define BENCH_RUNS              7u
+#define MAX_THRESHOLDS          64u
+
+struct threshold {
+    char name[32];
+    double max;
+};
+
+static struct threshold thresholds[MAX_THRESHOLDS];
+static uint32_t threshold_count;
+static uint32_t over_threshold;
+
+static int load_thresholds(const char *path) {
+    FILE *f = fopen(path, "r");
+    char line[128];
+
+    if (!f) {
+        fprintf(stderr, "host-sim: cannot open %s\n", path);
+        return -1;
+    }
+    while (fgets(line, sizeof line, f)) {
+        struct threshold *t = &thresholds[threshold_count];
+        char *hash = strchr(line, '#');
+        if (hash) {
+            *hash = '\0';
+        }
+        if (threshold_count < MAX_THRESHOLDS
+                && sscanf(line, "%31s %lf", t->name, &t->max) == 2) {
+            threshold_count++;
+        }
+    }
+    fclose(f);
+    return 0;
+}
+
+static void report(const char *name, double value, const char *unit) {
+    for (uint32_t i = 0; i < threshold_count; i++) {
+        if (strcmp(thresholds[i].name, name) == 0) {
+            const int ok = value <= thresholds[i].max;
+            printf("B %-20s %10.2f %-10s %10.2f %s\n", name, value, unit,
+                   thresholds[i].max, ok ? "OK" : "FAIL");
+            over_threshold += !ok;
+            return;
+        }
+    }
+    printf("B %-20s %10.2f %-10s %10s -\n", name, value, unit, "-");
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/* Best of BENCH_RUNS calls of fn(), divided by the operations each does    */
+static double best_ns_per_op(void (*fn)(void), uint32_t ops) {
+    uint64_t best = UINT64_MAX;
+
+    for (uint32_t run = 0; run < BENCH_RUNS; run++) {
+        const uint64_t start = now_ns();
+        fn();
+        const uint64_t elapsed = now_ns() - start;
+        best = elapsed < best ? elapsed : best;
+    }
+    return (double)best / ops;
+}
+
+/* Results the compiler must not see unused                                 */
+static volatile uint32_t sink;
+
+/* ── SPSC queue ──────────────────────────────────────────────────────────── */
+#define SPSC_OPS                1000000u
+
+static struct spsc_queue queue;
+static void *queue_slots[64];
+
+static void run_spsc(void) {
+    void *item = 0;
+    uint32_t sum = 0;
+
+    for (uintptr_t i = 0; i < SPSC_OPS; i++) {
+        spsc_try_push(&queue, (void *)i);
+        spsc_try_pop(&queue, &item);
+        sum += (uint32_t)(uintptr_t)item;
+    }
+    sink = sum;
+}
+
+/* ── KV store ────────────────────────────────────────────────────────────── */
+#define KV_BENCH_KEYS           32u
+#define KV_SET_OPS              10000u
+#define KV_GET_OPS              1000000u
+
+static uint32_t kv_round;
+
+static void run_kv_set(void) {
+    uint32_t value[4];
+
+    for (uint32_t i = 0; i < KV_SET_OPS; i++) {
+        value[0] = ++kv_round;
+        value[1] = value[2] = value[3] = i;
+        kv_set((uint16_t)(i % KV_BENCH_KEYS), value, sizeof value);
+        kv_maintain();
+    }
+}
+
+static void run_kv_get(void) {
+    uint32_t buf[4];
+    uint32_t sum = 0;
+
+    for (uint32_t i = 0; i < KV_GET_OPS; i++) {
+        kv_get((uint16_t)(i % KV_BENCH_KEYS), buf, sizeof buf);
+        sum += buf[0];
+    }
+    sink = sum;
+}
+
+static void bench_kv(void) {
+    host_mmio_reset();
+    host_flash_reset();
+    kv_init();
+
+    /* Counted over one pass from freshly erased flash                      */
+    kv_round = 0;
+    run_kv_set();
+    const struct host_flash_stats *flash = host_flash_get_stats();
+    report("kv_pages_per_set", (double)flash->programs / KV_SET_OPS, "pages");
+    report("kv_erases_per_1k", (double)flash->erases * 1000.0 / KV_SET_OPS,
+           "sectors");
+
+    report("kv_set", best_ns_per_op(run_kv_set, KV_SET_OPS), "ns");
+    report("kv_get", best_ns_per_op(run_kv_get, KV_GET_OPS), "ns");
+}
+
+/* ── Scheduler ───────────────────────────────────────────────────────────────
+   Two ready tasks of equal priority, so every sched_switch() picks the
+   other one. Needs sched_start(), so it only runs in a process that does
+   not also run the scheduler tests.
+   ────────────────────────────────────────────────────────────────────────── */
+#define SWITCH_OPS              1000000u
+
+uint32_t *sched_switch(uint32_t *sp);
+
+static struct task task_a, task_b;
+static uint32_t task_stacks[2][64] __attribute__((aligned(8)));
+
+static void never_runs(void *arg) {
+    (void)arg;
+}
+
+static void run_switch(void) {
+    for (uint32_t i = 0; i < SWITCH_OPS; i++) {
+        sched_switch(task_current()->sp);
+    }
+}
+
+static void bench_sched(void) {
+    host_mmio_reset();
+    task_create(&task_a, "a", never_runs, 0, task_stacks[0], 64, 1);
+    task_create(&task_b, "b", never_runs, 0, task_stacks[1], 64, 1);
+    sched_start();
+
+    report("sched_switch", best_ns_per_op(run_switch, SWITCH_OPS), "ns");
+}
+
+/* ── DSP kernels ─────────────────────────────────────────────────────────── */
+#define DSP_BLOCK               256u
+#define DSP_BLOCKS              400u
+
+static q15_t dsp_in[DSP_BLOCK], dsp_out[DSP_BLOCK];
+static q15_t fir_coeffs[64];
+static q15_t fir_state[2 * 64];
+static q15_t avg_window[16];
+static struct q15_fir fir;
+static struct q15_biquad biquads[2];
+static struct q15_moving_avg avg;
+
+static void run_fir(void) {
+    for (uint32_t b = 0; b < DSP_BLOCKS; b++) {
+        q15_fir_process(&fir, dsp_in, dsp_out, DSP_BLOCK);
+    }
+}
+
+static void run_biquad(void) {
+    for (uint32_t b = 0; b < DSP_BLOCKS; b++) {
+        q15_biquad_process(biquads, 2, dsp_in, dsp_out, DSP_BLOCK);
+    }
+}
+
+static void run_moving_avg(void) {
+    for (uint32_t b = 0; b < DSP_BLOCKS; b++) {
+        q15_moving_avg_process(&avg, dsp_in, dsp_out, DSP_BLOCK);
+    }
+}
+
+static void run_atan2(void) {
+    uint32_t sum = 0;
+    for (uint32_t b = 0; b < DSP_BLOCKS; b++) {
+        for (uint32_t i = 0; i < DSP_BLOCK; i++) {
+            sum += (uint16_t)q15_atan2(dsp_in[i], dsp_in[DSP_BLOCK - 1u - i]);
+        }
+    }
+    sink = sum;
+}
+
+static void run_isqrt(void) {
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < DSP_BLOCKS * DSP_BLOCK; i++) {
+        sum += dsp_isqrt32(i * 40503u);
+    }
+    sink = sum;
+}
+
+static void bench_dsp(void) {
+    const uint32_t samples = DSP_BLOCKS * DSP_BLOCK;
+    uint32_t seed = 1;
+
+    for (uint32_t i = 0; i < DSP_BLOCK; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        dsp_in[i] = (q15_t)(seed >> 16);
+    }
+    for (uint32_t i = 0; i < 64; i++) {
+        fir_coeffs[i] = (q15_t)(Q15(1.0 / 64) + (int32_t)i);
+    }
+
+    q15_fir_init(&fir, fir_coeffs, 16, fir_state);
+    report("fir16", best_ns_per_op(run_fir, samples), "ns/sample");
+    q15_fir_init(&fir, fir_coeffs, 64, fir_state);
+    report("fir64", best_ns_per_op(run_fir, samples), "ns/sample");
+
+    q15_biquad_init(&biquads[0], Q14(0.0675), Q14(0.1349), Q14(0.0675),
+                    Q14(-1.1430), Q14(0.4128));
+    biquads[1] = biquads[0];
+    report("biquad_x2", best_ns_per_op(run_biquad, samples), "ns/sample");
+
+    q15_moving_avg_init(&avg, avg_window, 16);
+    report("moving_avg16", best_ns_per_op(run_moving_avg, samples),
+           "ns/sample");
+    q15_moving_avg_init(&avg, avg_window, 10);
+    report("moving_avg10", best_ns_per_op(run_moving_avg, samples),
+           "ns/sample");
+
+    report("atan2", best_ns_per_op(run_atan2, samples), "ns");
+    report("isqrt", best_ns_per_op(run_isqrt, samples), "ns");
+}
+
+int host_run_bench(const char *threshold_file) {
+    if (threshold_file && load_thresholds(threshold_file) < 0) {
+        return 1;
+    }
+
+    spsc_init(&queue, queue_slots, 64);
+    report("spsc_push_pop", best_ns_per_op(run_spsc, SPSC_OPS), "ns");
+    bench_kv();
+    bench_sched();
+    bench_dsp();
+
+    if (threshold_file) {
+        printf("%s: %u over threshold\n", over_threshold ? "FAIL" : "OK",
+               over_threshold);
+    }
+    return over_threshold != 0;
+}
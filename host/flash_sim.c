@@ -0,0 +1,61 @@
+#include <stdint.h>
+#include <string.h>
+#include "flash.h"
+#include "host.h"
+
+/* ── Simulated flash ─────────────────────────────────────────────────────────
+   flash.c's erase and program over host_flash (layout.c), with the same
+   alignment rules and NOR behaviour: erase sets a sector to 0xFF, program
+   can only clear bits. 0xFF bytes are "leave as is", which is how
+   flash_writer_flush() programs a page twice; any other byte that does
+   not come out as written is counted in bad_programs — the device would
+   silently leave the bit 0, and whoever relied on it has a bug.
+   ────────────────────────────────────────────────────────────────────────── */
+extern uint8_t host_flash[FLASH_SIZE_BYTES];
+
+static struct host_flash_stats stats;
+
+static int range_ok(uint32_t offset, uint32_t count, uint32_t align) {
+    if ((offset | count) & (align - 1u) || offset > FLASH_SIZE_BYTES
+        || count > FLASH_SIZE_BYTES - offset) {
+        stats.rejected++;
+        return 0;
+    }
+    return 1;
+}
+
+void host_flash_reset(void) {
+    memset(host_flash, 0xFF, sizeof host_flash);
+    memset(&stats, 0, sizeof stats);
+}
+
+const struct host_flash_stats *host_flash_get_stats(void) {
+    return &stats;
+}
+
+int flash_range_erase(uint32_t offset, uint32_t count) {
+    if (!range_ok(offset, count, FLASH_SECTOR_SIZE)) {
+        return -1;
+    }
+    memset(host_flash + offset, 0xFF, count);
+    stats.erases += count / FLASH_SECTOR_SIZE;
+    return 0;
+}
+
+int flash_range_program(uint32_t offset, const void *data, uint32_t count) {
+    const uint8_t *src = data;
+
+    if (!range_ok(offset, count, FLASH_PAGE_SIZE)) {
+        return -1;
+    }
+    for (uint32_t page = 0; page < count; page += FLASH_PAGE_SIZE) {
+        int bad = 0;
+        for (uint32_t i = page; i < page + FLASH_PAGE_SIZE; i++) {
+            host_flash[offset + i] &= src[i];
+            bad |= src[i] != 0xFFu && host_flash[offset + i] != src[i];
+        }
+        stats.programs++;
+        stats.bad_programs += bad != 0;
+    }
+    return 0;
+}
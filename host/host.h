@@ -0,0 +1,58 @@
+#ifndef HOST_H
+#define HOST_H
+
+#include <stdint.h>
+
+/* ── Host simulation build ───────────────────────────────────────────────────
+   make host compiles the hardware-independent core of the firmware — the
+   scheduler, software timers, SPSC queues, KV store and DSP kernels — for
+   the development machine, with HOST_SIM=1. The sources are the firmware's
+   own; HOST_SIM only swaps what cannot run on a PC:
+
+   - MMIO32() goes through host_mmio() into a mock register space (mmio.c)
+   - PRIMASK is a variable, barriers are fences, sev/wfe/wfi do nothing
+   - flash is a RAM array with NOR semantics (flash_sim.c), and the
+     linker.ld symbols the modules use point into host arrays (layout.c)
+
+   There are no exceptions: a test plays the hardware by calling the
+   handler (TIMER_IRQ0_Handler, sched_switch for PendSV) itself.
+
+       make host         build, then run the unit tests
+       make host-bench   build, then run the microbenchmarks against
+                         host/bench_thresholds.txt
+   ────────────────────────────────────────────────────────────────────────── */
+
+/* ── Mock registers (mmio.c) ─────────────────────────────────────────────── */
+
+/* The TIMER count seen by time_us_32()/time_us_64(); only tests move it    */
+extern uint64_t host_time_us;
+
+/* 1 while "interrupts" are masked by save_and_disable_interrupts()         */
+extern uint32_t host_primask;
+
+/* Forget every register value                                              */
+void     host_mmio_reset(void);
+uint32_t host_mmio_peek(uint32_t addr);
+void     host_mmio_poke(uint32_t addr, uint32_t value);
+
+/* ── Simulated flash (flash_sim.c) ───────────────────────────────────────── */
+struct host_flash_stats {
+    uint32_t erases;                    /* sectors                          */
+    uint32_t programs;                  /* pages                            */
+    uint32_t bad_programs;              /* would have needed a 0 -> 1       */
+    uint32_t rejected;                  /* misaligned or out of range       */
+};
+
+/* Every byte erased to 0xFF, stats cleared                                 */
+void host_flash_reset(void);
+const struct host_flash_stats *host_flash_get_stats(void);
+
+/* ── Runners ─────────────────────────────────────────────────────────────── */
+
+/* 0 if every check passed                                                  */
+int host_run_tests(void);
+
+/* 0 if no result is over its threshold. thresholds may be 0: report only. */
+int host_run_bench(const char *thresholds);
+
+#endif
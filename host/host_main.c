@@ -0,0 +1,21 @@
+#include <stdio.h>
+#include <string.h>
+#include "host.h"
+
+/* host-sim test                  run the unit tests
+   host-sim bench [thresholds]    run the microbenchmarks, checking each
+                                  against thresholds if given
+
+   One mode per process: both start the scheduler, which cannot be
+   stopped again.                                                           */
+int main(int argc, char **argv) {
+    if (argc == 2 && strcmp(argv[1], "test") == 0) {
+        return host_run_tests();
+    }
+    if ((argc == 2 || argc == 3) && strcmp(argv[1], "bench") == 0) {
+        return host_run_bench(argc == 3 ? argv[2] : 0);
+    }
+
+    fprintf(stderr, "usage: %s test | bench [thresholds]\n", argv[0]);
+    return 2;
+}
@@ -0,0 +1,38 @@
+#include <stdint.h>
+#include "flash.h"
+#include "host.h"
+
+/* ── Memory layout ───────────────────────────────────────────────────────────
+   The symbols linker.ld defines for the modules the host build compiles,
+   pointing into host arrays laid out like the device: the whole 2 MiB
+   flash with KV_FLASH in its last 64 KiB, and the two main stacks back to
+   back as in SRAM — core 0's 8 KiB (STACK0_LOW, the top 4 KiB of main
+   SRAM, then SCRATCH_X) below core 1's 4 KiB in SCRATCH_Y. The assembler
+   equates each symbol to an offset in its array, as the linker script
+   does to an offset in a memory region.
+   ────────────────────────────────────────────────────────────────────────── */
+#define KV_FLASH_OFFSET         0x1F0000    /* linker.ld KV_FLASH           */
+#define KV_FLASH_SIZE           0x10000
+#define STACK0_SIZE             0x2000      /* linker.ld _stack_size        */
+#define STACK1_SIZE             0x1000      /* linker.ld _core1_stack_size  */
+
+#define STR(x)                  #x
+#define XSTR(x)                 STR(x)
+
+uint8_t host_flash[FLASH_SIZE_BYTES];
+uint32_t host_stacks[(STACK0_SIZE + STACK1_SIZE) / 4u];
+
+__asm__(".globl _kv_flash_start\n"
+        ".globl _kv_flash_end\n"
+        ".set _kv_flash_start, host_flash + " XSTR(KV_FLASH_OFFSET) "\n"
+        ".set _kv_flash_end, host_flash + " XSTR(KV_FLASH_OFFSET)
+        " + " XSTR(KV_FLASH_SIZE) "\n"
+        ".globl _stack_limit\n"
+        ".globl _stack_top\n"
+        ".globl _core1_stack_limit\n"
+        ".globl _core1_stack_top\n"
+        ".set _stack_limit, host_stacks\n"
+        ".set _stack_top, host_stacks + " XSTR(STACK0_SIZE) "\n"
+        ".set _core1_stack_limit, host_stacks + " XSTR(STACK0_SIZE) "\n"
+        ".set _core1_stack_top, host_stacks + " XSTR(STACK0_SIZE)
+        " + " XSTR(STACK1_SIZE) "\n");
@@ -0,0 +1,107 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "rp2040.h"
+#include "host.h"
+
+/* ── Mock register space ─────────────────────────────────────────────────────
+   Addresses in the RP2040's register windows — XIP control and SSI at
+   0x14000000, the APB/AHB peripherals from 0x40000000, SIO at 0xD0000000
+   and the Cortex-M PPB at 0xE0000000 — are backed by 4 KiB pages,
+   allocated zeroed the first time anything in them is touched. Anything
+   else is taken to be a host pointer (a stack, flash_ptr(), a buffer) and
+   passed straight through.
+
+   Registers are plain memory: a read returns what was last written. On
+   top of that only these behave like hardware:
+   - TIMERAWH/TIMERAWL read host_time_us
+   - SIO spinlocks are always free: the host build has a single core, and
+     a claim that could spin would only hang the test
+
+   Not modelled: the SET/CLR/XOR aliases (with HOST_SIM, hw_set_bits() and
+   friends modify the register itself), write-1-to-clear bits, and any
+   effect one register has on another. A test that needs a status bit says
+   so with host_mmio_poke(); one that checks a driver's output reads the
+   register back with host_mmio_peek().
+
+   Not thread-safe; only the thread running the tests touches registers.
+   ────────────────────────────────────────────────────────────────────────── */
+#define PAGE_SHIFT              12
+#define PAGE_WORDS              (1u << (PAGE_SHIFT - 2))
+#define MAX_PAGES               64u
+
+/* timer.h and sync.h, as plain addresses: their macros expand to MMIO32    */
+#define TIMERAWH_ADDR           0x40054024u
+#define TIMERAWL_ADDR           0x40054028u
+#define SPINLOCK0_ADDR          (SIO_BASE + 0x100u)
+#define SPINLOCK_COUNT          32u
+
+struct page {
+    uint32_t base;
+    uint32_t words[PAGE_WORDS];
+};
+
+static struct page pages[MAX_PAGES];
+static uint32_t page_count;
+
+uint64_t host_time_us;
+uint32_t host_primask;
+
+static int is_register(uintptr_t addr) {
+    return (addr >= 0x14000000u && addr < 0x20000000u)
+        || (addr >= 0x40000000u && addr < 0xF0000000u);
+}
+
+static volatile uint32_t *reg_slot(uint32_t addr) {
+    const uint32_t base = addr & ~((1u << PAGE_SHIFT) - 1u);
+    const uint32_t word = (addr - base) / 4u;
+
+    for (uint32_t i = 0; i < page_count; i++) {
+        if (pages[i].base == base) {
+            return &pages[i].words[word];
+        }
+    }
+    if (page_count == MAX_PAGES) {
+        fprintf(stderr, "host_mmio: more than %u register pages in use "
+                "(touching 0x%08x)\n", MAX_PAGES, addr);
+        abort();
+    }
+    pages[page_count].base = base;
+    return &pages[page_count++].words[word];
+}
+
+volatile uint32_t *host_mmio(uintptr_t addr) {
+    if (!is_register(addr)) {
+        return (volatile uint32_t *)addr;
+    }
+
+    volatile uint32_t *reg = reg_slot((uint32_t)addr);
+
+    /* Refresh what a live register would read now. Callers that keep the
+       pointer (spin_lock_instance()) see the value from when they took it. */
+    if (addr == TIMERAWL_ADDR) {
+        *reg = (uint32_t)host_time_us;
+    } else if (addr == TIMERAWH_ADDR) {
+        *reg = (uint32_t)(host_time_us >> 32);
+    } else if (addr >= SPINLOCK0_ADDR
+               && addr < SPINLOCK0_ADDR + 4u * SPINLOCK_COUNT) {
+        *reg = 1u << ((addr - SPINLOCK0_ADDR) / 4u);
+    }
+    return reg;
+}
+
+void host_mmio_reset(void) {
+    memset(pages, 0, sizeof pages);
+    page_count = 0;
+    host_time_us = 0;
+    host_primask = 0;
+}
+
+uint32_t host_mmio_peek(uint32_t addr) {
+    return *reg_slot(addr);
+}
+
+void host_mmio_poke(uint32_t addr, uint32_t value) {
+    *reg_slot(addr) = value;
+}
@@ -0,0 +1,523 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include "rp2040.h"
+#include "irq.h"
+#include "spsc.h"
+#include "swtimer.h"
+#include "sched.h"
+#include "flash.h"
+#include "kv.h"
+#include "dsp.h"
+#include "host.h"
+
+/* ── Unit tests ──────────────────────────────────────────────────────────────
+   One function per module, each starting from reset registers and erased
+   flash. A failed CHECK prints "F file:line expression" and the run goes
+   on, so one report shows every failure; host_run_tests() returns nonzero
+   if there was any.
+
+   The scheduler keeps its task table for the life of the process, so its
+   test runs once and last.
+   ────────────────────────────────────────────────────────────────────────── */
+static uint32_t checks;
+static uint32_t failures;
+
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        checks++;                                                           \
+        if (!(cond)) {                                                      \
+            failures++;                                                     \
+            printf("F %s:%d %s\n", __FILE__, __LINE__, #cond);              \
+        }                                                                   \
+    } while (0)
+
+static void fresh_hardware(void) {
+    host_mmio_reset();
+    host_flash_reset();
+}
+
+/* Deterministic, so a failure reproduces                                   */
+static uint32_t rng_state;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+/* ── SPSC queue ──────────────────────────────────────────────────────────── */
+#define SPSC_THREAD_ITEMS       2000000u
+
+static struct spsc_queue thread_queue;
+static void *thread_slots[64];
+
+static void *spsc_producer(void *arg) {
+    (void)arg;
+    for (uintptr_t i = 1; i <= SPSC_THREAD_ITEMS; i++) {
+        while (!spsc_try_push(&thread_queue, (void *)i)) {
+            sched_yield();
+        }
+    }
+    return 0;
+}
+
+static void test_spsc(void) {
+    struct spsc_queue q;
+    void *slots[8];
+    void *item;
+
+    spsc_init(&q, slots, 8);
+    CHECK(spsc_level(&q) == 0);
+    CHECK(!spsc_try_pop(&q, &item));
+
+    for (uintptr_t i = 0; i < 8; i++) {
+        CHECK(spsc_try_push(&q, (void *)(i + 100)));
+    }
+    CHECK(!spsc_try_push(&q, (void *)1));
+    CHECK(spsc_level(&q) == 8);
+    for (uintptr_t i = 0; i < 8; i++) {
+        CHECK(spsc_try_pop(&q, &item) && item == (void *)(i + 100));
+    }
+    CHECK(!spsc_try_pop(&q, &item));
+
+    /* The counters are free-running: the fill level holds across the wrap */
+    q.head = q.tail = 0xFFFFFFFCu;
+    for (uintptr_t i = 0; i < 6; i++) {
+        CHECK(spsc_try_push(&q, (void *)i));
+    }
+    CHECK(q.head == 2u && spsc_level(&q) == 6);
+    for (uintptr_t i = 0; i < 6; i++) {
+        CHECK(spsc_try_pop(&q, &item) && item == (void *)i);
+    }
+
+    /* Two real threads standing in for the two cores: every item arrives,
+       in order, with the host's memory model doing the reordering         */
+    spsc_init(&thread_queue, thread_slots, 64);
+    pthread_t producer;
+    CHECK(pthread_create(&producer, 0, spsc_producer, 0) == 0);
+    uintptr_t expect = 1;
+    uint32_t out_of_order = 0;
+    while (expect <= SPSC_THREAD_ITEMS) {
+        if (spsc_try_pop(&thread_queue, &item)) {
+            out_of_order += (uintptr_t)item != expect;
+            expect++;
+        } else {
+            sched_yield();
+        }
+    }
+    pthread_join(producer, 0);
+    CHECK(out_of_order == 0);
+    CHECK(spsc_level(&thread_queue) == 0);
+}
+
+/* ── KV store ────────────────────────────────────────────────────────────── */
+#define KV_TEST_KEYS            40u
+#define KV_TEST_OPS             60000u
+#define KV_TEST_REBOOT_EVERY    2500u
+
+static void test_kv(void) {
+    uint32_t value[KV_MAX_VALUE / 4u];
+    uint32_t buf[KV_MAX_VALUE / 4u];
+    uint32_t len;
+
+    fresh_hardware();
+    CHECK(kv_init() == 0);
+    CHECK(kv_get(1, buf, sizeof buf) < 0);
+
+    value[0] = 0x12345678u;
+    CHECK(kv_set(1, value, 4) == 0);
+    CHECK(kv_get(1, buf, sizeof buf) == 4 && buf[0] == 0x12345678u);
+    const void *p = kv_get_ptr(1, &len);
+    CHECK(p && len == 4 && memcmp(p, value, 4) == 0);
+
+    /* An unchanged value costs no flash write                              */
+    const uint32_t programs = host_flash_get_stats()->programs;
+    CHECK(kv_set(1, value, 4) == 0);
+    CHECK(kv_maintain() >= 0);
+    CHECK(host_flash_get_stats()->programs == programs);
+
+    CHECK(kv_delete(1) == 0);
+    CHECK(kv_get(1, buf, sizeof buf) < 0);
+    CHECK(kv_set(KV_MAX_KEYS, value, 4) < 0);
+    CHECK(kv_set(2, value, KV_MAX_VALUE + 1u) < 0);
+
+    /* Random traffic against a model, with reboots (re-running kv_init()
+       over what is in flash) and enough churn to compact many times over  */
+    uint32_t model[KV_TEST_KEYS];
+    uint32_t model_len[KV_TEST_KEYS];
+    int present[KV_TEST_KEYS] = {0};
+    uint32_t mismatches = 0;
+    rng_state = 0x2545F491u;
+
+    fresh_hardware();
+    CHECK(kv_init() == 0);
+    for (uint32_t op = 0; op < KV_TEST_OPS; op++) {
+        const uint16_t key = (uint16_t)(rng() % KV_TEST_KEYS);
+
+        if (rng() % 8u == 0) {
+            kv_delete(key);
+            present[key] = 0;
+        } else {
+            const uint32_t words = 1u + rng() % 16u;
+            for (uint32_t i = 0; i < words; i++) {
+                value[i] = op ^ (i << 24);
+            }
+            if (kv_set(key, value, words * 4u) != 0) {
+                mismatches++;
+            }
+            model[key] = op;
+            model_len[key] = words * 4u;
+            present[key] = 1;
+        }
+        kv_maintain();
+        if (op % KV_TEST_REBOOT_EVERY == 0 && kv_init() != 0) {
+            mismatches++;
+        }
+
+        if (op % 16u == 0) {
+            for (uint16_t k = 0; k < KV_TEST_KEYS; k++) {
+                const int n = kv_get(k, buf, sizeof buf);
+                if (present[k] ? n != (int)model_len[k] || buf[0] != model[k]
+                               : n >= 0) {
+                    mismatches++;
+                }
+            }
+        }
+    }
+    CHECK(mismatches == 0);
+
+    struct kv_stats stats;
+    kv_get_stats(&stats);
+    CHECK(stats.free_sectors >= 1);
+
+    /* The oldest sector exactly full of live values, then one other key
+       rewritten until the log has been round the ring many times: the
+       full sector has to be moved for the stale ones behind it to go      */
+    fresh_hardware();
+    CHECK(kv_init() == 0);
+    mismatches = 0;
+    for (uint16_t k = 0; k < 16; k++) {
+        memset(value, k, sizeof value);
+        mismatches += kv_set(k, value, k < 15 ? KV_MAX_VALUE : 120u) != 0;
+    }
+    kv_get_stats(&stats);
+    CHECK(stats.used_bytes == FLASH_SECTOR_SIZE
+          && stats.live_bytes + 8u == FLASH_SECTOR_SIZE);
+    for (uint32_t i = 0; i < 5000u; i++) {
+        value[0] = i;
+        mismatches += kv_set(20, value, 64) != 0;
+        kv_maintain();
+    }
+    CHECK(mismatches == 0);
+    CHECK(kv_init() == 0);
+    for (uint16_t k = 0; k < 16; k++) {
+        mismatches += kv_get(k, buf, sizeof buf)
+                      != (k < 15 ? (int)KV_MAX_VALUE : 120)
+                      || buf[0] != k * 0x01010101u;
+    }
+    CHECK(mismatches == 0);
+    CHECK(kv_get(20, buf, sizeof buf) == 64 && buf[0] == 4999u);
+    kv_get_stats(&stats);
+    CHECK(stats.free_sectors > 1);
+
+    /* A record cut short by a reset after the last good one: replay stops
+       there, and compacting the sector later moves only what precedes it */
+    fresh_hardware();
+    CHECK(kv_init() == 0);
+    mismatches = 0;
+    for (uint16_t k = 0; k < 4; k++) {
+        memset(value, k, sizeof value);
+        mismatches += kv_set(k, value, 16) != 0;
+    }
+    const uint8_t *last = kv_get_ptr(3, &len);
+    const uint32_t torn = (uint32_t)(last + len - (const uint8_t *)flash_ptr(0));
+    uint8_t page[FLASH_PAGE_SIZE];
+    const uint32_t at = torn % FLASH_PAGE_SIZE;
+    memset(page, 0xFF, sizeof page);
+    page[at] = 5;                       /* key 5, 64 bytes, bad check,     */
+    page[at + 2] = 64;                  /* the value never written         */
+    memset(&page[at + 4], 0, 4);
+    CHECK(flash_range_program(torn - at, page, sizeof page) == 0);
+
+    CHECK(kv_init() == 0);
+    CHECK(kv_get(5, buf, sizeof buf) < 0);
+    for (uint32_t i = 0; i < 2000u; i++) {
+        value[0] = i;
+        mismatches += kv_set(9, value, 64) != 0;
+        kv_maintain();
+    }
+    kv_get_stats(&stats);
+    CHECK(stats.compactions > 0);
+    CHECK(kv_init() == 0);
+    for (uint16_t k = 0; k < 4; k++) {
+        mismatches += kv_get(k, buf, sizeof buf) != 16
+                      || buf[0] != k * 0x01010101u;
+    }
+    CHECK(mismatches == 0);
+    CHECK(kv_get(5, buf, sizeof buf) < 0);
+    CHECK(kv_get(9, buf, sizeof buf) == 64 && buf[0] == 1999u);
+    kv_get_stats(&stats);
+    CHECK(stats.keys == 5);
+    CHECK(host_flash_get_stats()->bad_programs == 0);
+    CHECK(host_flash_get_stats()->rejected == 0);
+    CHECK(host_primask == 0);
+}
+
+/* ── Software timers ─────────────────────────────────────────────────────── */
+static uint32_t fired_order[8];
+static uint32_t fired_count;
+
+static void record_fire(struct swtimer *timer) {
+    if (fired_count < 8) {
+        fired_order[fired_count] = (uint32_t)(uintptr_t)timer->user_data;
+    }
+    fired_count++;
+}
+
+void TIMER_IRQ0_Handler(void);
+
+/* What TIMER_IRQ_0 would do once the counter reaches now                    */
+static void run_timers_until(uint64_t now) {
+    host_time_us = now;
+    TIMER_IRQ0_Handler();
+}
+
+static void test_swtimer(void) {
+    struct swtimer a, b, periodic;
+
+    fresh_hardware();
+    host_time_us = 1000;
+    fired_count = 0;
+    swtimer_start(&b, 200, 0, record_fire, (void *)2);
+    swtimer_start(&a, 100, 0, record_fire, (void *)1);
+    swtimer_start(&periodic, 50, 300, record_fire, (void *)3);
+
+    /* The alarm is programmed for the soonest deadline                      */
+    CHECK(host_mmio_peek(0x40054010u) == 1050u);
+
+    run_timers_until(1040);
+    CHECK(fired_count == 0);
+    run_timers_until(1100);
+    CHECK(fired_count == 2 && fired_order[0] == 3 && fired_order[1] == 1);
+    CHECK(host_mmio_peek(0x40054010u) == 1200u);
+
+    swtimer_cancel(&b);
+    CHECK(!b.active);
+    run_timers_until(1400);
+    CHECK(fired_count == 3 && fired_order[2] == 3);
+
+    /* Periodic deadlines advance by the period, not from when they ran     */
+    run_timers_until(1990);
+    CHECK(fired_count == 5 && periodic.deadline_us == 2250u);
+    swtimer_cancel(&periodic);
+    CHECK(host_primask == 0);
+}
+
+/* ── DSP kernels ─────────────────────────────────────────────────────────── */
+#define DSP_TEST_SAMPLES        1000u
+
+static void test_dsp(void) {
+    static q15_t in[DSP_TEST_SAMPLES], out[DSP_TEST_SAMPLES];
+    rng_state = 0x9E3779B9u;
+    for (uint32_t i = 0; i < DSP_TEST_SAMPLES; i++) {
+        in[i] = (q15_t)(rng() & 0xFFFFu);
+    }
+
+    /* FIR against the textbook sum, processed in uneven blocks             */
+    static const q15_t h[7] = { 1000, -2000, 3000, 4000, 5000, -6000, 7000 };
+    q15_t state[14];
+    struct q15_fir fir;
+    q15_fir_init(&fir, h, 7, state);
+    q15_fir_process(&fir, in, out, 333);
+    q15_fir_process(&fir, in + 333, out + 333, DSP_TEST_SAMPLES - 333);
+    uint32_t fir_errors = 0;
+    for (int32_t n = 0; n < (int32_t)DSP_TEST_SAMPLES; n++) {
+        int64_t acc = 0x4000;
+        for (int32_t k = 0; k < 7 && k <= n; k++) {
+            acc += (int32_t)h[k] * in[n - k];
+        }
+        acc >>= 15;
+        acc = acc > Q15_MAX ? Q15_MAX : acc < Q15_MIN ? Q15_MIN : acc;
+        fir_errors += acc != out[n];
+    }
+    CHECK(fir_errors == 0);
+
+    /* Moving average, power of two (shift) and not (divide)                */
+    static const uint32_t lengths[2] = { 16, 5 };
+    for (uint32_t t = 0; t < 2; t++) {
+        const uint32_t len = lengths[t];
+        q15_t window[16];
+        struct q15_moving_avg avg;
+        uint32_t avg_errors = 0;
+
+        q15_moving_avg_init(&avg, window, len);
+        q15_moving_avg_process(&avg, in, out, DSP_TEST_SAMPLES);
+        for (uint32_t n = len - 1u; n < DSP_TEST_SAMPLES; n++) {
+            int32_t sum = 0;
+            for (uint32_t k = 0; k < len; k++) {
+                sum += in[n - k];
+            }
+            const int32_t expect = len == 16 ? sum >> 4 : sum / (int32_t)len;
+            avg_errors += expect != out[n];
+        }
+        CHECK(avg_errors == 0);
+    }
+
+    /* A unity-gain low-pass settles to its input                           */
+    struct q15_biquad lp;
+    q15_biquad_init(&lp, Q14(0.0675), Q14(0.1349), Q14(0.0675),
+                    Q14(-1.1430), Q14(0.4128));
+    static q15_t step[DSP_TEST_SAMPLES];
+    for (uint32_t i = 0; i < DSP_TEST_SAMPLES; i++) {
+        step[i] = 16000;
+    }
+    q15_biquad_process(&lp, 1, step, step, DSP_TEST_SAMPLES);
+    CHECK(abs(step[DSP_TEST_SAMPLES - 1u] - 16000) < 40);
+
+    /* Scalar functions against libm                                        */
+    uint32_t sqrt_errors = 0;
+    for (uint64_t x = 0; x <= 0xFFFFFFFFu; x += 65521u) {
+        const uint64_t r = dsp_isqrt32((uint32_t)x);
+        sqrt_errors += r * r > x || (r + 1u) * (r + 1u) <= x;
+    }
+    CHECK(sqrt_errors == 0);
+    CHECK(dsp_isqrt32(0xFFFFFFFFu) == 65535u);
+    CHECK(q15_sqrt(Q15(0.25)) == Q15(0.5));
+    CHECK(q15_magnitude(Q15(0.6), Q15(0.8)) == Q15_MAX);
+
+    double worst = 0.0;
+    for (int32_t y = -32768; y < 32768; y += 251) {
+        for (int32_t x = -32768; x < 32768; x += 241) {
+            double d = fabs(atan2(y, x) / M_PI * 32768.0
+                            - q15_atan2((q15_t)y, (q15_t)x));
+            d = d > 32768.0 ? 65536.0 - d : d;
+            worst = d > worst ? d : worst;
+        }
+    }
+    CHECK(worst * 180.0 / 32768.0 < 0.25);      /* degrees                  */
+
+    uint32_t mul_errors = 0;
+    for (uint32_t i = 0; i < 1000000u; i++) {
+        const q31_t a = (q31_t)rng(), b = (q31_t)rng();
+        const int64_t exact = ((int64_t)a * b) >> 31;
+        const int64_t d = exact - q31_mul(a, b);
+        mul_errors += d < 0 || d > 2;
+    }
+    CHECK(mul_errors == 0);
+    CHECK(q31_mul(Q31_MIN, Q31_MIN) == Q31_MAX);
+    CHECK(q31_add_sat(Q31_MAX, 1) == Q31_MAX);
+    CHECK(q31_add_sat(Q31_MIN, -1) == Q31_MIN);
+}
+
+/* ── Scheduler ───────────────────────────────────────────────────────────────
+   Tasks never run: sched_switch() is called the way PendSV would, with
+   the stack pointer the outgoing task would have, and the test moves task
+   states around as the tasks themselves would.
+   ────────────────────────────────────────────────────────────────────────── */
+#define SCB_ICSR_ADDR           0xE000ED04u
+#define SCB_ICSR_PENDSVSET      (1u << 28)
+
+static struct task t_high, t_low_a, t_low_b;
+static struct task t_fill[SCHED_MAX_TASKS - 3u], t_extra;
+static uint32_t stacks[3][128] __attribute__((aligned(8)));
+static uint32_t fill_stack[64] __attribute__((aligned(8)));
+
+static void never_runs(void *arg) {
+    (void)arg;
+}
+
+static int switch_pending(void) {
+    const int pending = (host_mmio_peek(SCB_ICSR_ADDR)
+                         & SCB_ICSR_PENDSVSET) != 0;
+    host_mmio_poke(SCB_ICSR_ADDR, 0);
+    return pending;
+}
+
+uint32_t *sched_switch(uint32_t *sp);
+
+static struct task *pendsv(void) {
+    sched_switch(task_current()->sp);
+    return task_current();
+}
+
+static void test_sched(void) {
+    fresh_hardware();
+    task_create(&t_low_a, "low_a", never_runs, 0, stacks[0], 128, 5);
+    task_create(&t_low_b, "low_b", never_runs, 0, stacks[1], 128, 5);
+    task_create(&t_high, "high", never_runs, 0, stacks[2], 128, 1);
+
+    CHECK(task_stack_unused_words(&t_high) > 100);
+    CHECK(t_high.sp[14] == ((uint32_t)(uintptr_t)never_runs & ~1u));
+
+    /* Fill the table with tasks that have finished, so they never run: a
+       task past SCHED_MAX_TASKS is refused, and idle still gets its slot  */
+    for (uint32_t i = 0; i < SCHED_MAX_TASKS - 3u; i++) {
+        CHECK(task_create(&t_fill[i], "fill", never_runs, 0,
+                          fill_stack, 64, 9) == 0);
+        t_fill[i].state = TASK_DONE;
+    }
+    CHECK(task_create(&t_extra, "extra", never_runs, 0,
+                      fill_stack, 64, 9) < 0);
+    CHECK(t_extra.state == TASK_UNUSED);
+
+    sched_start();
+    CHECK(sched_task_count() == SCHED_MAX_TASKS + 1u);  /* with idle       */
+    CHECK(sched_get_task(SCHED_MAX_TASKS)->priority == SCHED_PRIORITY_IDLE);
+    CHECK(task_current() == &t_high);
+
+    /* The high task blocks; the equal low tasks then take turns           */
+    t_high.wait_mask = 1u;
+    t_high.state = TASK_BLOCKED;
+    CHECK(pendsv() == &t_low_a);
+    task_yield();
+    CHECK(switch_pending());
+    CHECK(pendsv() == &t_low_b);
+    CHECK(pendsv() == &t_low_a);
+
+    /* A notification it does not wait for leaves it blocked; one it does
+       readies it and, as it outranks low_a, asks for a switch             */
+    task_notify(&t_high, 2u);
+    CHECK(t_high.state == TASK_BLOCKED && !switch_pending());
+    task_notify(&t_high, 1u);
+    CHECK(t_high.state == TASK_READY && switch_pending());
+    CHECK(pendsv() == &t_high);
+    CHECK(task_wait(1u) == 1u && t_high.notified == 2u);
+
+    /* The high task blocked on a mutex low_a holds (table index 2, as it
+       was created third): unlocking readies it and asks for a switch      */
+    static struct task_mutex mutex;
+    t_high.wait_mask = TASK_NOTIFY_MUTEX;
+    t_high.state = TASK_BLOCKED;
+    CHECK(pendsv() == &t_low_a);
+    task_mutex_lock(&mutex);
+    CHECK(mutex.locked && !switch_pending());
+    mutex.waiters = 1u << 2;
+    task_mutex_unlock(&mutex);
+    CHECK(!mutex.locked && !mutex.waiters);
+    CHECK(t_high.state == TASK_READY && switch_pending());
+    CHECK(pendsv() == &t_high);
+    CHECK(task_wait(TASK_NOTIFY_MUTEX) == TASK_NOTIFY_MUTEX);
+
+    /* Everything blocked: idle runs                                        */
+    t_high.state = t_low_a.state = t_low_b.state = TASK_BLOCKED;
+    CHECK(pendsv()->priority == SCHED_PRIORITY_IDLE);
+    CHECK(host_primask == 0);
+}
+
+int host_run_tests(void) {
+    test_spsc();
+    test_kv();
+    test_swtimer();
+    test_dsp();
+    test_sched();
+
+    printf("%s: %u checks, %u failed\n", failures ? "FAIL" : "OK",
+           checks, failures);
+    return failures != 0;
+}
@@ -0,0 +1,220 @@
+#include <stdint.h>
+#include "rp2040.h"
+#include "clocks.h"
+#include "dma.h"
+#include "gpio.h"
+#include "irq.h"
+#include "adc.h"
+
+/* Streaming state: the two DMA channels, which of them fills buffers[next]
+   and completes next, and the config they were started with              */
+static struct {
+    int active;
+    uint32_t dma[2];
+    uint32_t next;
+    struct adc_stream_config config;
+    struct adc_stream_stats stats;
+} stream;
+
+void adc_init(void) {
+    /* No reset_block(): a stream already running would stop               */
+    unreset_block_wait(RESET_ADC);
+    hw_set_bits(&ADC_CS, ADC_CS_EN);
+    while (!(ADC_CS & ADC_CS_READY));
+}
+
+void adc_gpio_init(uint32_t input) {
+    const uint32_t pin = ADC_FIRST_GPIO + input;
+    /* The digital input buffer would draw current at mid-rail voltages     */
+    gpio_set_function(pin, GPIO_FUNC_NULL);
+    gpio_disable_pulls(pin);
+    gpio_set_input_enabled(pin, 0);
+}
+
+static void select_inputs(uint32_t mask) {
+    if (mask & (1u << ADC_TEMP_INPUT)) {
+        hw_set_bits(&ADC_CS, ADC_CS_TS_EN);
+    }
+    for (uint32_t i = 0; i < ADC_TEMP_INPUT; i++) {
+        if (mask & (1u << i)) {
+            adc_gpio_init(i);
+        }
+    }
+}
+
+uint16_t adc_read(uint32_t input) {
+    select_inputs(1u << input);
+    hw_write_masked(&ADC_CS, FIELD_PREP(ADC_CS_AINSEL, input),
+                    ADC_CS_AINSEL_MASK);
+    hw_set_bits(&ADC_CS, ADC_CS_START_ONCE);
+    while (!(ADC_CS & ADC_CS_READY));
+    return (uint16_t)ADC_RESULT;
+}
+
+/* Period of (1 + INT + FRAC/256) clk_adc cycles; 0 = back to back         */
+static uint32_t rate_to_div(uint32_t hz) {
+    const uint64_t clk = clock_get_hz(CLK_ADC);
+    if ((uint64_t)hz * ADC_CYCLES_PER_SAMPLE >= clk) {
+        return 0;
+    }
+    uint64_t div = ((clk << 8) + hz / 2u) / hz - 0x100u;  /* 16.8 fixed   */
+    if (div > ADC_DIV_MASK) {
+        div = ADC_DIV_MASK;
+    }
+    return (uint32_t)div;
+}
+
+static uint32_t popcount(uint32_t x) {
+    uint32_t n = 0;
+    for (; x; x &= x - 1u) {
+        n++;
+    }
+    return n;
+}
+
+static void fifo_reset(void) {
+    while (!(ADC_FCS & ADC_FCS_EMPTY)) {
+        (void)ADC_FIFO;
+    }
+    hw_set_bits(&ADC_FCS, ADC_FCS_OVER | ADC_FCS_UNDER); /* write 1 to clear */
+    hw_set_bits(&ADC_CS, ADC_CS_ERR_STICKY);
+}
+
+int adc_stream_start(const struct adc_stream_config *config) {
+    const uint32_t mask = config->input_mask & ((1u << ADC_NUM_INPUTS) - 1u);
+    const uint32_t inputs = popcount(mask);
+
+    if (stream.active || !inputs || mask != config->input_mask
+        || !config->sample_rate_hz || !config->buffers[0]
+        || !config->buffers[1] || !config->block_samples
+        || config->block_samples % inputs || !config->on_block) {
+        return -1;
+    }
+
+    dma_init();
+    const int a = dma_claim_unused_channel();
+    const int b = a < 0 ? -1 : dma_claim_unused_channel();
+    if (b < 0) {
+        if (a >= 0) {
+            dma_channel_unclaim((uint32_t)a);
+        }
+        return -1;
+    }
+
+    stream.dma[0] = (uint32_t)a;
+    stream.dma[1] = (uint32_t)b;
+    stream.next = 0;
+    stream.config = *config;
+    stream.stats = (struct adc_stream_stats){0};
+
+    adc_init();
+    hw_clear_bits(&ADC_CS, ADC_CS_START_MANY);
+    select_inputs(mask);
+
+    /* DREQ as soon as one result is in; the FIFO's 4 entries absorb the
+       DMA's bus latency                                                    */
+    ADC_FCS = ADC_FCS_EN | ADC_FCS_DREQ_EN | FIELD_PREP(ADC_FCS_THRESH, 1);
+    fifo_reset();
+    ADC_DIV = rate_to_div(config->sample_rate_hz);
+
+    /* Each channel starts the other when it completes, so the ADC never
+       waits on the CPU; TRANS_COUNT reloads itself on each trigger and
+       only the write address needs putting back                           */
+    for (uint32_t i = 0; i < 2; i++) {
+        const uint32_t ch = stream.dma[i];
+        dma_channel_config c = dma_channel_get_default_config(ch);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+        channel_config_set_read_increment(&c, 0);
+        channel_config_set_write_increment(&c, 1);
+        channel_config_set_dreq(&c, DREQ_ADC);
+        channel_config_set_chain_to(&c, stream.dma[i ^ 1u]);
+        dma_channel_configure(ch, &c, config->buffers[i], &ADC_FIFO,
+                              config->block_samples, i == 0);
+        dma_channel_acknowledge_irq0(ch);
+        dma_channel_set_irq0_enabled(ch, 1);
+    }
+    irq_set_enabled(DMA_IRQ_0, 1);
+
+    /* The sequence starts at the lowest input in the mask                  */
+    const uint32_t first = (uint32_t)__builtin_ctz(mask);
+    stream.active = 1;
+    hw_write_masked(&ADC_CS,
+                    FIELD_PREP(ADC_CS_AINSEL, first)
+                    | FIELD_PREP(ADC_CS_RROBIN, mask) | ADC_CS_START_MANY,
+                    ADC_CS_AINSEL_MASK | ADC_CS_RROBIN_MASK
+                    | ADC_CS_START_MANY);
+    return 0;
+}
+
+void adc_stream_stop(void) {
+    if (!stream.active) {
+        return;
+    }
+    hw_clear_bits(&ADC_CS, ADC_CS_START_MANY | ADC_CS_RROBIN_MASK);
+
+    /* Chain each channel to itself first, so aborting one cannot start
+       the other                                                            */
+    for (uint32_t i = 0; i < 2; i++) {
+        const uint32_t ch = stream.dma[i];
+        hw_write_masked(&DMA_AL1_CTRL(ch), FIELD_PREP(DMA_CTRL_CHAIN_TO, ch),
+                        DMA_CTRL_CHAIN_TO_MASK);
+    }
+    for (uint32_t i = 0; i < 2; i++) {
+        dma_channel_set_irq0_enabled(stream.dma[i], 0);
+        dma_channel_abort(stream.dma[i]);
+        dma_channel_unclaim(stream.dma[i]);
+    }
+    stream.active = 0;
+
+    while (!(ADC_CS & ADC_CS_READY));
+    fifo_reset();
+    ADC_FCS = 0;
+}
+
+const struct adc_stream_stats *adc_stream_get_stats(void) {
+    return &stream.stats;
+}
+
+/* A buffer is full and the other channel is already filling the other one.
+   Put this channel's write address back first — it gets re-triggered when
+   the other buffer is full — then hand the block over.                     */
+void DMA_IRQ0_Handler(void) {
+    while (stream.active) {
+        const uint32_t i = stream.next;
+        const uint32_t ch = stream.dma[i];
+        if (!(DMA_INTS0 & (1u << ch))) {
+            break;
+        }
+        dma_channel_acknowledge_irq0(ch);
+
+        if (dma_channel_is_busy(ch)) {
+            /* Already restarted from the end of its buffer: it is writing
+               past it. Stop before it gets any further.                    */
+            stream.stats.late++;
+            adc_stream_stop();
+            break;
+        }
+        DMA_WRITE_ADDR(ch) = (uint32_t)stream.config.buffers[i];
+        stream.next = i ^ 1u;
+
+        if (ADC_FCS & ADC_FCS_OVER) {
+            stream.stats.fifo_overflows++;
+            hw_set_bits(&ADC_FCS, ADC_FCS_OVER);
+        }
+        if (ADC_CS & ADC_CS_ERR_STICKY) {
+            stream.stats.conversion_errors++;
+            hw_set_bits(&ADC_CS, ADC_CS_ERR_STICKY);
+        }
+
+        stream.stats.blocks++;
+        stream.config.on_block(stream.config.buffers[i],
+                               stream.config.block_samples,
+                               stream.config.user_data);
+
+        if (stream.active && dma_channel_is_busy(ch)) {
+            /* The other buffer filled while on_block() ran: this one was
+               being overwritten under it                                   */
+            stream.stats.late++;
+        }
+    }
+}
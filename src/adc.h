@@ -0,0 +1,123 @@
+#ifndef ADC_H
+#define ADC_H
+
+#include <stdint.h>
+#include "rp2040.h"
+
+/* ── ADC ─────────────────────────────────────────────────────────────────────
+   One 12-bit SAR converter, five inputs: AIN0-3 on GPIO 26-29 and AIN4 on
+   the internal temperature sensor. A conversion takes 96 cycles of the
+   48 MHz clk_adc, so back to back the ADC makes 500 ksps, shared between
+   the inputs it is cycling through.
+
+   CS:   EN, TS_EN (temperature sensor bias), START_ONCE, START_MANY (free
+         running), READY, ERR (this result is bad), ERR_STICKY,
+         AINSEL [14:12] (input for the next conversion), RROBIN [20:16]
+         (inputs to cycle through, in ascending order, after each one)
+   FCS:  EN (results go to the FIFO), SHIFT (8-bit results), ERR (bit 15
+         of each result flags ERR), DREQ_EN, EMPTY, FULL, and the sticky
+         UNDER/OVER (write 1 to clear); THRESH [27:24] is the DREQ level.
+   DIV:  with START_MANY, one conversion every 1 + INT + FRAC/256 cycles;
+         anything below 96 means as fast as possible.
+   ────────────────────────────────────────────────────────────────────────── */
+#define ADC_BASE                0x4004C000u
+#define ADC_CS                  MMIO32(ADC_BASE + 0x00)
+#define ADC_RESULT              MMIO32(ADC_BASE + 0x04)
+#define ADC_FCS                 MMIO32(ADC_BASE + 0x08)
+#define ADC_FIFO                MMIO32(ADC_BASE + 0x0C)
+#define ADC_DIV                 MMIO32(ADC_BASE + 0x10)
+
+#define ADC_CS_EN               (1u << 0)
+#define ADC_CS_TS_EN            (1u << 1)
+#define ADC_CS_START_ONCE       (1u << 2)
+#define ADC_CS_START_MANY       (1u << 3)
+#define ADC_CS_READY            (1u << 8)
+#define ADC_CS_ERR_STICKY       (1u << 10)
+#define ADC_CS_AINSEL_LSB       12
+#define ADC_CS_AINSEL_MASK      (7u << ADC_CS_AINSEL_LSB)
+#define ADC_CS_RROBIN_LSB       16
+#define ADC_CS_RROBIN_MASK      (0x1Fu << ADC_CS_RROBIN_LSB)
+
+#define ADC_FCS_EN              (1u << 0)
+#define ADC_FCS_DREQ_EN         (1u << 3)
+#define ADC_FCS_EMPTY           (1u << 8)
+#define ADC_FCS_UNDER           (1u << 10)
+#define ADC_FCS_OVER            (1u << 11)
+#define ADC_FCS_THRESH_LSB      24
+#define ADC_FCS_THRESH_MASK     (0xFu << ADC_FCS_THRESH_LSB)
+
+#define ADC_DIV_FRAC_LSB        0
+#define ADC_DIV_FRAC_MASK       (0xFFu << ADC_DIV_FRAC_LSB)
+#define ADC_DIV_INT_LSB         8
+#define ADC_DIV_INT_MASK        (0xFFFFu << ADC_DIV_INT_LSB)
+#define ADC_DIV_MASK            (ADC_DIV_INT_MASK | ADC_DIV_FRAC_MASK)
+
+#define RESET_ADC               (1u << 0)
+#define DREQ_ADC                36u
+
+#define ADC_NUM_INPUTS          5u
+#define ADC_TEMP_INPUT          4u
+#define ADC_FIRST_GPIO          26u
+#define ADC_CLOCK_HZ            48000000u
+#define ADC_CYCLES_PER_SAMPLE   96u
+#define ADC_MAX_SAMPLE_RATE     (ADC_CLOCK_HZ / ADC_CYCLES_PER_SAMPLE)
+
+/* Power up the ADC and wait until it is ready. Safe to call again.        */
+void adc_init(void);
+
+/* Hand GPIO 26 + input to the ADC: digital input and pulls off            */
+void adc_gpio_init(uint32_t input);
+
+/* One conversion on one input, busy-waiting ~2 µs. Not while streaming.   */
+uint16_t adc_read(uint32_t input);
+
+/* ── Streaming ───────────────────────────────────────────────────────────────
+   The ADC free-runs at sample_rate_hz, cycling through the inputs in
+   input_mask, each result going through the FIFO to DMA. Two chained DMA
+   channels fill two buffers in turn: when one buffer is full the other
+   channel is already filling the next, and DMA_IRQ_0 calls on_block()
+   with the full one. The CPU sees one interrupt per block instead of one
+   per sample.
+
+   on_block() runs in the interrupt and owns its buffer until the other
+   buffer is full, i.e. for one block time — copy out, or notify a task
+   and let it work on the block in place.
+
+   With more than one input, samples interleave in ascending input order
+   starting with the lowest: block_samples must be a multiple of the number
+   of inputs so every block starts at the lowest one. sample_rate_hz is the
+   total; each input gets its share.
+
+   DMA_IRQ_0 belongs to this driver while streaming (DMA_IRQ_1 is the
+   UART's).
+   ────────────────────────────────────────────────────────────────────────── */
+typedef void (*adc_block_fn)(const uint16_t *block, uint32_t samples,
+                             void *user_data);
+
+struct adc_stream_config {
+    uint32_t input_mask;            /* bit n = AINn                         */
+    uint32_t sample_rate_hz;        /* up to ADC_MAX_SAMPLE_RATE            */
+    uint16_t *buffers[2];
+    uint32_t block_samples;         /* per buffer                           */
+    adc_block_fn on_block;
+    void *user_data;
+};
+
+struct adc_stream_stats {
+    uint32_t blocks;                /* completed, passed to on_block()      */
+    uint32_t late;                  /* a buffer got re-armed after its turn
+                                       had come: on_block() ran too long    */
+    uint32_t fifo_overflows;        /* the DMA fell behind the ADC          */
+    uint32_t conversion_errors;
+};
+
+/* Claims two DMA channels and starts converting. 0 or -1 (bad config,
+   no channels, already streaming).                                         */
+int  adc_stream_start(const struct adc_stream_config *config);
+
+/* Stop converting, stop the DMA and release its channels                  */
+void adc_stream_stop(void);
+
+const struct adc_stream_stats *adc_stream_get_stats(void);
+
+#endif
@@ -0,0 +1,133 @@
+#include <stdint.h>
+#include "rp2040.h"
+#include "clocks.h"
+#include "sections.h"
+#include "timer.h"
+#include "boot_profile.h"
+
+#if BOOT_PROFILE
+
+/* .noinit: the first mark is taken before .bss is zeroed, and keeping the
+   buffer out of .data/.bss means STARTUP_DMA can fill those in parallel.   */
+NOINIT struct boot_timeline boot_timeline;
+
+static const char *const mark_names[BOOT_MARK_COUNT] = {
+    [BOOT_MARK_HANDOFF]  = "handoff",
+    [BOOT_MARK_RAM_INIT] = "ram_init",
+    [BOOT_MARK_CLOCKS]   = "clocks",
+    [BOOT_MARK_VECTORS]  = "vectors",
+    [BOOT_MARK_TIMER]    = "timer",
+    [BOOT_MARK_MAIN]     = "main",
+    [BOOT_MARK_RESETS]   = "resets",
+    [BOOT_MARK_GPIO]     = "gpio",
+    [BOOT_MARK_SYSTICK]  = "systick",
+    [BOOT_MARK_LOOP]     = "loop",
+};
+
+void boot_profile_start(void) {
+    /* No TICKINT: nothing has a handler ready yet, and this only counts.
+       main()'s systick_init() later restarts SysTick from zero — by then
+       the TIMER is running and cycles are no longer needed.                */
+    SYST_RVR = SYST_CVR_MASK;
+    SYST_CVR = 0;
+    SYST_CSR = SYST_CSR_CLKSOURCE | SYST_CSR_ENABLE;
+
+    boot_timeline.magic = BOOT_TIMELINE_MAGIC;
+    boot_timeline.count = 0;
+    boot_timeline.timer_running = 0;
+
+    boot_profile_mark(BOOT_MARK_HANDOFF);
+}
+
+void boot_profile_timer_started(void) {
+    boot_timeline.timer_running = 1;
+}
+
+void boot_profile_mark(enum boot_mark id) {
+    /* Read the clocks first so the bookkeeping below is not timed          */
+    const uint32_t cycles = SYST_CVR & SYST_CVR_MASK;
+    const uint32_t has_time_us = boot_timeline.timer_running;
+    const uint32_t time_us = has_time_us ? time_us_32() : 0;
+
+    if (boot_timeline.count >= BOOT_TIMELINE_MAX) {
+        return;
+    }
+
+    struct boot_sample *s = &boot_timeline.samples[boot_timeline.count++];
+    s->cycles      = cycles;
+    s->time_us     = time_us;
+    s->id          = (uint8_t)id;
+    s->has_time_us = (uint8_t)has_time_us;
+}
+
+/* Length of the phase that ended at cur, in µs. on_rosc says whether the
+   phase ran before clocks_init() switched clk_sys over; if it did and has
+   to be worked out from cycles, *estimate is set.                          */
+static uint32_t phase_us(const struct boot_sample *prev,
+                         const struct boot_sample *cur, int on_rosc,
+                         int *estimate) {
+    *estimate = 0;
+
+    if (prev->has_time_us && cur->has_time_us) {
+        return cur->time_us - prev->time_us;
+    }
+
+    /* SysTick counts down and wraps at 24 bits. A single phase must stay
+       under 2^24 cycles: ~2.5 s on the ROSC, ~134 ms at 125 MHz.           */
+    const uint32_t cycles = (prev->cycles - cur->cycles) & SYST_CVR_MASK;
+
+    uint32_t hz;
+    if (on_rosc) {
+        hz = ROSC_NOMINAL_HZ;
+        *estimate = 1;
+    } else {
+        hz = clock_get_hz(CLK_SYS);
+    }
+
+    return (uint32_t)(((uint64_t)cycles * 1000000u) / hz);
+}
+
+void boot_profile_dump(putc_fn out) {
+    const struct boot_timeline *t = &boot_timeline;
+
+    if (t->magic != BOOT_TIMELINE_MAGIC || t->count == 0) {
+        print_str(out, "boot timeline: no samples\r\n");
+        return;
+    }
+
+    print_str(out, "boot timeline (us)\r\n");
+
+    uint32_t total = 0;
+    int any_estimate = 0;
+    /* Everything up to and including the clocks phase ran (mostly) on the
+       ROSC; the switch to PLL_SYS is the last thing clocks_init() does.
+       Tracked by sequence, not id: STARTUP_DMA marks RAM_INIT after it.    */
+    int clocks_done = 0;
+
+    for (uint32_t i = 1; i < t->count; i++) {
+        const struct boot_sample *cur = &t->samples[i];
+        int estimate;
+        const uint32_t us = phase_us(&t->samples[i - 1], cur,
+                                     !clocks_done, &estimate);
+
+        if (cur->id == BOOT_MARK_CLOCKS) {
+            clocks_done = 1;
+        }
+
+        total += us;
+        any_estimate |= estimate;
+
+        print_str(out, "  ");
+        print_str(out, cur->id < BOOT_MARK_COUNT ? mark_names[cur->id] : "?");
+        print_str(out, estimate ? "\t~" : "\t ");
+        print_dec_width(out, us, 8);
+        print_str(out, "\r\n");
+    }
+
+    print_str(out, "  total");
+    print_str(out, any_estimate ? "\t~" : "\t ");
+    print_dec_width(out, total, 8);
+    print_str(out, "\r\n");
+}
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef BOOT_PROFILE_H
+#define BOOT_PROFILE_H
+
+#include <stdint.h>
+#include "print.h"
+
+/* ── Boot timeline ───────────────────────────────────────────────────────────
+   Build with make BOOT_PROFILE=1 to timestamp each phase of startup, from
+   the moment boot2 hands over to Reset_Handler until main() enters its loop.
+
+   Two time sources, because the good one is not available at first:
+   - SysTick, free-running from Reset_Handler entry. It counts clk_sys
+     cycles, so it works before any peripheral is out of reset — but
+     clk_sys is the ~6.5 MHz ROSC until clocks_init() switches it, and the
+     ROSC frequency is only known to about ±50%.
+   - The 64-bit TIMER (1 µs, exact) from the moment timer_init() returns.
+
+   Samples go into boot_timeline in .noinit. Nothing in startup clears it,
+   it is written before .data/.bss exist, and it survives a warm reset, so
+   a debugger can read it after the fact:
+       (gdb) p boot_timeline
+   boot_profile_dump() prints the same thing as text through any sink.
+
+   With BOOT_PROFILE=0 (the default) every call below compiles to nothing.
+   ────────────────────────────────────────────────────────────────────────── */
+#ifndef BOOT_PROFILE
+#define BOOT_PROFILE 0
+#endif
+
+/* Phases, in the order they occur. Each mark ends the phase before it.     */
+enum boot_mark {
+    BOOT_MARK_HANDOFF = 0,  /* Reset_Handler entered (boot2 is done)        */
+    BOOT_MARK_RAM_INIT,     /* .data/.ramfunc copied, .bss zeroed           */
+    BOOT_MARK_CLOCKS,       /* XOSC, PLLs and clock generators up           */
+    BOOT_MARK_VECTORS,      /* vector table in RAM                          */
+    BOOT_MARK_TIMER,        /* TIMER running — exact timestamps from here   */
+    BOOT_MARK_MAIN,         /* main() entered                               */
+    BOOT_MARK_RESETS,       /* resets_init() done                           */
+    BOOT_MARK_GPIO,         /* gpio_init() done                             */
+    BOOT_MARK_SYSTICK,      /* systick_init() done                          */
+    BOOT_MARK_LOOP,         /* main loop reached                            */
+    BOOT_MARK_COUNT
+};
+
+#define BOOT_TIMELINE_MAX       16u
+#define BOOT_TIMELINE_MAGIC     0xB0071AE5u
+
+/* One timestamp. time_us is only valid when has_time_us is set; before the
+   TIMER runs, cycles (SysTick CVR, counting down) is the only clock.       */
+struct boot_sample {
+    uint32_t cycles;
+    uint32_t time_us;
+    uint8_t  id;            /* enum boot_mark                               */
+    uint8_t  has_time_us;
+    uint16_t reserved;
+};
+
+struct boot_timeline {
+    uint32_t magic;         /* BOOT_TIMELINE_MAGIC once a boot has recorded */
+    uint32_t count;
+    uint32_t timer_running;
+    struct boot_sample samples[BOOT_TIMELINE_MAX];
+};
+
+#if BOOT_PROFILE
+
+extern struct boot_timeline boot_timeline;
+
+/* First thing in Reset_Handler: start SysTick free-running over its full
+   24-bit range and record BOOT_MARK_HANDOFF.                               */
+void boot_profile_start(void);
+
+/* Called once timer_init() has returned; later marks also take TIMER µs   */
+void boot_profile_timer_started(void);
+
+void boot_profile_mark(enum boot_mark id);
+
+/* Print one line per phase: its name and how long it took, in µs.
+   Values prefixed with '~' were timed in ROSC cycles and are estimates.    */
+void boot_profile_dump(putc_fn out);
+
+#else
+
+static inline void boot_profile_start(void) {}
+static inline void boot_profile_timer_started(void) {}
+static inline void boot_profile_mark(enum boot_mark id) { (void)id; }
+static inline void boot_profile_dump(putc_fn out) { (void)out; }
+
+#endif
+
+#endif
@@ -0,0 +1,295 @@
+#include <stdint.h>
+#include "rp2040.h"
+#include "clocks.h"
+#include "watchdog.h"
+
+/* ── XOSC (crystal oscillator) ───────────────────────────────────────────────
+   The Pico board has a 12 MHz crystal. Unlike the ROSC (ring oscillator,
+   ~6 MHz, drifts with voltage and temperature) it is accurate to a few ppm,
+   which is what every timing calculation in the firmware relies on.
+
+   CTRL:    FREQ_RANGE (bits 11:0) must be 0xAA0 for a 1-15 MHz crystal.
+            ENABLE     (bits 23:12) takes a magic value: 0xFAB = enable.
+   STATUS:  bit 31 (STABLE) goes high once the startup delay has elapsed.
+   STARTUP: delay in units of 256 XOSC cycles before STABLE is asserted.
+   ────────────────────────────────────────────────────────────────────────── */
+#define XOSC_BASE                 0x40024000u
+#define XOSC_CTRL                 MMIO32(XOSC_BASE + 0x00)
+#define XOSC_STATUS               MMIO32(XOSC_BASE + 0x04)
+#define XOSC_STARTUP              MMIO32(XOSC_BASE + 0x0C)
+
+#define XOSC_CTRL_FREQ_RANGE_1_15MHZ  0xAA0u
+#define XOSC_CTRL_ENABLE_VALUE        (0xFABu << 12)
+#define XOSC_STATUS_STABLE            (1u << 31)
+
+/* ~1 ms startup delay: (12 MHz / 1000) / 256 rounded up = 47               */
+#define XOSC_STARTUP_DELAY        (((XOSC_HZ / 1000u) + 255u) / 256u)
+
+/* ── PLL_SYS / PLL_USB ───────────────────────────────────────────────────────
+   Both PLLs are identical blocks at different base addresses.
+
+   CS:        REFDIV (bits 5:0), LOCK (bit 31) set once the VCO is stable
+   PWR:       power-down bits — PD (0), POSTDIVPD (3), VCOPD (5)
+   FBDIV_INT: feedback divider, VCO = ref / REFDIV * FBDIV
+   PRIM:      POSTDIV1 (bits 18:16), POSTDIV2 (bits 14:12)
+   ────────────────────────────────────────────────────────────────────────── */
+#define PLL_SYS_BASE              0x40028000u
+#define PLL_USB_BASE              0x4002C000u
+
+#define PLL_CS(base)              MMIO32((base) + 0x00)
+#define PLL_PWR(base)             MMIO32((base) + 0x04)
+#define PLL_FBDIV_INT(base)       MMIO32((base) + 0x08)
+#define PLL_PRIM(base)            MMIO32((base) + 0x0C)
+
+#define PLL_CS_LOCK               (1u << 31)
+#define PLL_PWR_PD                (1u << 0)
+#define PLL_PWR_POSTDIVPD         (1u << 3)
+#define PLL_PWR_VCOPD             (1u << 5)
+
+/* ── CLOCKS ──────────────────────────────────────────────────────────────────
+   Every clock generator has the same three registers, 12 bytes apart:
+   CTRL     — SRC (glitchless mux, clk_ref/clk_sys only), AUXSRC, ENABLE
+   DIV      — 24.8 fixed point divider (integer in bits 31:8)
+   SELECTED — one-hot view of which glitchless source is currently in use
+
+   clk_ref and clk_sys have a glitchless mux and can be switched while
+   running. The others only have an aux mux and must be stopped first.
+   ────────────────────────────────────────────────────────────────────────── */
+#define CLOCKS_BASE               0x40008000u
+#define CLK_CTRL(clk)             MMIO32(CLOCKS_BASE + (clk) * 12u + 0x0)
+#define CLK_DIV(clk)              MMIO32(CLOCKS_BASE + (clk) * 12u + 0x4)
+#define CLK_SELECTED(clk)         MMIO32(CLOCKS_BASE + (clk) * 12u + 0x8)
+#define CLK_SYS_RESUS_CTRL        MMIO32(CLOCKS_BASE + 0x78)
+
+#define CLK_CTRL_SRC_LSB          0
+#define CLK_CTRL_SRC_MASK         0x3u
+#define CLK_CTRL_AUXSRC_LSB       5
+#define CLK_CTRL_AUXSRC_MASK      (0x7u << CLK_CTRL_AUXSRC_LSB)
+#define CLK_CTRL_ENABLE           (1u << 11)
+
+/* Source selections used below */
+#define CLK_REF_SRC_ROSC          0u
+#define CLK_REF_SRC_XOSC          2u
+#define CLK_SYS_SRC_CLK_REF       0u
+#define CLK_SYS_SRC_AUX           1u
+#define CLK_SYS_AUX_PLL_SYS       0u
+#define CLK_PERI_AUX_CLK_SYS      0u
+#define CLK_USB_AUX_PLL_USB       0u   /* same encoding for clk_adc/clk_rtc  */
+
+/* ── WATCHDOG tick generator ────────────────────────────────────────────────
+   The TIMER and watchdog count "ticks" derived from clk_ref. Dividing the
+   12 MHz reference by 12 gives exactly one tick per microsecond.
+   Registers in watchdog.h.
+   ────────────────────────────────────────────────────────────────────────── */
+
+/* ── Reading frequencies back ────────────────────────────────────────────────
+   clock_get_hz() works out each frequency from the registers themselves
+   rather than remembering what clocks_init() asked for, so the answer
+   stays right if anything reconfigures a clock later. It divides at run
+   time, so it is not for use before startup has copied .time_critical to
+   RAM (see STARTUP_DMA in startup.c); clocks_init() does not call it.
+
+   Each generator's AUXSRC field encodes its possible sources differently;
+   these tables translate the field into one common set.
+   ────────────────────────────────────────────────────────────────────────── */
+enum clock_source {
+    SRC_NONE = 0,       /* GPIN inputs and anything else we do not track   */
+    SRC_ROSC,
+    SRC_XOSC,
+    SRC_PLL_SYS,
+    SRC_PLL_USB,
+    SRC_CLK_REF,
+    SRC_CLK_SYS,
+};
+
+static const uint8_t sys_aux_sources[]  = { SRC_PLL_SYS, SRC_PLL_USB,
+                                            SRC_ROSC, SRC_XOSC };
+static const uint8_t peri_aux_sources[] = { SRC_CLK_SYS, SRC_PLL_SYS,
+                                            SRC_PLL_USB, SRC_ROSC, SRC_XOSC };
+/* clk_usb, clk_adc and clk_rtc share one encoding                          */
+static const uint8_t usb_aux_sources[]  = { SRC_PLL_USB, SRC_PLL_SYS,
+                                            SRC_ROSC, SRC_XOSC };
+
+static void xosc_init(void) {
+    XOSC_CTRL    = XOSC_CTRL_FREQ_RANGE_1_15MHZ;
+    XOSC_STARTUP = XOSC_STARTUP_DELAY;
+    XOSC_CTRL    = XOSC_CTRL_FREQ_RANGE_1_15MHZ | XOSC_CTRL_ENABLE_VALUE;
+
+    while (!(XOSC_STATUS & XOSC_STATUS_STABLE));
+}
+
+static void pll_init(uint32_t base, uint32_t refdiv, uint32_t fbdiv,
+                     uint32_t postdiv1, uint32_t postdiv2) {
+    /* Program dividers while everything is still powered down            */
+    PLL_CS(base)        = refdiv;
+    PLL_FBDIV_INT(base) = fbdiv;
+
+    /* Power up the main PLL and VCO, then wait for it to lock             */
+    hw_clear_bits(&PLL_PWR(base), PLL_PWR_PD | PLL_PWR_VCOPD);
+    while (!(PLL_CS(base) & PLL_CS_LOCK));
+
+    /* Only now switch the post dividers in                                */
+    PLL_PRIM(base)    = (postdiv1 << 16) | (postdiv2 << 12);
+    hw_clear_bits(&PLL_PWR(base), PLL_PWR_POSTDIVPD);
+}
+
+/* PLL outputs and the 24.8 DIV value for each generator, as constant
+   expressions. clocks_init() must not divide at run time: the divide
+   routines (divider.S) run from RAM, and with STARTUP_DMA the RAM copy is
+   still in flight while the clocks come up.                               */
+#define PLL_SYS_HZ                (XOSC_HZ / PLL_SYS_REFDIV * PLL_SYS_FBDIV \
+                                   / PLL_SYS_POSTDIV1 / PLL_SYS_POSTDIV2)
+#define PLL_USB_HZ                (XOSC_HZ / PLL_USB_REFDIV * PLL_USB_FBDIV \
+                                   / PLL_USB_POSTDIV1 / PLL_USB_POSTDIV2)
+#define CLK_DIV_FOR(src_hz, hz)   ((uint32_t)(((uint64_t)(src_hz) << 8) / (hz)))
+
+static void clock_configure(enum clock_index clk, uint32_t src,
+                            uint32_t auxsrc, uint32_t div) {
+    const int glitchless = (clk == CLK_REF) || (clk == CLK_SYS);
+
+    /* If increasing the divider, do it first so the clock never runs
+       faster than either the old or the new configuration                 */
+    if (clk != CLK_PERI && div > CLK_DIV(clk)) {
+        CLK_DIV(clk) = div;
+    }
+
+    if (glitchless) {
+        /* Step off the aux mux before touching AUXSRC: selecting source 0
+           on the glitchless mux is always safe                            */
+        hw_clear_bits(&CLK_CTRL(clk), CLK_CTRL_SRC_MASK);
+        while (!(CLK_SELECTED(clk) & 1u));
+    } else {
+        /* No glitchless mux: stop the clock, then give it a few cycles of
+           its (possibly slow) current source to actually stop            */
+        hw_clear_bits(&CLK_CTRL(clk), CLK_CTRL_ENABLE);
+        for (volatile uint32_t i = 0; i < 1000u; i++);
+    }
+
+    /* Write AUXSRC with a single store: XOR in only the bits that differ  */
+    hw_write_masked(&CLK_CTRL(clk), FIELD_PREP(CLK_CTRL_AUXSRC, auxsrc),
+                    CLK_CTRL_AUXSRC_MASK);
+
+    if (glitchless) {
+        hw_write_masked(&CLK_CTRL(clk), FIELD_PREP(CLK_CTRL_SRC, src),
+                        CLK_CTRL_SRC_MASK);
+        while (!(CLK_SELECTED(clk) & (1u << src)));
+    }
+
+    hw_set_bits(&CLK_CTRL(clk), CLK_CTRL_ENABLE);
+    if (clk != CLK_PERI) {      /* clk_peri has no divider on the RP2040   */
+        CLK_DIV(clk) = div;
+    }
+}
+
+void clocks_init(void) {
+    /* The resus block would "rescue" clk_sys if it stopped — we are about
+       to stop it on purpose, so keep it out of the way                     */
+    CLK_SYS_RESUS_CTRL = 0;
+
+    xosc_init();
+
+    /* Park clk_sys on clk_ref and clk_ref on the ROSC while the PLLs are
+       reset and reprogrammed underneath them                               */
+    hw_clear_bits(&CLK_CTRL(CLK_SYS), CLK_CTRL_SRC_MASK);
+    while (!(CLK_SELECTED(CLK_SYS) & 1u));
+    hw_clear_bits(&CLK_CTRL(CLK_REF), CLK_CTRL_SRC_MASK);
+    while (!(CLK_SELECTED(CLK_REF) & 1u));
+
+    reset_block(RESET_PLL_SYS | RESET_PLL_USB);
+    unreset_block_wait(RESET_PLL_SYS | RESET_PLL_USB);
+
+    pll_init(PLL_SYS_BASE, PLL_SYS_REFDIV, PLL_SYS_FBDIV,
+             PLL_SYS_POSTDIV1, PLL_SYS_POSTDIV2);
+    pll_init(PLL_USB_BASE, PLL_USB_REFDIV, PLL_USB_FBDIV,
+             PLL_USB_POSTDIV1, PLL_USB_POSTDIV2);
+
+    clock_configure(CLK_REF,  CLK_REF_SRC_XOSC, 0,
+                    CLK_DIV_FOR(XOSC_HZ, XOSC_HZ));
+    clock_configure(CLK_SYS,  CLK_SYS_SRC_AUX, CLK_SYS_AUX_PLL_SYS,
+                    CLK_DIV_FOR(PLL_SYS_HZ, PLL_SYS_HZ));
+    clock_configure(CLK_USB,  0, CLK_USB_AUX_PLL_USB,
+                    CLK_DIV_FOR(PLL_USB_HZ, PLL_USB_HZ));
+    clock_configure(CLK_ADC,  0, CLK_USB_AUX_PLL_USB,
+                    CLK_DIV_FOR(PLL_USB_HZ, PLL_USB_HZ));
+    clock_configure(CLK_RTC,  0, CLK_USB_AUX_PLL_USB,
+                    CLK_DIV_FOR(PLL_USB_HZ, 46875u));
+    clock_configure(CLK_PERI, 0, CLK_PERI_AUX_CLK_SYS,
+                    CLK_DIV_FOR(PLL_SYS_HZ, PLL_SYS_HZ));
+
+    /* 1 µs ticks for TIMER and watchdog                                    */
+    WATCHDOG_TICK = FIELD_PREP(WATCHDOG_TICK_CYCLES, XOSC_HZ / 1000000u)
+                  | WATCHDOG_TICK_ENABLE;
+}
+
+static uint32_t pll_get_hz(uint32_t base) {
+    const uint32_t refdiv   = PLL_CS(base) & 0x3Fu;
+    const uint32_t fbdiv    = PLL_FBDIV_INT(base) & 0xFFFu;
+    const uint32_t postdiv1 = (PLL_PRIM(base) >> 16) & 0x7u;
+    const uint32_t postdiv2 = (PLL_PRIM(base) >> 12) & 0x7u;
+
+    if ((PLL_PWR(base) & (PLL_PWR_PD | PLL_PWR_VCOPD | PLL_PWR_POSTDIVPD))
+        || refdiv == 0 || postdiv1 == 0 || postdiv2 == 0) {
+        return 0;
+    }
+    return XOSC_HZ / refdiv * fbdiv / postdiv1 / postdiv2;
+}
+
+static uint32_t source_get_hz(enum clock_source src) {
+    switch (src) {
+    case SRC_ROSC:    return ROSC_NOMINAL_HZ;
+    case SRC_XOSC:    return XOSC_HZ;
+    case SRC_PLL_SYS: return pll_get_hz(PLL_SYS_BASE);
+    case SRC_PLL_USB: return pll_get_hz(PLL_USB_BASE);
+    case SRC_CLK_REF: return clock_get_hz(CLK_REF);
+    case SRC_CLK_SYS: return clock_get_hz(CLK_SYS);
+    default:          return 0;
+    }
+}
+
+static enum clock_source aux_source(const uint8_t *table, uint32_t entries,
+                                    uint32_t ctrl) {
+    const uint32_t aux = (ctrl & CLK_CTRL_AUXSRC_MASK) >> CLK_CTRL_AUXSRC_LSB;
+    return aux < entries ? (enum clock_source)table[aux] : SRC_NONE;
+}
+
+uint32_t clock_get_hz(enum clock_index clk) {
+    const uint32_t ctrl = CLK_CTRL(clk);
+    enum clock_source src;
+
+    switch (clk) {
+    case CLK_REF:
+        /* SRC: 0 = ROSC, 1 = aux (PLL_USB is aux source 0), 2 = XOSC     */
+        src = (ctrl & CLK_CTRL_SRC_MASK) == CLK_REF_SRC_XOSC ? SRC_XOSC
+            : (ctrl & CLK_CTRL_SRC_MASK) == CLK_REF_SRC_ROSC ? SRC_ROSC
+            : (ctrl & CLK_CTRL_AUXSRC_MASK) == 0             ? SRC_PLL_USB
+            : SRC_NONE;
+        break;
+    case CLK_SYS:
+        src = (ctrl & 1u) == CLK_SYS_SRC_CLK_REF ? SRC_CLK_REF
+            : aux_source(sys_aux_sources, sizeof sys_aux_sources, ctrl);
+        break;
+    case CLK_PERI:
+        if (!(ctrl & CLK_CTRL_ENABLE)) {
+            return 0;
+        }
+        return source_get_hz(aux_source(peri_aux_sources,
+                                        sizeof peri_aux_sources, ctrl));
+    case CLK_USB:
+    case CLK_ADC:
+    case CLK_RTC:
+        if (!(ctrl & CLK_CTRL_ENABLE)) {
+            return 0;
+        }
+        src = aux_source(usb_aux_sources, sizeof usb_aux_sources, ctrl);
+        break;
+    default:
+        return 0;   /* GPOUT clocks are not tracked                          */
+    }
+
+    /* DIV is 24.8 fixed point; an integer part of 0 means divide by 2^16  */
+    uint32_t div = CLK_DIV(clk);
+    if ((div >> 8) == 0) {
+        div += 1u << 24;
+    }
+    return (uint32_t)(((uint64_t)source_get_hz(src) << 8) / div);
+}
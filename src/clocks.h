@@ -0,0 +1,68 @@
+#ifndef CLOCKS_H
+#define CLOCKS_H
+
+#include <stdint.h>
+
+/* ── Clock tree configuration ────────────────────────────────────────────────
+   clk_sys = 12 MHz XOSC / REFDIV * FBDIV / POSTDIV1 / POSTDIV2
+
+   The VCO (12 MHz * FBDIV / REFDIV) must stay between 750 and 1600 MHz.
+   Defaults give 1500 MHz / 6 / 2 = 125 MHz, the RP2040's rated speed.
+   Build with -DPLL_SYS_FBDIV=133 for 1596 MHz / 6 / 2 = 133 MHz.
+   ────────────────────────────────────────────────────────────────────────── */
+#define XOSC_HZ             12000000u
+
+/* The ROSC frequency varies from chip to chip and with voltage and
+   temperature; this is only the nominal value after reset.                 */
+#define ROSC_NOMINAL_HZ     6500000u
+
+#ifndef PLL_SYS_REFDIV
+#define PLL_SYS_REFDIV      1u
+#endif
+#ifndef PLL_SYS_FBDIV
+#define PLL_SYS_FBDIV       125u
+#endif
+#ifndef PLL_SYS_POSTDIV1
+#define PLL_SYS_POSTDIV1    6u
+#endif
+#ifndef PLL_SYS_POSTDIV2
+#define PLL_SYS_POSTDIV2    2u
+#endif
+
+/* PLL_USB must produce exactly 48 MHz for USB: 1200 MHz / 5 / 5              */
+#define PLL_USB_REFDIV      1u
+#define PLL_USB_FBDIV       100u
+#define PLL_USB_POSTDIV1    5u
+#define PLL_USB_POSTDIV2    5u
+
+/* ── Clock identifiers ───────────────────────────────────────────────────────
+   Order matches the hardware: each generator is 12 bytes further along
+   from CLOCKS_BASE, starting with the four GPOUT clocks.
+   ────────────────────────────────────────────────────────────────────────── */
+enum clock_index {
+    CLK_GPOUT0 = 0,
+    CLK_GPOUT1,
+    CLK_GPOUT2,
+    CLK_GPOUT3,
+    CLK_REF,
+    CLK_SYS,
+    CLK_PERI,
+    CLK_USB,
+    CLK_ADC,
+    CLK_RTC,
+    CLK_COUNT
+};
+
+/* Bring up XOSC and both PLLs, then move every clock generator onto them.
+   Called once from Reset_Handler before main(). Also starts the watchdog
+   tick generator so the 64-bit TIMER counts in microseconds.
+   Touches only hardware registers and the stack — no .data/.bss.            */
+void clocks_init(void);
+
+/* Current frequency in Hz of the given generator, worked out from the
+   clock and PLL registers. Peripherals derive their dividers from this
+   instead of hardcoding. Returns 0 for a stopped clock or one fed from a
+   source we cannot know (GPIN pins); ROSC-derived values are nominal.       */
+uint32_t clock_get_hz(enum clock_index clk);
+
+#endif
@@ -0,0 +1,46 @@
+#include <stdint.h>
+#include "timer.h"
+#include "uart.h"
+#include "dlog.h"
+
+#define DLOG_HEADER_BYTES   8u
+
+static int dlog_uart = -1;
+static volatile uint32_t dropped;
+
+void dlog_init(uint32_t uart) {
+    dlog_uart = (int)uart;
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+void dlog_write(uint32_t id, uint32_t nargs, const uint32_t *args) {
+    if (dlog_uart < 0) {
+        return;
+    }
+
+    uint8_t frame[DLOG_HEADER_BYTES + 4u * DLOG_MAX_ARGS];
+    frame[0] = DLOG_SYNC;
+    frame[1] = (uint8_t)id;
+    frame[2] = (uint8_t)(id >> 8);
+    frame[3] = (uint8_t)nargs;
+    put_u32(&frame[4], time_us_32());
+    for (uint32_t i = 0; i < nargs; i++) {
+        put_u32(&frame[DLOG_HEADER_BYTES + 4u * i], args[i]);
+    }
+
+    /* Half a record would desynchronise the decoder: all or nothing        */
+    if (uart_write_all((uint32_t)dlog_uart, frame,
+                       DLOG_HEADER_BYTES + 4u * nargs) < 0) {
+        dropped++;
+    }
+}
+
+uint32_t dlog_dropped(void) {
+    return dropped;
+}
@@ -0,0 +1,59 @@
+#ifndef DLOG_H
+#define DLOG_H
+
+#include <stdint.h>
+
+/* ── Deferred logging ────────────────────────────────────────────────────────
+   DLOG("adc ch%u = %d mV", ch, mv);
+
+   Nothing is formatted on the device. The format string goes into the
+   .dlog section, which the linker keeps in the ELF but never loads into
+   flash (see linker.ld); its offset there is its ID. At run time a log
+   site only sends that ID, a timestamp and the raw argument words:
+
+       0xD1  id (u16)  nargs (u8)  time_us (u32)  args (u32 × nargs)
+
+   all little-endian, one uart_write() per record so records from several
+   tasks, ISRs or both cores never interleave. tools/dlog_decode.py reads
+   the strings back out of the ELF and formats the records on the host.
+
+   Arguments are 32-bit words: integers as they are, pointers cast to
+   uint32_t, floats through dlog_f32() so the bits travel unconverted
+   (format them with %f). %s cannot work — the string is not on the host.
+   At most DLOG_MAX_ARGS arguments.
+   ────────────────────────────────────────────────────────────────────────── */
+#define DLOG_SYNC       0xD1u
+#define DLOG_MAX_ARGS   8u
+
+/* Send records on this UART (uart_init() it first). Until called, DLOG()
+   records are dropped.                                                     */
+void dlog_init(uint32_t uart);
+
+void dlog_write(uint32_t id, uint32_t nargs, const uint32_t *args);
+
+/* Records dropped because the UART TX ring had no room for them            */
+uint32_t dlog_dropped(void);
+
+static inline uint32_t dlog_f32(float f) {
+    union { float f; uint32_t u; } v = { .f = f };
+    return v.u;
+}
+
+#define DLOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, n, ...) n
+#define DLOG_NARGS(...) \
+    DLOG_NARGS_(0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+
+/* The leading 0 keeps the array non-empty for argument-less records; the
+   "used" string is referenced only through its address                    */
+#define DLOG(fmt, ...)                                                       \
+    do {                                                                     \
+        static const char dlog_fmt_[]                                        \
+            __attribute__((section(".dlog"), used)) = fmt;                   \
+        _Static_assert(DLOG_NARGS(__VA_ARGS__) <= DLOG_MAX_ARGS,             \
+                       "too many DLOG arguments");                           \
+        const uint32_t dlog_args_[] = { 0, ##__VA_ARGS__ };                  \
+        dlog_write((uint32_t)dlog_fmt_, DLOG_NARGS(__VA_ARGS__),             \
+                   &dlog_args_[1]);                                          \
+    } while (0)
+
+#endif
@@ -0,0 +1,89 @@
+#include <stdint.h>
+#include "rp2040.h"
+#include "sync.h"
+#include "dma.h"
+
+/* One bit per channel. Claims happen at init time, from main() or a task,
+   on either core; the shared claim spinlock keeps two of them (or one and
+   an ISR) from tearing the read-modify-write.                              */
+static uint32_t claimed_channels;
+
+void dma_init(void) {
+    /* No reset_block() here: another driver may already be using DMA, and
+       putting the block back into reset would kill its transfers          */
+    unreset_block_wait(RESET_DMA);
+}
+
+int dma_claim_unused_channel(void) {
+    spin_lock_t *lock = spin_lock_instance(SPINLOCK_ID_CLAIM);
+    const uint32_t saved = spin_lock_blocking(lock);
+    int ch = -1;
+
+    for (uint32_t i = 0; i < DMA_NUM_CHANNELS; i++) {
+        if (!(claimed_channels & (1u << i))) {
+            claimed_channels |= 1u << i;
+            ch = (int)i;
+            break;
+        }
+    }
+
+    spin_unlock(lock, saved);
+    return ch;
+}
+
+int dma_channel_claim(uint32_t ch) {
+    spin_lock_t *lock = spin_lock_instance(SPINLOCK_ID_CLAIM);
+    const uint32_t saved = spin_lock_blocking(lock);
+    int result = -1;
+
+    if (!(claimed_channels & (1u << ch))) {
+        claimed_channels |= 1u << ch;
+        result = 0;
+    }
+
+    spin_unlock(lock, saved);
+    return result;
+}
+
+void dma_channel_unclaim(uint32_t ch) {
+    spin_lock_t *lock = spin_lock_instance(SPINLOCK_ID_CLAIM);
+    const uint32_t saved = spin_lock_blocking(lock);
+    claimed_channels &= ~(1u << ch);
+    spin_unlock(lock, saved);
+}
+
+void dma_channel_configure(uint32_t ch, const dma_channel_config *config,
+                           volatile void *write_addr,
+                           const volatile void *read_addr,
+                           uint32_t transfer_count, int trigger) {
+    DMA_READ_ADDR(ch)   = (uint32_t)read_addr;
+    DMA_WRITE_ADDR(ch)  = (uint32_t)write_addr;
+    DMA_TRANS_COUNT(ch) = transfer_count;
+
+    /* CTRL_TRIG starts the channel as a side effect of the write; AL1_CTRL
+       is the same register without the trigger                             */
+    if (trigger) {
+        DMA_CTRL_TRIG(ch) = config->ctrl;
+    } else {
+        DMA_AL1_CTRL(ch)  = config->ctrl;
+    }
+}
+
+void dma_channel_abort(uint32_t ch) {
+    /* RP2040-E13: an abort can raise a spurious completion interrupt.
+       Mask the channel's IRQs around it and drop anything it raised.       */
+    const uint32_t mask = 1u << ch;
+    const uint32_t inte0 = DMA_INTE0 & mask;
+    const uint32_t inte1 = DMA_INTE1 & mask;
+
+    hw_clear_bits(&DMA_INTE0, mask);
+    hw_clear_bits(&DMA_INTE1, mask);
+
+    DMA_CHAN_ABORT = mask;
+    while (DMA_CHAN_ABORT & mask);
+
+    DMA_INTS0 = mask;
+    DMA_INTS1 = mask;
+    hw_set_bits(&DMA_INTE0, inte0);
+    hw_set_bits(&DMA_INTE1, inte1);
+}
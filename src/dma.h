@@ -0,0 +1,249 @@
+#ifndef DMA_H
+#define DMA_H
+
+#include <stdint.h>
+#include "rp2040.h"
+
+/* ── DMA ─────────────────────────────────────────────────────────────────────
+   12 independent channels, each moving data between any two bus addresses
+   without the CPU. A channel is described by four registers, 0x40 apart:
+   READ_ADDR, WRITE_ADDR, TRANS_COUNT (transfers, not bytes) and CTRL.
+
+   The same four registers appear in several "alias" orders so that the
+   last one written in a burst is the one that triggers the channel;
+   CTRL_TRIG, AL1_TRANS_COUNT_TRIG and AL2_WRITE_ADDR_TRIG are used here.
+   ────────────────────────────────────────────────────────────────────────── */
+#define DMA_BASE                0x50000000u
+#define DMA_NUM_CHANNELS        12u
+
+#define DMA_CH_BASE(ch)         (DMA_BASE + 0x40u * (ch))
+#define DMA_READ_ADDR(ch)       MMIO32(DMA_CH_BASE(ch) + 0x00)
+#define DMA_WRITE_ADDR(ch)      MMIO32(DMA_CH_BASE(ch) + 0x04)
+#define DMA_TRANS_COUNT(ch)     MMIO32(DMA_CH_BASE(ch) + 0x08)
+#define DMA_CTRL_TRIG(ch)       MMIO32(DMA_CH_BASE(ch) + 0x0C)
+#define DMA_AL1_CTRL(ch)        MMIO32(DMA_CH_BASE(ch) + 0x10)
+#define DMA_AL1_TRANS_COUNT_TRIG(ch) MMIO32(DMA_CH_BASE(ch) + 0x1C)
+#define DMA_AL2_WRITE_ADDR_TRIG(ch)  MMIO32(DMA_CH_BASE(ch) + 0x2C)
+#define DMA_AL3_READ_ADDR_TRIG(ch)   MMIO32(DMA_CH_BASE(ch) + 0x3C)
+
+#define DMA_INTR                MMIO32(DMA_BASE + 0x400)
+#define DMA_INTE0               MMIO32(DMA_BASE + 0x404)
+#define DMA_INTS0               MMIO32(DMA_BASE + 0x40C)
+#define DMA_INTE1               MMIO32(DMA_BASE + 0x414)
+#define DMA_INTS1               MMIO32(DMA_BASE + 0x41C)
+#define DMA_MULTI_CHAN_TRIGGER  MMIO32(DMA_BASE + 0x430)
+#define DMA_CHAN_ABORT          MMIO32(DMA_BASE + 0x444)
+
+/* CTRL fields */
+#define DMA_CTRL_EN             (1u << 0)
+#define DMA_CTRL_HIGH_PRIORITY  (1u << 1)
+#define DMA_CTRL_DATA_SIZE_LSB  2
+#define DMA_CTRL_DATA_SIZE_MASK (0x3u << DMA_CTRL_DATA_SIZE_LSB)
+#define DMA_CTRL_INCR_READ      (1u << 4)
+#define DMA_CTRL_INCR_WRITE     (1u << 5)
+#define DMA_CTRL_RING_SIZE_LSB  6
+#define DMA_CTRL_RING_SIZE_MASK (0xFu << DMA_CTRL_RING_SIZE_LSB)
+#define DMA_CTRL_RING_SEL       (1u << 10)
+#define DMA_CTRL_CHAIN_TO_LSB   11
+#define DMA_CTRL_CHAIN_TO_MASK  (0xFu << DMA_CTRL_CHAIN_TO_LSB)
+#define DMA_CTRL_TREQ_SEL_LSB   15
+#define DMA_CTRL_TREQ_SEL_MASK  (0x3Fu << DMA_CTRL_TREQ_SEL_LSB)
+#define DMA_CTRL_IRQ_QUIET      (1u << 21)
+#define DMA_CTRL_BSWAP          (1u << 22)
+#define DMA_CTRL_BUSY           (1u << 24)
+
+#define RESET_DMA               (1u << 2)
+
+/* Transfer size per element */
+enum dma_size {
+    DMA_SIZE_8  = 0,
+    DMA_SIZE_16 = 1,
+    DMA_SIZE_32 = 2,
+};
+
+/* TREQ_SEL value meaning "no pacing, go as fast as the bus allows"         */
+#define DREQ_FORCE              0x3Fu
+
+/* ── Channel configuration ───────────────────────────────────────────────────
+   A config is just the CTRL word being built up before it is written, so
+   it can live on the stack and be copied freely. Start from
+   dma_channel_get_default_config() and adjust with the setters below.
+   ────────────────────────────────────────────────────────────────────────── */
+typedef struct {
+    uint32_t ctrl;
+} dma_channel_config;
+
+/* 32-bit transfers, read address increments, write address fixed,
+   unpaced, chained to itself (i.e. no chaining), enabled.                  */
+static inline dma_channel_config dma_channel_get_default_config(uint32_t ch) {
+    dma_channel_config c;
+    c.ctrl = DMA_CTRL_EN
+           | FIELD_PREP(DMA_CTRL_DATA_SIZE, DMA_SIZE_32)
+           | DMA_CTRL_INCR_READ
+           | FIELD_PREP(DMA_CTRL_CHAIN_TO, ch)
+           | FIELD_PREP(DMA_CTRL_TREQ_SEL, DREQ_FORCE);
+    return c;
+}
+
+static inline void channel_config_set_field(dma_channel_config *c,
+                                            uint32_t mask, uint32_t value) {
+    c->ctrl = (c->ctrl & ~mask) | (value & mask);
+}
+
+static inline void channel_config_set_read_increment(dma_channel_config *c,
+                                                     int incr) {
+    channel_config_set_field(c, DMA_CTRL_INCR_READ,
+                             incr ? DMA_CTRL_INCR_READ : 0);
+}
+
+static inline void channel_config_set_write_increment(dma_channel_config *c,
+                                                      int incr) {
+    channel_config_set_field(c, DMA_CTRL_INCR_WRITE,
+                             incr ? DMA_CTRL_INCR_WRITE : 0);
+}
+
+static inline void channel_config_set_transfer_data_size(dma_channel_config *c,
+                                                         enum dma_size size) {
+    channel_config_set_field(c, DMA_CTRL_DATA_SIZE_MASK,
+                             FIELD_PREP(DMA_CTRL_DATA_SIZE, size));
+}
+
+/* Pace transfers from a peripheral's data request line (DREQ_FORCE = none) */
+static inline void channel_config_set_dreq(dma_channel_config *c,
+                                           uint32_t dreq) {
+    channel_config_set_field(c, DMA_CTRL_TREQ_SEL_MASK,
+                             FIELD_PREP(DMA_CTRL_TREQ_SEL, dreq));
+}
+
+/* Start channel chain_to as soon as this one completes. Chaining a channel
+   to itself disables chaining.                                              */
+static inline void channel_config_set_chain_to(dma_channel_config *c,
+                                               uint32_t chain_to) {
+    channel_config_set_field(c, DMA_CTRL_CHAIN_TO_MASK,
+                             FIELD_PREP(DMA_CTRL_CHAIN_TO, chain_to));
+}
+
+/* Wrap the read (or write) address on a 2^size_bits byte boundary; 0 = off */
+static inline void channel_config_set_ring(dma_channel_config *c, int write,
+                                           uint32_t size_bits) {
+    channel_config_set_field(c, DMA_CTRL_RING_SIZE_MASK | DMA_CTRL_RING_SEL,
+                             FIELD_PREP(DMA_CTRL_RING_SIZE, size_bits)
+                                | (write ? DMA_CTRL_RING_SEL : 0));
+}
+
+/* Quiet channels only raise their IRQ when they receive a null trigger —
+   used for the "end of a chain" marker pattern                             */
+static inline void channel_config_set_irq_quiet(dma_channel_config *c,
+                                                int quiet) {
+    channel_config_set_field(c, DMA_CTRL_IRQ_QUIET,
+                             quiet ? DMA_CTRL_IRQ_QUIET : 0);
+}
+
+static inline void channel_config_set_high_priority(dma_channel_config *c,
+                                                    int high) {
+    channel_config_set_field(c, DMA_CTRL_HIGH_PRIORITY,
+                             high ? DMA_CTRL_HIGH_PRIORITY : 0);
+}
+
+static inline void channel_config_set_bswap(dma_channel_config *c, int bswap) {
+    channel_config_set_field(c, DMA_CTRL_BSWAP, bswap ? DMA_CTRL_BSWAP : 0);
+}
+
+static inline void channel_config_set_enable(dma_channel_config *c,
+                                             int enable) {
+    channel_config_set_field(c, DMA_CTRL_EN, enable ? DMA_CTRL_EN : 0);
+}
+
+/* ── Channel ownership ───────────────────────────────────────────────────────
+   Drivers claim channels at init time instead of hardcoding numbers, so two
+   subsystems can never end up programming the same channel.
+   ────────────────────────────────────────────────────────────────────────── */
+
+/* Release the DMA block from reset. Idempotent — every driver that uses DMA
+   may call it.                                                              */
+void dma_init(void);
+
+/* Claim a free channel. Returns the channel number, or -1 if none is free. */
+int  dma_claim_unused_channel(void);
+
+/* Claim a specific channel. Returns 0 on success, -1 if already claimed.   */
+int  dma_channel_claim(uint32_t ch);
+
+void dma_channel_unclaim(uint32_t ch);
+
+/* ── Channel control ─────────────────────────────────────────────────────── */
+
+/* Program all four channel registers. If trigger is nonzero the channel
+   starts immediately; otherwise it waits for dma_channel_start(), a
+   chain trigger or a multi-channel trigger.                                 */
+void dma_channel_configure(uint32_t ch, const dma_channel_config *config,
+                           volatile void *write_addr,
+                           const volatile void *read_addr,
+                           uint32_t transfer_count, int trigger);
+
+static inline void dma_channel_start(uint32_t ch) {
+    DMA_MULTI_CHAN_TRIGGER = 1u << ch;
+}
+
+/* Start several channels in the same cycle                                 */
+static inline void dma_start_channel_mask(uint32_t mask) {
+    DMA_MULTI_CHAN_TRIGGER = mask;
+}
+
+static inline int dma_channel_is_busy(uint32_t ch) {
+    return (DMA_AL1_CTRL(ch) & DMA_CTRL_BUSY) != 0;
+}
+
+static inline void dma_channel_wait_for_finish_blocking(uint32_t ch) {
+    while (dma_channel_is_busy(ch));
+}
+
+/* Re-arm a configured channel with a new write address and start it —
+   the common "next buffer" operation in double-buffered pipelines          */
+static inline void dma_channel_set_write_addr_trigger(uint32_t ch,
+                                                      volatile void *addr) {
+    DMA_AL2_WRITE_ADDR_TRIG(ch) = (uint32_t)addr;
+}
+
+static inline void dma_channel_set_read_addr_trigger(uint32_t ch,
+                                                     const volatile void *addr) {
+    DMA_AL3_READ_ADDR_TRIG(ch) = (uint32_t)addr;
+}
+
+static inline void dma_channel_set_trans_count_trigger(uint32_t ch,
+                                                       uint32_t count) {
+    DMA_AL1_TRANS_COUNT_TRIG(ch) = count;
+}
+
+/* Stop a channel mid-transfer and wait until it has really stopped         */
+void dma_channel_abort(uint32_t ch);
+
+/* ── Interrupts ──────────────────────────────────────────────────────────────
+   Each channel can raise DMA_IRQ_0 or DMA_IRQ_1 on completion. INTS0/1
+   show which channels are pending; writing 1 to a bit acknowledges it.
+   ────────────────────────────────────────────────────────────────────────── */
+static inline void dma_channel_set_irq0_enabled(uint32_t ch, int enabled) {
+    if (enabled) {
+        hw_set_bits(&DMA_INTE0, 1u << ch);
+    } else {
+        hw_clear_bits(&DMA_INTE0, 1u << ch);
+    }
+}
+
+static inline void dma_channel_set_irq1_enabled(uint32_t ch, int enabled) {
+    if (enabled) {
+        hw_set_bits(&DMA_INTE1, 1u << ch);
+    } else {
+        hw_clear_bits(&DMA_INTE1, 1u << ch);
+    }
+}
+
+static inline void dma_channel_acknowledge_irq0(uint32_t ch) {
+    DMA_INTS0 = 1u << ch;
+}
+
+static inline void dma_channel_acknowledge_irq1(uint32_t ch) {
+    DMA_INTS1 = 1u << ch;
+}
+
+#endif
@@ -0,0 +1,207 @@
+#include <stdint.h>
+#include "sections.h"
+#include "dsp.h"
+
+/* acc >> shift, saturated to Q15. Through the two halves, because a 64-bit
+   shift on Thumb-1 is a call to libgcc's __aeabi_lasr in Flash.            */
+union acc64 {
+    int64_t v;
+    struct {
+        uint32_t lo;
+        int32_t hi;
+    } w;
+};
+
+DSP_INLINE q15_t sat64_shr(int64_t acc, uint32_t shift) {
+    const union acc64 a = { .v = acc };
+    if (a.w.hi > 0 || a.w.hi < -1) {
+        return a.w.hi < 0 ? Q15_MIN : Q15_MAX;
+    }
+    return q15_sat((int32_t)(((uint32_t)a.w.hi << (32u - shift))
+                             | (a.w.lo >> shift)));
+}
+
+DSP_INLINE uint32_t low_bits(int64_t acc, uint32_t bits) {
+    const union acc64 a = { .v = acc };
+    return a.w.lo & ((1u << bits) - 1u);
+}
+
+void TIME_CRITICAL q15_from_adc(const uint16_t *in, q15_t *out, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        out[i] = (q15_t)(((int32_t)(in[i] & 0xFFFu) - 2048) * 16);
+    }
+}
+
+/* ── FIR ─────────────────────────────────────────────────────────────────── */
+void q15_fir_init(struct q15_fir *f, const q15_t *coeffs, uint32_t taps,
+                  q15_t *state) {
+    f->coeffs = coeffs;
+    f->state = state;
+    f->taps = taps;
+    f->pos = 0;
+    for (uint32_t i = 0; i < 2u * taps; i++) {
+        state[i] = 0;
+    }
+}
+
+void TIME_CRITICAL q15_fir_process(struct q15_fir *f, const q15_t *in,
+                                   q15_t *out, uint32_t n) {
+    const q15_t *h = f->coeffs;
+    const uint32_t taps = f->taps;
+    uint32_t pos = f->pos;
+
+    for (uint32_t i = 0; i < n; i++) {
+        pos = (pos ? pos : taps) - 1u;
+        f->state[pos] = f->state[pos + taps] = in[i];
+
+        /* s[k] = x[n - k]; four taps per iteration, then the rest          */
+        const q15_t *s = &f->state[pos];
+        int64_t acc = 0x4000;                   /* rounds the >> 15         */
+        uint32_t k = 0;
+        for (; k + 4u <= taps; k += 4u) {
+            acc += (int32_t)h[k]      * s[k];
+            acc += (int32_t)h[k + 1u] * s[k + 1u];
+            acc += (int32_t)h[k + 2u] * s[k + 2u];
+            acc += (int32_t)h[k + 3u] * s[k + 3u];
+        }
+        for (; k < taps; k++) {
+            acc += (int32_t)h[k] * s[k];
+        }
+        out[i] = sat64_shr(acc, 15);
+    }
+    f->pos = pos;
+}
+
+/* ── Biquad IIR ──────────────────────────────────────────────────────────── */
+void q15_biquad_init(struct q15_biquad *s, q15_t b0, q15_t b1, q15_t b2,
+                     q15_t a1, q15_t a2) {
+    s->b0 = b0;
+    s->b1 = b1;
+    s->b2 = b2;
+    s->a1 = a1;
+    s->a2 = a2;
+    s->x1 = s->x2 = s->y1 = s->y2 = 0;
+    s->error = 0;
+}
+
+void TIME_CRITICAL q15_biquad_process(struct q15_biquad *stages,
+                                      uint32_t n_stages, const q15_t *in,
+                                      q15_t *out, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        q15_t x = in[i];
+        for (uint32_t j = 0; j < n_stages; j++) {
+            struct q15_biquad *s = &stages[j];
+
+            /* Q15 samples x Q14 coefficients: Q29 products                 */
+            int64_t acc = s->error;
+            acc += (int32_t)s->b0 * x;
+            acc += (int32_t)s->b1 * s->x1;
+            acc += (int32_t)s->b2 * s->x2;
+            acc -= (int32_t)s->a1 * s->y1;
+            acc -= (int32_t)s->a2 * s->y2;
+
+            const q15_t y = sat64_shr(acc, 14);
+            s->error = (int32_t)low_bits(acc, 14);  /* dropped by the shift */
+            s->x2 = s->x1;
+            s->x1 = x;
+            s->y2 = s->y1;
+            s->y1 = y;
+            x = y;
+        }
+        out[i] = x;
+    }
+}
+
+/* ── Moving average ──────────────────────────────────────────────────────── */
+void q15_moving_avg_init(struct q15_moving_avg *m, q15_t *window,
+                         uint32_t len) {
+    m->window = window;
+    m->len = len;
+    m->pos = 0;
+    m->sum = 0;
+    m->shift = (len & (len - 1u)) ? -1 : __builtin_ctz(len);
+    for (uint32_t i = 0; i < len; i++) {
+        window[i] = 0;
+    }
+}
+
+void TIME_CRITICAL q15_moving_avg_process(struct q15_moving_avg *m,
+                                          const q15_t *in, q15_t *out,
+                                          uint32_t n) {
+    uint32_t pos = m->pos;
+    int32_t sum = m->sum;
+
+    for (uint32_t i = 0; i < n; i++) {
+        sum += in[i] - m->window[pos];
+        m->window[pos] = in[i];
+        if (++pos == m->len) {
+            pos = 0;
+        }
+        out[i] = (q15_t)(m->shift >= 0 ? sum >> m->shift
+                                       : sum / (int32_t)m->len);
+    }
+    m->pos = pos;
+    m->sum = sum;
+}
+
+/* ── Scalar functions ────────────────────────────────────────────────────── */
+uint32_t TIME_CRITICAL dsp_isqrt32(uint32_t x) {
+    uint32_t root = 0;
+    uint32_t bit = 1u << 30;
+
+    while (bit > x) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (x >= root + bit) {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+q15_t TIME_CRITICAL q15_sqrt(q15_t x) {
+    /* sqrt(x / 2^15) * 2^15 = sqrt(x * 2^15)                               */
+    return x > 0 ? (q15_t)dsp_isqrt32((uint32_t)x << 15) : 0;
+}
+
+q15_t TIME_CRITICAL q15_magnitude(q15_t x, q15_t y) {
+    /* Q30 sum of squares, at most 2^31; its root is Q15                    */
+    const uint32_t r = dsp_isqrt32((uint32_t)((int32_t)x * x)
+                                   + (uint32_t)((int32_t)y * y));
+    return r > (uint32_t)Q15_MAX ? Q15_MAX : (q15_t)r;
+}
+
+/* atan(r) / pi for r = 0 .. 1 in Q15:  r / 4 + 0.0869 * r * (1 - r), the
+   usual pi/4 r + 0.273 r (1 - r) scaled by 1/pi (max error 0.0038 rad)     */
+#define ATAN_FIT_Q15            2847
+
+q15_t TIME_CRITICAL q15_atan2(q15_t y, q15_t x) {
+    const uint32_t ax = (uint32_t)(x < 0 ? -(int32_t)x : x);
+    const uint32_t ay = (uint32_t)(y < 0 ? -(int32_t)y : y);
+    const uint32_t lo = ax < ay ? ax : ay;
+    const uint32_t hi = ax < ay ? ay : ax;
+
+    if (!hi) {
+        return 0;
+    }
+    /* Both at most 2^15, so lo << 15 fits and r is 0 .. 32768              */
+    const int32_t r = (int32_t)((lo << 15) / hi);
+    int32_t a = (r >> 2) + ((((r * (32768 - r)) >> 15) * ATAN_FIT_Q15) >> 15);
+
+    if (ay > ax) {
+        a = 16384 - a;                          /* pi/2 - atan(x / y)       */
+    }
+    if (x < 0) {
+        a = 32768 - a;                          /* pi - angle               */
+    }
+    if (y < 0) {
+        a = -a;
+    }
+    /* +pi (32768) wraps to -pi: the same angle                             */
+    return (q15_t)(int16_t)(uint16_t)a;
+}
@@ -0,0 +1,166 @@
+#ifndef DSP_H
+#define DSP_H
+
+#include <stdint.h>
+
+/* ── Fixed-point DSP ─────────────────────────────────────────────────────────
+   We build with -mfloat-abi=soft, so a float multiply-add is a pair of
+   libgcc calls costing ~50-100 cycles each. These kernels work on Q15
+   samples (int16_t, -1.0 .. 1.0 - 2^-15) instead, sized for what the
+   Cortex-M0+ has: a single-cycle 32x32->32 MULS and no wider multiply.
+
+   - A Q15 x Q15 product is Q30 and fits in 32 bits, so every kernel is one
+     MULS per tap. Sums of products are kept in 64 bits: on M0+ that is an
+     ADDS/ADCS pair per term, far cheaper than the __aeabi_lmul a 64-bit
+     product would need, and it cannot overflow for any realistic length.
+   - Q31 x Q31 has a 62-bit product that MULS cannot make. q31_mul() builds
+     the top half from four 16x16 partial products instead of __aeabi_lmul.
+   - Division goes to the SIO hardware divider (src/divider.S), so the few
+     kernels that divide (moving average, atan2) pay ~20 cycles for it.
+
+   Everything here is TIME_CRITICAL or inline: the kernels are meant for
+   on_block() of the ADC stream (src/adc.h), and a DMA interrupt should not
+   wait on XIP cache misses. q15_from_adc() converts a block of raw 12-bit
+   ADC results first.
+
+   Cycle counts for every kernel: make bench, then print dsp_report.
+   ────────────────────────────────────────────────────────────────────────── */
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+
+#define Q15_MAX                 ((q15_t)0x7FFF)
+#define Q15_MIN                 ((q15_t)-0x8000)
+#define Q31_MAX                 ((q31_t)0x7FFFFFFF)
+#define Q31_MIN                 ((q31_t)(-0x7FFFFFFF - 1))
+
+/* Constants from floating literals, folded at compile time (no soft-float
+   call is emitted). Q15(1.0) and Q31(1.0) saturate to the largest value.   */
+#define Q15(x)  ((q15_t)((x) >= 1.0 ? 32767.0 \
+                         : (x) * 32768.0 + ((x) < 0 ? -0.5 : 0.5)))
+#define Q14(x)  ((q15_t)((x) * 16384.0 + ((x) < 0 ? -0.5 : 0.5)))
+#define Q31(x)  ((q31_t)((x) >= 1.0 ? 2147483647.0 \
+                         : (x) * 2147483648.0 + ((x) < 0 ? -0.5 : 0.5)))
+
+/* Always inlined: the kernels below are TIME_CRITICAL, and at -O0 a plain
+   static inline would be a call back out to Flash                          */
+#define DSP_INLINE              static inline __attribute__((always_inline))
+
+DSP_INLINE q15_t q15_sat(int32_t x) {
+    return x > Q15_MAX ? Q15_MAX : x < Q15_MIN ? Q15_MIN : (q15_t)x;
+}
+
+DSP_INLINE q15_t q15_add_sat(q15_t a, q15_t b) {
+    return q15_sat((int32_t)a + b);
+}
+
+/* a * b, rounded; -1.0 * -1.0 saturates to Q15_MAX                         */
+DSP_INLINE q15_t q15_mul(q15_t a, q15_t b) {
+    return q15_sat(((int32_t)a * b + 0x4000) >> 15);
+}
+
+DSP_INLINE q31_t q31_add_sat(q31_t a, q31_t b) {
+    const q31_t s = (q31_t)((uint32_t)a + (uint32_t)b);
+    /* Overflow iff both operands have the same sign and the sum does not  */
+    if (((a ^ s) & (b ^ s)) < 0) {
+        return a < 0 ? Q31_MIN : Q31_MAX;
+    }
+    return s;
+}
+
+/* a * b in Q31, from 16-bit halves with MULS only. Each cross term is
+   truncated on its own, so the result can be up to 2 LSB below the exact
+   product; -1.0 * -1.0 saturates to Q31_MAX.                               */
+DSP_INLINE q31_t q31_mul(q31_t a, q31_t b) {
+    const int32_t ah = a >> 16, bh = b >> 16;
+    const uint32_t al = (uint32_t)a & 0xFFFFu, bl = (uint32_t)b & 0xFFFFu;
+
+    if (a == Q31_MIN && b == Q31_MIN) {
+        return Q31_MAX;
+    }
+    return (q31_t)(((uint32_t)(ah * bh) << 1)
+                   + (uint32_t)((ah * (int32_t)bl) >> 15)
+                   + (uint32_t)(((int32_t)al * bh) >> 15)
+                   + ((al * bl) >> 31));
+}
+
+/* 12-bit unsigned ADC results, mid-scale at 2048, to Q15. The error bit
+   (bit 15 when FCS.ERR is set) is dropped with the rest of the top nibble. */
+void q15_from_adc(const uint16_t *in, q15_t *out, uint32_t n);
+
+/* ── FIR ─────────────────────────────────────────────────────────────────────
+   y[n] = sum h[k] * x[n - k], k = 0 .. taps-1, Q15 coefficients.
+
+   The delay line is stored twice (state holds 2 * taps samples): each new
+   sample goes in at pos and at pos + taps, so the last taps samples are
+   always contiguous from pos and the inner loop runs without wrapping.
+   ────────────────────────────────────────────────────────────────────────── */
+struct q15_fir {
+    const q15_t *coeffs;
+    q15_t *state;                       /* 2 * taps entries                 */
+    uint32_t taps;
+    uint32_t pos;
+};
+
+void q15_fir_init(struct q15_fir *f, const q15_t *coeffs, uint32_t taps,
+                  q15_t *state);
+/* in and out may be the same buffer                                        */
+void q15_fir_process(struct q15_fir *f, const q15_t *in, q15_t *out,
+                     uint32_t n);
+
+/* ── Biquad IIR ──────────────────────────────────────────────────────────────
+   Direct form I, a cascade of second-order sections:
+       y = b0 x + b1 x1 + b2 x2 - a1 y1 - a2 y2
+   Coefficients are Q14 (-2.0 .. 2.0), enough for a1 of any stable section
+   with a0 normalised to 1; design them with a0 = 1 and convert with Q14().
+   DF I keeps the state in the same Q15 as the samples, so there is no
+   internal gain to overflow. The bits each output drops in rounding are
+   added into the next one (first-order error feedback), which keeps the
+   offset and limit cycles of poles close to z = 1 down to an LSB or so.
+   ────────────────────────────────────────────────────────────────────────── */
+struct q15_biquad {
+    q15_t b0, b1, b2, a1, a2;           /* Q14                              */
+    q15_t x1, x2, y1, y2;
+    int32_t error;                      /* rounding residue, fed back       */
+};
+
+/* Zeroes the state                                                         */
+void q15_biquad_init(struct q15_biquad *s, q15_t b0, q15_t b1, q15_t b2,
+                     q15_t a1, q15_t a2);
+/* Runs every sample through stages[0], then stages[1], ... in and out may
+   be the same buffer.                                                      */
+void q15_biquad_process(struct q15_biquad *stages, uint32_t n_stages,
+                        const q15_t *in, q15_t *out, uint32_t n);
+
+/* ── Moving average ──────────────────────────────────────────────────────────
+   Running sum over the last len samples: two adds per sample at any
+   length. A power-of-two len divides with a shift, any other with the
+   hardware divider.
+   ────────────────────────────────────────────────────────────────────────── */
+struct q15_moving_avg {
+    q15_t *window;                      /* len entries                      */
+    uint32_t len;
+    uint32_t pos;
+    int32_t sum;
+    int32_t shift;                      /* log2(len), or -1                 */
+};
+
+void q15_moving_avg_init(struct q15_moving_avg *m, q15_t *window,
+                         uint32_t len);
+void q15_moving_avg_process(struct q15_moving_avg *m, const q15_t *in,
+                            q15_t *out, uint32_t n);
+
+/* ── Scalar functions ────────────────────────────────────────────────────────
+   dsp_isqrt32:  floor(sqrt(x)), one result bit per iteration, no multiply
+   q15_sqrt:     sqrt of a non-negative Q15 value (0 for negative input)
+   q15_atan2:    angle of (x, y) in units of pi: Q15_MIN .. Q15_MAX is
+                 -pi .. pi, so angles wrap like the int16_t they are.
+                 Octant reduction, then a quadratic fit of atan on 0 .. 1,
+                 within 0.25 degrees. (0, 0) gives 0.
+   q15_magnitude: sqrt(x^2 + y^2), saturated to Q15_MAX
+   ────────────────────────────────────────────────────────────────────────── */
+uint32_t dsp_isqrt32(uint32_t x);
+q15_t    q15_sqrt(q15_t x);
+q15_t    q15_atan2(q15_t y, q15_t x);
+q15_t    q15_magnitude(q15_t x, q15_t y);
+
+#endif
@@ -0,0 +1,122 @@
+#include <stdint.h>
+#include "rp2040.h"
+#include "sections.h"
+#include "print.h"
+#include "stack.h"
+#include "timer.h"
+#include "watchdog.h"
+#include "fault.h"
+
+/* Frames outside SRAM (a corrupted PSP) are not read: a fault inside the
+   fault handler would lock the core up before anything was recorded      */
+#define FAULT_SRAM_START        0x20000000u
+#define FAULT_SRAM_END          0x20042000u
+#define FAULT_FRAME_WORDS       8u
+
+NOINIT struct crash_record crash_record;
+
+static uint32_t TIME_CRITICAL record_check(const struct crash_record *r) {
+    const uint32_t *w = (const uint32_t *)r;
+    const uint32_t n = (uint32_t)(&r->check - w);
+    uint32_t check = CRASH_RECORD_MAGIC;
+
+    for (uint32_t i = 0; i < n; i++) {
+        check ^= w[i];
+    }
+    return check;
+}
+
+static int TIME_CRITICAL record_valid(const struct crash_record *r) {
+    return r->magic == CRASH_RECORD_MAGIC && r->check == record_check(r);
+}
+
+/* Only registers and RAM from here to the reset: XIP may be off, the
+   stack may be what overflowed, the other core keeps running until the
+   watchdog takes it down too                                               */
+void TIME_CRITICAL fault_capture(const uint32_t *frame, uint32_t exc_return) {
+    struct crash_record *r = &crash_record;
+
+    __asm volatile ("cpsid i" ::: "memory");
+    /* The frame may lie in a stack guard                                   */
+    MPU_CTRL = 0;
+    __asm volatile ("dsb\n"
+                    "isb" ::: "memory");
+
+    const uint32_t count = record_valid(r) ? r->count + 1u : 1u;
+
+    r->magic = CRASH_RECORD_MAGIC;
+    r->count = count;
+    r->pending = 1;
+    r->core = SIO_CPUID;
+    r->time_us = TIMER_TIMERAWL;
+    r->sp = (uint32_t)frame;
+    r->exc_return = exc_return;
+
+    const uint32_t addr = (uint32_t)frame;
+    if (!(addr & 3u) && addr >= FAULT_SRAM_START
+        && addr + 4u * FAULT_FRAME_WORDS <= FAULT_SRAM_END) {
+        r->r0 = frame[0];
+        r->r1 = frame[1];
+        r->r2 = frame[2];
+        r->r3 = frame[3];
+        r->r12 = frame[4];
+        r->lr = frame[5];
+        r->pc = frame[6];
+        r->xpsr = frame[7];
+    } else {
+        r->r0 = r->r1 = r->r2 = r->r3 = r->r12 = 0;
+        r->lr = r->pc = r->xpsr = 0;
+    }
+    r->check = record_check(r);
+
+    watchdog_reboot_now();
+}
+
+static void print_reg(putc_fn out, const char *name, uint32_t value) {
+    print_str(out, name);
+    print_hex(out, value);
+}
+
+int fault_report(putc_fn out) {
+    struct crash_record *r = &crash_record;
+
+    if (!record_valid(r)) {
+        r->magic = CRASH_RECORD_MAGIC;
+        r->count = 0;
+        r->pending = 0;
+        r->check = record_check(r);
+        return 0;
+    }
+    if (!r->pending) {
+        return 0;
+    }
+
+    print_str(out, "crash #");
+    print_dec(out, r->count);
+    print_str(out, " core=");
+    print_dec(out, r->core);
+    print_str(out, (r->exc_return & 4u) ? " stack=psp" : " stack=msp");
+    print_str(out, " exception=");
+    print_dec(out, r->xpsr & 0x3Fu);
+    print_str(out, " t_us=");
+    print_dec(out, r->time_us);
+    print_str(out, "\r\n");
+
+    print_reg(out, " pc=", r->pc);
+    print_reg(out, " lr=", r->lr);
+    print_reg(out, " xpsr=", r->xpsr);
+    print_reg(out, " sp=", r->sp);
+    print_reg(out, " exc_ret=", r->exc_return);
+    print_str(out, "\r\n");
+
+    print_reg(out, " r0=", r->r0);
+    print_reg(out, " r1=", r->r1);
+    print_reg(out, " r2=", r->r2);
+    print_reg(out, " r3=", r->r3);
+    print_reg(out, " r12=", r->r12);
+    print_str(out, "\r\n");
+
+    r->pending = 0;
+    r->check = record_check(r);
+    return 1;
+}
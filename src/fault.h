@@ -0,0 +1,51 @@
+#ifndef FAULT_H
+#define FAULT_H
+
+#include <stdint.h>
+#include "print.h"
+
+/* ── Crash records ───────────────────────────────────────────────────────────
+   A HardFault no longer hangs the unit. HardFault_Handler (fault_entry.S)
+   copies the frame the hardware stacked (r0-r3, r12, lr, pc, xPSR), the
+   stack pointer it was on and EXC_RETURN into crash_record, a NOINIT
+   variable, then resets the chip through the watchdog. The record survives
+   the reset; fault_report() prints it on the next boot.
+
+   What the fields say:
+   pc        the faulting instruction (or the one after, for a bad return)
+   lr        where the faulting function was called from
+   xpsr      low 6 bits: the exception that was running — 0 in thread mode
+             (main or a task), 16 + n in IRQ n's handler
+   exc_ret   bit 2 set: the fault hit a task (PSP), clear: main or a
+             handler (MSP); bit 3 clear: it happened in a handler
+
+   The Cortex-M0+ has no fault status registers, so the cause must be read
+   from the code at pc: usually a bad pointer, an unaligned access, a
+   store into an MPU stack guard (STACK_GUARD=1) or an invalid EXC_RETURN.
+   ────────────────────────────────────────────────────────────────────────── */
+#define CRASH_RECORD_MAGIC      0xC4A5F417u
+
+struct crash_record {
+    uint32_t magic;
+    uint32_t count;             /* faults since the last power-on           */
+    uint32_t pending;           /* recorded, not yet reported               */
+    uint32_t core;
+    uint32_t time_us;           /* TIMER at the fault                       */
+    uint32_t sp;                /* the stacked frame's address              */
+    uint32_t exc_return;
+    uint32_t r0, r1, r2, r3, r12, lr, pc, xpsr;
+    uint32_t check;             /* xor of the words above with the magic    */
+};
+
+extern struct crash_record crash_record;
+
+/* Called by HardFault_Handler. Records and resets; never returns.         */
+void fault_capture(const uint32_t *frame, uint32_t exc_return)
+    __attribute__((noreturn));
+
+/* Print the record left by a fault before the last reset, if there is one
+   not reported yet, and mark it reported. Returns 1 if it printed. Also
+   validates the record: after a power-on it is garbage and is cleared.    */
+int fault_report(putc_fn out);
+
+#endif
@@ -0,0 +1,204 @@
+#include <stdint.h>
+#include "rp2040.h"
+#include "irq.h"
+#include "multicore.h"
+#include "sections.h"
+#include "flash.h"
+
+/* ── Bootrom flash routines ──────────────────────────────────────────────────
+   The bootrom exports its functions through a table of 16-bit pointers,
+   each keyed by two ASCII characters. The halfword at 0x14 points at the
+   table, the one at 0x18 at the lookup function; both return Thumb
+   addresses ready to call. All of it is in ROM, so it can run with XIP off.
+   ────────────────────────────────────────────────────────────────────────── */
+#define ROM_FUNC_TABLE          (*(const volatile uint16_t *)0x00000014u)
+#define ROM_TABLE_LOOKUP        (*(const volatile uint16_t *)0x00000018u)
+#define ROM_CODE(a, b)          ((uint32_t)(a) | ((uint32_t)(b) << 8))
+
+#define FLASH_XIP_BASE          0x10000000u
+#define FLASH_BLOCK_ERASE_CMD   0xD8u       /* 64 KiB erase, where aligned */
+#define BOOT2_SIZE_WORDS        64u
+
+typedef void *(*rom_table_lookup_fn)(const uint16_t *table, uint32_t code);
+typedef void (*rom_void_fn)(void);
+typedef void (*rom_erase_fn)(uint32_t offset, uint32_t count,
+                             uint32_t block_size, uint8_t block_cmd);
+typedef void (*rom_program_fn)(uint32_t offset, const uint8_t *data,
+                               uint32_t count);
+
+/* From linker.ld: the end of everything stored in Flash                    */
+extern uint8_t _flash_image_end;
+
+/* Everything touched with XIP off must be in RAM: these pointers, boot2's
+   copy and the page being programmed                                       */
+static struct {
+    rom_void_fn    connect_internal_flash;  /* 'IF': QSPI pins to the SSI   */
+    rom_void_fn    exit_xip;                /* 'EX': back to serial mode    */
+    rom_erase_fn   range_erase;             /* 'RE'                         */
+    rom_program_fn range_program;           /* 'RP'                         */
+    rom_void_fn    flush_cache;             /* 'FC': flush, release CS      */
+} rom;
+
+static uint32_t boot2_copy[BOOT2_SIZE_WORDS];
+static uint32_t page_buf[FLASH_PAGE_SIZE / 4u];
+
+enum flash_op {
+    FLASH_OP_ERASE,
+    FLASH_OP_PROGRAM,
+};
+
+enum lockout_state {
+    LOCKOUT_IDLE,
+    LOCKOUT_REQUESTED,                      /* core 0 wants core 1 parked  */
+    LOCKOUT_PARKED,                         /* core 1 is in its RAM loop   */
+};
+
+static volatile uint32_t lockout_victim;
+static volatile uint32_t lockout_state;
+
+void flash_init(void) {
+    const rom_table_lookup_fn lookup =
+        (rom_table_lookup_fn)(uint32_t)ROM_TABLE_LOOKUP;
+    const uint16_t *table = (const uint16_t *)(uint32_t)ROM_FUNC_TABLE;
+
+    rom.connect_internal_flash = (rom_void_fn)lookup(table, ROM_CODE('I', 'F'));
+    rom.exit_xip       = (rom_void_fn)lookup(table, ROM_CODE('E', 'X'));
+    rom.range_erase    = (rom_erase_fn)lookup(table, ROM_CODE('R', 'E'));
+    rom.range_program  = (rom_program_fn)lookup(table, ROM_CODE('R', 'P'));
+    rom.flush_cache    = (rom_void_fn)lookup(table, ROM_CODE('F', 'C'));
+
+    /* boot2 returns to its caller when lr is a real return address, so the
+       copy can be called to put the flash back into continuous-read mode  */
+    const uint32_t *boot2 = (const uint32_t *)FLASH_XIP_BASE;
+    for (uint32_t i = 0; i < BOOT2_SIZE_WORDS; i++) {
+        boot2_copy[i] = boot2[i];
+    }
+}
+
+uint32_t flash_free_offset(void) {
+    const uint32_t end = (uint32_t)&_flash_image_end - FLASH_XIP_BASE;
+    return (end + FLASH_SECTOR_SIZE - 1u) & ~(FLASH_SECTOR_SIZE - 1u);
+}
+
+/* From the last XIP fetch to boot2's return, nothing here may come from
+   Flash: interrupts are masked and core 1 parked by the caller            */
+static void TIME_CRITICAL flash_op_from_ram(enum flash_op op, uint32_t offset,
+                                            const uint8_t *data,
+                                            uint32_t count) {
+    rom.connect_internal_flash();
+    rom.exit_xip();
+    if (op == FLASH_OP_ERASE) {
+        rom.range_erase(offset, count, FLASH_BLOCK_SIZE,
+                        FLASH_BLOCK_ERASE_CMD);
+    } else {
+        rom.range_program(offset, data, count);
+    }
+    rom.flush_cache();
+    ((rom_void_fn)((uint32_t)boot2_copy | 1u))();
+}
+
+/* A thread on core 1 clearing its doorbells can swallow the token before
+   the handler sees it, so keep sending until core 1 reports in            */
+static void lockout_begin(void) {
+    if (!lockout_victim) {
+        return;
+    }
+    lockout_state = LOCKOUT_REQUESTED;
+    __asm volatile ("dmb" ::: "memory");
+
+    for (uint32_t spin = 0; lockout_state != LOCKOUT_PARKED; spin++) {
+        if (!(spin & 0x3FFu) && multicore_fifo_wready()) {
+            SIO_FIFO_WR = FLASH_LOCKOUT_TOKEN;
+            cpu_sev();
+        }
+    }
+}
+
+static void lockout_end(void) {
+    if (!lockout_victim) {
+        return;
+    }
+    __asm volatile ("dmb" ::: "memory");
+    lockout_state = LOCKOUT_IDLE;
+    cpu_sev();
+}
+
+static void flash_op(enum flash_op op, uint32_t offset, const uint8_t *data,
+                     uint32_t count) {
+    const uint32_t saved = save_and_disable_interrupts();
+    lockout_begin();
+    flash_op_from_ram(op, offset, data, count);
+    lockout_end();
+    restore_interrupts(saved);
+}
+
+static int range_ok(uint32_t offset, uint32_t count, uint32_t align) {
+    return rom.range_erase
+        && !(offset & (align - 1u)) && !(count & (align - 1u))
+        && offset >= flash_free_offset()
+        && offset <= FLASH_SIZE_BYTES && count <= FLASH_SIZE_BYTES - offset;
+}
+
+int flash_range_erase(uint32_t offset, uint32_t count) {
+    if (!range_ok(offset, count, FLASH_SECTOR_SIZE)) {
+        return -1;
+    }
+    for (uint32_t done = 0; done < count; done += FLASH_SECTOR_SIZE) {
+        flash_op(FLASH_OP_ERASE, offset + done, 0, FLASH_SECTOR_SIZE);
+    }
+    return 0;
+}
+
+int flash_range_program(uint32_t offset, const void *data, uint32_t count) {
+    if (!range_ok(offset, count, FLASH_PAGE_SIZE)) {
+        return -1;
+    }
+    const uint8_t *src = data;
+    uint8_t *page = (uint8_t *)page_buf;
+
+    /* Through a RAM page: the source may itself be in Flash              */
+    for (uint32_t done = 0; done < count; done += FLASH_PAGE_SIZE) {
+        for (uint32_t i = 0; i < FLASH_PAGE_SIZE; i++) {
+            page[i] = src[done + i];
+        }
+        flash_op(FLASH_OP_PROGRAM, offset + done, page, FLASH_PAGE_SIZE);
+    }
+    return 0;
+}
+
+/* ── Core 1 lockout ──────────────────────────────────────────────────────── */
+
+void flash_lockout_victim_init(void) {
+    multicore_fifo_drain();
+    multicore_fifo_clear_irq();
+    irq_set_enabled(SIO_IRQ_PROC1, 1);
+    lockout_victim = 1;
+}
+
+/* Registers only, no helper calls: at -O0 the multicore.h inlines would be
+   real calls into Flash, fetched while core 0 has XIP switched off        */
+void TIME_CRITICAL SIO_IRQ_PROC1_Handler(void) {
+    uint32_t lockout = 0;
+
+    while (SIO_FIFO_ST & SIO_FIFO_ST_VLD) {
+        if (SIO_FIFO_RD == FLASH_LOCKOUT_TOKEN) {
+            lockout = 1;
+        }
+    }
+    SIO_FIFO_ST = 0xFFu;
+
+    if (!lockout || lockout_state != LOCKOUT_REQUESTED) {
+        return;
+    }
+
+    uint32_t primask;
+    __asm volatile ("mrs %0, primask\n"
+                    "cpsid i" : "=r" (primask) :: "memory");
+    lockout_state = LOCKOUT_PARKED;
+    __asm volatile ("dmb\n"
+                    "sev" ::: "memory");
+    while (lockout_state == LOCKOUT_PARKED) {
+        cpu_wfe();
+    }
+    __asm volatile ("msr primask, %0" :: "r" (primask) : "memory");
+}
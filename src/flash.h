@@ -0,0 +1,110 @@
+#ifndef FLASH_H
+#define FLASH_H
+
+#include <stdint.h>
+#include "rp2040.h"
+
+/* ── Flash geometry ──────────────────────────────────────────────────────────
+   NOR flash: erasing sets a whole 4 KiB sector to 0xFF, programming can
+   only clear bits, one 256-byte page at a time at most. Offsets below are
+   from the start of flash (XIP_BASE), not CPU addresses.
+   ────────────────────────────────────────────────────────────────────────── */
+#define FLASH_PAGE_SIZE         256u
+#define FLASH_SECTOR_SIZE       4096u
+#define FLASH_BLOCK_SIZE        65536u
+#define FLASH_SIZE_BYTES        (2048u * 1024u)     /* FLASH + KV_FLASH     */
+
+/* ── Writing flash while running from it ─────────────────────────────────────
+   While the flash is being erased or programmed it cannot be read, so no
+   code, rodata or vector may be fetched through XIP for the duration. Each
+   operation therefore:
+
+   1. masks interrupts on this core (handlers may live in Flash)
+   2. parks core 1 in a RAM loop, if it registered as a lockout victim
+   3. from RAM: takes the QSPI pins back from XIP, runs the bootrom's
+      erase/program routine, flushes the XIP cache, and calls a RAM copy of
+      boot2 to restore exactly the fast read mode boot2.S set up at boot
+   4. releases core 1 and restores interrupts
+
+   Ranges are split so that only one sector erase (typ. 45 ms, worst case
+   400 ms) or one page program (well under 1 ms) happens per window:
+   interrupts get serviced between sectors and core 1 is released between
+   them, so a long erase never holds either core for its whole length.
+
+   Core 1 is only paused if it asked to be. A real-time core 1 that runs
+   entirely from RAM (TIME_CRITICAL code and data, RAM_VECTOR_TABLE) should
+   not call flash_lockout_victim_init() at all and is never stopped. Bus
+   masters are not covered: no DMA may read flash (e.g. an XIP stream)
+   during an operation.
+
+   Call from core 0 only, after flash_init(). The running image is
+   protected: erase/program below _flash_image_end fails.
+   ────────────────────────────────────────────────────────────────────────── */
+
+/* Look up the bootrom flash routines and copy boot2 out of flash          */
+void flash_init(void);
+
+/* Erase [offset, offset + count), both sector-aligned. 0 or -1.           */
+int flash_range_erase(uint32_t offset, uint32_t count);
+
+/* Program count bytes at offset, both page-aligned, over erased flash.
+   Returns 0 or -1.                                                        */
+int flash_range_program(uint32_t offset, const void *data, uint32_t count);
+
+/* First offset that is not part of the running image                      */
+uint32_t flash_free_offset(void);
+
+/* The flash contents at offset, readable as normal memory                 */
+static inline const void *flash_ptr(uint32_t offset) {
+#if HOST_SIM
+    extern uint8_t host_flash[FLASH_SIZE_BYTES];
+    return host_flash + offset;
+#else
+    return (const void *)(0x10000000u + offset);
+#endif
+}
+
+/* ── Core 1 lockout ──────────────────────────────────────────────────────────
+   Call on core 1 if it ever runs code from Flash. It enables core 1's
+   SIO FIFO interrupt; core 0 sends FLASH_LOCKOUT_TOKEN before each
+   operation and the handler parks core 1 in RAM, interrupts masked, until
+   core 0 is done. Other FIFO words reaching the handler are doorbells
+   (multicore.h) and are simply dropped: the doorbell's sev has already
+   woken whatever waits on the queues, which re-check them anyway.
+   ────────────────────────────────────────────────────────────────────────── */
+#define FLASH_LOCKOUT_TOKEN     0xF1A5C0DEu
+
+void flash_lockout_victim_init(void);
+
+/* ── Batched writer ──────────────────────────────────────────────────────────
+   Collects small writes (log records, config values) into a page buffer
+   and programs whole pages, so each record costs a memcpy rather than a
+   flash operation. flash_writer_flush() programs a partial page padded
+   with 0xFF — bits programmed to 1 stay erased — and keeps the buffer, so
+   later writes can finish the same page with a second program of it.
+
+   The destination must already be erased. A writer can start mid-page,
+   e.g. to carry on appending after a reboot: the bytes before offset are
+   held as 0xFF and so left as they are in flash.
+   ────────────────────────────────────────────────────────────────────────── */
+struct flash_writer {
+    uint32_t offset;                    /* page being filled                */
+    uint32_t fill;                      /* bytes in page[]                  */
+    uint8_t  page[FLASH_PAGE_SIZE];
+};
+
+void flash_writer_init(struct flash_writer *w, uint32_t offset);
+
+/* Append len bytes, programming each page as it fills. 0 or -1.           */
+int  flash_writer_write(struct flash_writer *w, const void *data,
+                        uint32_t len);
+
+/* Program the partial page, if any. 0 or -1.                              */
+int  flash_writer_flush(struct flash_writer *w);
+
+/* Where the next byte will land                                           */
+static inline uint32_t flash_writer_offset(const struct flash_writer *w) {
+    return w->offset + w->fill;
+}
+
+#endif
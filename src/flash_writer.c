@@ -0,0 +1,51 @@
+#include <stdint.h>
+#include "flash.h"
+
+/* ── Batched writer ──────────────────────────────────────────────────────────
+   Only a client of flash_range_program(), kept apart from the bootrom and
+   XIP handling in flash.c so the host build can run it over simulated
+   flash (host/flash_sim.c).
+   ────────────────────────────────────────────────────────────────────────── */
+void flash_writer_init(struct flash_writer *w, uint32_t offset) {
+    w->offset = offset & ~(FLASH_PAGE_SIZE - 1u);
+    w->fill = offset - w->offset;
+    for (uint32_t i = 0; i < w->fill; i++) {
+        w->page[i] = 0xFFu;
+    }
+}
+
+int flash_writer_write(struct flash_writer *w, const void *data,
+                       uint32_t len) {
+    const uint8_t *src = data;
+
+    while (len) {
+        const uint32_t room = FLASH_PAGE_SIZE - w->fill;
+        const uint32_t n = len < room ? len : room;
+
+        for (uint32_t i = 0; i < n; i++) {
+            w->page[w->fill + i] = src[i];
+        }
+        w->fill += n;
+        src += n;
+        len -= n;
+
+        if (w->fill == FLASH_PAGE_SIZE) {
+            if (flash_range_program(w->offset, w->page, FLASH_PAGE_SIZE) < 0) {
+                return -1;
+            }
+            w->offset += FLASH_PAGE_SIZE;
+            w->fill = 0;
+        }
+    }
+    return 0;
+}
+
+int flash_writer_flush(struct flash_writer *w) {
+    if (!w->fill) {
+        return 0;
+    }
+    for (uint32_t i = w->fill; i < FLASH_PAGE_SIZE; i++) {
+        w->page[i] = 0xFFu;
+    }
+    return flash_range_program(w->offset, w->page, FLASH_PAGE_SIZE);
+}
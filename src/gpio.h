@@ -0,0 +1,231 @@
+#ifndef GPIO_H
+#define GPIO_H
+
+#include <stdint.h>
+#include "rp2040.h"
+
+/* ── GPIO ────────────────────────────────────────────────────────────────────
+   Three blocks are involved in every user GPIO (bank 0, pins 0-29):
+
+   PADS_BANK0   the electrical side of each pin: input enable, output
+                disable, pull-up/pull-down, drive strength, slew rate,
+                Schmitt trigger. One register per pin.
+   IO_BANK0     which peripheral drives the pin (FUNCSEL: SPI, UART, PIO,
+                SIO...), plus edge/level interrupts. A STATUS and a CTRL
+                register per pin, 8 bytes apart.
+   SIO          the pins under software control, all 30 in each register:
+                one bit per pin, single-cycle access from either core.
+
+   PADS and IO_BANK0 are APB peripherals with the atomic aliases, so one
+   field in one pin's register changes with a single hw_set_bits() /
+   hw_clear_bits() / hw_write_masked() store (rp2040.h), never a
+   read-modify-write. SIO has no
+   aliases because it does not need them: it has its own SET/CLR/XOR
+   registers instead, and gpio_set_mask/clr_mask/xor_mask are a single
+   store to one (gpio_put_masked one load and one store).
+
+   With a constant mask these inline to a str or two, i.e. a bus can be
+   driven at full SIO speed:
+       gpio_put_masked(0xFFu << 8, byte << 8);     // 8-bit bus on GPIO 8-15
+   ────────────────────────────────────────────────────────────────────────── */
+#define NUM_BANK0_GPIOS         30u
+#define GPIO_ALL_MASK           0x3FFFFFFFu
+
+/* always_inline: the build defaults to -O0, where plain inline functions
+   become calls — and a call out of a TIME_CRITICAL function runs from Flash */
+#define GPIO_INLINE             static inline __attribute__((always_inline))
+
+/* ── PADS_BANK0 ──────────────────────────────────────────────────────────── */
+#define PADS_BANK0_BASE         0x4001C000u
+#define PADS_GPIO(pin)          MMIO32(PADS_BANK0_BASE + 0x004 + 4u * (pin))
+
+#define PADS_SLEWFAST           (1u << 0)
+#define PADS_SCHMITT            (1u << 1)
+#define PADS_PDE                (1u << 2)   /* pull-down enable             */
+#define PADS_PUE                (1u << 3)   /* pull-up enable               */
+#define PADS_DRIVE_LSB          4
+#define PADS_DRIVE_MASK         (3u << PADS_DRIVE_LSB)
+#define PADS_IE                 (1u << 6)   /* input enable                 */
+#define PADS_OD                 (1u << 7)   /* output disable               */
+
+enum gpio_drive_strength {
+    GPIO_DRIVE_2MA  = 0,
+    GPIO_DRIVE_4MA  = 1,                    /* reset value                  */
+    GPIO_DRIVE_8MA  = 2,
+    GPIO_DRIVE_12MA = 3,
+};
+
+/* ── IO_BANK0 ────────────────────────────────────────────────────────────── */
+#define IO_BANK0_BASE           0x40014000u
+#define GPIO_STATUS(pin)        MMIO32(IO_BANK0_BASE + 8u * (pin))
+#define GPIO_CTRL(pin)          MMIO32(IO_BANK0_BASE + 8u * (pin) + 0x4)
+
+enum gpio_function {
+    GPIO_FUNC_XIP  = 0,
+    GPIO_FUNC_SPI  = 1,
+    GPIO_FUNC_UART = 2,
+    GPIO_FUNC_I2C  = 3,
+    GPIO_FUNC_PWM  = 4,
+    GPIO_FUNC_SIO  = 5,     /* plain GPIO under software control            */
+    GPIO_FUNC_PIO0 = 6,
+    GPIO_FUNC_PIO1 = 7,
+    GPIO_FUNC_GPCK = 8,
+    GPIO_FUNC_USB  = 9,
+    GPIO_FUNC_NULL = 0x1F,  /* reset value: pin driven by nothing           */
+};
+
+/* Four interrupt bits per pin, eight pins per register: level low, level
+   high, edge low, edge high. INTR latches edges (write 1 to clear);
+   PROC0_INTE selects which of them reach core 0's IO_IRQ_BANK0.           */
+#define IO_INTR(pin)            MMIO32(IO_BANK0_BASE + 0x0F0 + 4u * ((pin) / 8u))
+#define IO_PROC0_INTE_SET(pin)  MMIO32(IO_BANK0_BASE + 0x100 + 4u * ((pin) / 8u) \
+                                       + REG_ALIAS_SET)
+#define IO_PROC0_INTE_CLR(pin)  MMIO32(IO_BANK0_BASE + 0x100 + 4u * ((pin) / 8u) \
+                                       + REG_ALIAS_CLR)
+#define GPIO_IRQ_LEVEL_LOW(pin)  (1u << (4u * ((pin) % 8u) + 0u))
+#define GPIO_IRQ_LEVEL_HIGH(pin) (1u << (4u * ((pin) % 8u) + 1u))
+#define GPIO_IRQ_EDGE_FALL(pin)  (1u << (4u * ((pin) % 8u) + 2u))
+#define GPIO_IRQ_EDGE_RISE(pin)  (1u << (4u * ((pin) % 8u) + 3u))
+
+/* ── SIO GPIO registers ──────────────────────────────────────────────────── */
+#define SIO_GPIO_IN             MMIO32(SIO_BASE + 0x004)
+#define SIO_GPIO_OUT            MMIO32(SIO_BASE + 0x010)
+#define SIO_GPIO_OUT_SET        MMIO32(SIO_BASE + 0x014)
+#define SIO_GPIO_OUT_CLR        MMIO32(SIO_BASE + 0x018)
+#define SIO_GPIO_OUT_XOR        MMIO32(SIO_BASE + 0x01C)
+#define SIO_GPIO_OE             MMIO32(SIO_BASE + 0x020)
+#define SIO_GPIO_OE_SET         MMIO32(SIO_BASE + 0x024)
+#define SIO_GPIO_OE_CLR         MMIO32(SIO_BASE + 0x028)
+#define SIO_GPIO_OE_XOR         MMIO32(SIO_BASE + 0x02C)
+
+/* ── Pin function and pads ───────────────────────────────────────────────── */
+
+/* Hand the pin to a peripheral, with its input enabled and its output not
+   disabled. Writing CTRL whole also clears the override fields.           */
+GPIO_INLINE void gpio_set_function(uint32_t pin, enum gpio_function fn) {
+    hw_set_bits(&PADS_GPIO(pin), PADS_IE);
+    hw_clear_bits(&PADS_GPIO(pin), PADS_OD);
+    GPIO_CTRL(pin) = (uint32_t)fn;
+}
+
+GPIO_INLINE enum gpio_function gpio_get_function(uint32_t pin) {
+    return (enum gpio_function)(GPIO_CTRL(pin) & 0x1Fu);
+}
+
+GPIO_INLINE void gpio_pull_up(uint32_t pin) {
+    hw_clear_bits(&PADS_GPIO(pin), PADS_PDE);
+    hw_set_bits(&PADS_GPIO(pin), PADS_PUE);
+}
+
+GPIO_INLINE void gpio_pull_down(uint32_t pin) {
+    hw_clear_bits(&PADS_GPIO(pin), PADS_PUE);
+    hw_set_bits(&PADS_GPIO(pin), PADS_PDE);
+}
+
+GPIO_INLINE void gpio_disable_pulls(uint32_t pin) {
+    hw_clear_bits(&PADS_GPIO(pin), PADS_PUE | PADS_PDE);
+}
+
+GPIO_INLINE void gpio_set_input_enabled(uint32_t pin, int enabled) {
+    if (enabled) {
+        hw_set_bits(&PADS_GPIO(pin), PADS_IE);
+    } else {
+        hw_clear_bits(&PADS_GPIO(pin), PADS_IE);
+    }
+}
+
+GPIO_INLINE void gpio_set_drive_strength(uint32_t pin,
+                                         enum gpio_drive_strength drive) {
+    hw_write_masked(&PADS_GPIO(pin), FIELD_PREP(PADS_DRIVE, drive),
+                    PADS_DRIVE_MASK);
+}
+
+GPIO_INLINE void gpio_set_slew_fast(uint32_t pin, int fast) {
+    if (fast) {
+        hw_set_bits(&PADS_GPIO(pin), PADS_SLEWFAST);
+    } else {
+        hw_clear_bits(&PADS_GPIO(pin), PADS_SLEWFAST);
+    }
+}
+
+/* Software-controlled input, output low: the state a pin should be left in
+   before it is made an output                                              */
+GPIO_INLINE void gpio_init(uint32_t pin) {
+    SIO_GPIO_OE_CLR = 1u << pin;
+    SIO_GPIO_OUT_CLR = 1u << pin;
+    gpio_set_function(pin, GPIO_FUNC_SIO);
+}
+
+GPIO_INLINE void gpio_init_mask(uint32_t mask) {
+    SIO_GPIO_OE_CLR = mask;
+    SIO_GPIO_OUT_CLR = mask;
+    for (uint32_t pin = 0; pin < NUM_BANK0_GPIOS; pin++) {
+        if (mask & (1u << pin)) {
+            gpio_set_function(pin, GPIO_FUNC_SIO);
+        }
+    }
+}
+
+/* ── Direction ───────────────────────────────────────────────────────────── */
+GPIO_INLINE void gpio_set_dir_out_masked(uint32_t mask) {
+    SIO_GPIO_OE_SET = mask;
+}
+
+GPIO_INLINE void gpio_set_dir_in_masked(uint32_t mask) {
+    SIO_GPIO_OE_CLR = mask;
+}
+
+/* Pins in mask become outputs where value has a 1, inputs where it has a 0 */
+GPIO_INLINE void gpio_set_dir_masked(uint32_t mask, uint32_t value) {
+    SIO_GPIO_OE_XOR = (SIO_GPIO_OE ^ value) & mask;
+}
+
+GPIO_INLINE void gpio_set_dir(uint32_t pin, int out) {
+    if (out) {
+        SIO_GPIO_OE_SET = 1u << pin;
+    } else {
+        SIO_GPIO_OE_CLR = 1u << pin;
+    }
+}
+
+/* ── Levels ──────────────────────────────────────────────────────────────── */
+GPIO_INLINE void gpio_set_mask(uint32_t mask) {
+    SIO_GPIO_OUT_SET = mask;
+}
+
+GPIO_INLINE void gpio_clr_mask(uint32_t mask) {
+    SIO_GPIO_OUT_CLR = mask;
+}
+
+GPIO_INLINE void gpio_xor_mask(uint32_t mask) {
+    SIO_GPIO_OUT_XOR = mask;
+}
+
+/* Drive the pins in mask to value, leave the others alone: one XOR of the
+   bits that differ. Reads OUT first, so it is atomic against interrupts
+   only if nothing else drives the same pins.                               */
+GPIO_INLINE void gpio_put_masked(uint32_t mask, uint32_t value) {
+    SIO_GPIO_OUT_XOR = (SIO_GPIO_OUT ^ value) & mask;
+}
+
+GPIO_INLINE void gpio_put_all(uint32_t value) {
+    SIO_GPIO_OUT = value;
+}
+
+GPIO_INLINE void gpio_put(uint32_t pin, int value) {
+    if (value) {
+        SIO_GPIO_OUT_SET = 1u << pin;
+    } else {
+        SIO_GPIO_OUT_CLR = 1u << pin;
+    }
+}
+
+GPIO_INLINE uint32_t gpio_get_all(void) {
+    return SIO_GPIO_IN;
+}
+
+GPIO_INLINE int gpio_get(uint32_t pin) {
+    return (SIO_GPIO_IN >> pin) & 1u;
+}
+
+#endif
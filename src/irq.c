@@ -0,0 +1,131 @@
+#include <stdint.h>
+#include "rp2040.h"
+#include "irq.h"
+
+/* ── System Control Block / NVIC ─────────────────────────────────────────────
+   Both live in the Cortex-M0+ Private Peripheral Bus at 0xE000E000 and are
+   private to each core: core 0 and core 1 each have their own VTOR and NVIC
+   at the same addresses.
+
+   VTOR:      base address of the vector table (must be 256-byte aligned on
+              the M0+, since bits 7:0 are not implemented)
+   SHPR2/3:   priorities of SVCall, PendSV and SysTick
+   ISER/ICER: write 1 to enable/disable an interrupt line
+   ISPR/ICPR: write 1 to set/clear an interrupt's pending state
+   IPR0-7:    priorities of IRQ0-31, four 8-bit fields per register.
+              ARMv6-M only supports word access to these, so changing one
+              field is a read-modify-write.
+   ────────────────────────────────────────────────────────────────────────── */
+#define SCB_VTOR            MMIO32(0xE000ED08)
+#define SCB_SHPR2           MMIO32(0xE000ED1C)
+#define SCB_SHPR3           MMIO32(0xE000ED20)
+
+#define NVIC_ISER           MMIO32(0xE000E100)
+#define NVIC_ICER           MMIO32(0xE000E180)
+#define NVIC_ISPR           MMIO32(0xE000E200)
+#define NVIC_ICPR           MMIO32(0xE000E280)
+#define NVIC_IPR(n)         MMIO32(0xE000E400 + 4u * (n))
+
+/* Vector table entry index for an IRQ number                                */
+#define VTABLE_INDEX(irq)   ((uint32_t)((int32_t)(irq) + 16))
+
+extern const uint32_t vector_table[VECTOR_TABLE_ENTRIES];
+
+#if RAM_VECTOR_TABLE
+/* ── RAM vector tables ───────────────────────────────────────────────────────
+   48 entries * 4 bytes = 192 bytes. VTOR needs the table aligned to the
+   next power of two above its size, which is 256, so each core's table is
+   padded to 64 entries to keep the second one aligned as well.
+
+   One table per core: each core has its own VTOR, and a handler installed
+   on one core must not appear on the other.
+   ────────────────────────────────────────────────────────────────────────── */
+#define RAM_VECTOR_TABLE_STRIDE  64u
+
+static uint32_t ram_vector_table[NUM_CORES][RAM_VECTOR_TABLE_STRIDE]
+    __attribute__((aligned(256)));
+#endif
+
+void irq_init_vector_table(void) {
+#if RAM_VECTOR_TABLE
+    uint32_t *table = ram_vector_table[get_core_num()];
+
+    for (uint32_t i = 0; i < VECTOR_TABLE_ENTRIES; i++) {
+        table[i] = vector_table[i];
+    }
+
+    /* The table must be complete in RAM before the CPU can fetch from it  */
+    __asm volatile ("dsb" ::: "memory");
+    SCB_VTOR = (uint32_t)table;
+    __asm volatile ("dsb\n isb" ::: "memory");
+#endif
+}
+
+#if RAM_VECTOR_TABLE
+void irq_set_handler(enum irq_num irq, irq_handler_t fn) {
+    volatile uint32_t *table = (volatile uint32_t *)SCB_VTOR;
+    table[VTABLE_INDEX(irq)] = (uint32_t)fn;
+    __asm volatile ("dsb" ::: "memory");
+}
+#endif
+
+irq_handler_t irq_get_handler(enum irq_num irq) {
+    const volatile uint32_t *table = (const volatile uint32_t *)(uintptr_t)SCB_VTOR;
+    return (irq_handler_t)(uintptr_t)table[VTABLE_INDEX(irq)];
+}
+
+void irq_set_priority(enum irq_num irq, uint8_t priority) {
+    volatile uint32_t *reg;
+    uint32_t shift;
+
+    if (irq >= 0) {
+        reg   = &NVIC_IPR((uint32_t)irq / 4u);
+        shift = 8u * ((uint32_t)irq % 4u);
+    } else if (irq == SVCALL_IRQn) {
+        reg   = &SCB_SHPR2;
+        shift = 24;
+    } else if (irq == PENDSV_IRQn) {
+        reg   = &SCB_SHPR3;
+        shift = 16;
+    } else if (irq == SYSTICK_IRQn) {
+        reg   = &SCB_SHPR3;
+        shift = 24;
+    } else {
+        return;     /* NMI and HardFault have fixed priorities               */
+    }
+
+    /* Word-only access: an interrupt changing a neighbouring field between
+       our read and write would be lost, so do the RMW with IRQs masked     */
+    uint32_t primask = save_and_disable_interrupts();
+    *reg = (*reg & ~(0xFFu << shift)) | ((uint32_t)priority << shift);
+    restore_interrupts(primask);
+}
+
+void irq_set_enabled(enum irq_num irq, int enabled) {
+    if (irq < 0) {
+        return;     /* system exceptions are not gated by the NVIC           */
+    }
+
+    const uint32_t mask = 1u << (uint32_t)irq;
+    if (enabled) {
+        NVIC_ICPR = mask;
+        NVIC_ISER = mask;
+    } else {
+        NVIC_ICER = mask;
+    }
+}
+
+int irq_is_enabled(enum irq_num irq) {
+    if (irq < 0) {
+        return 1;
+    }
+
+    /* Reading ISER returns the enable state of every line                  */
+    return (NVIC_ISER & (1u << (uint32_t)irq)) != 0;
+}
+
+void irq_set_pending(enum irq_num irq) {
+    if (irq >= 0) {
+        NVIC_ISPR = 1u << (uint32_t)irq;
+    }
+}
@@ -0,0 +1,134 @@
+#ifndef IRQ_H
+#define IRQ_H
+
+#include <stdint.h>
+
+/* ── RAM_VECTOR_TABLE ────────────────────────────────────────────────────────
+   1 (default): Reset_Handler copies the vector table from Flash into an
+                aligned SRAM buffer and points VTOR at it. Exception entry
+                then fetches its vector from SRAM instead of through XIP,
+                and irq_set_handler() can swap handlers at runtime.
+   0:           VTOR keeps pointing at the Flash table boot2 installed.
+                Saves 512 bytes of RAM (one table per core); handlers are
+                fixed at link time.
+   ────────────────────────────────────────────────────────────────────────── */
+#ifndef RAM_VECTOR_TABLE
+#define RAM_VECTOR_TABLE    1
+#endif
+
+/* 16 Cortex-M0+ system exception slots followed by 32 NVIC interrupt lines.
+   The RP2040 wires up IRQ0-25; 26-31 exist in the NVIC but have no source. */
+#define VECTOR_TABLE_ENTRIES  48u
+
+/* ── IRQ numbers ─────────────────────────────────────────────────────────────
+   External interrupts are numbered from 0 (vector table entry 16).
+   The system exceptions that can be swapped or prioritised use negative
+   numbers, counting back from entry 16, the same convention CMSIS uses.
+   ────────────────────────────────────────────────────────────────────────── */
+enum irq_num {
+    NMI_IRQn        = -14,
+    HARDFAULT_IRQn  = -13,
+    SVCALL_IRQn     = -5,
+    PENDSV_IRQn     = -2,
+    SYSTICK_IRQn    = -1,
+
+    TIMER_IRQ_0     = 0,
+    TIMER_IRQ_1     = 1,
+    TIMER_IRQ_2     = 2,
+    TIMER_IRQ_3     = 3,
+    PWM_IRQ_WRAP    = 4,
+    USBCTRL_IRQ     = 5,
+    XIP_IRQ         = 6,
+    PIO0_IRQ_0      = 7,
+    PIO0_IRQ_1      = 8,
+    PIO1_IRQ_0      = 9,
+    PIO1_IRQ_1      = 10,
+    DMA_IRQ_0       = 11,
+    DMA_IRQ_1       = 12,
+    IO_IRQ_BANK0    = 13,
+    IO_IRQ_QSPI     = 14,
+    SIO_IRQ_PROC0   = 15,
+    SIO_IRQ_PROC1   = 16,
+    CLOCKS_IRQ      = 17,
+    SPI0_IRQ        = 18,
+    SPI1_IRQ        = 19,
+    UART0_IRQ       = 20,
+    UART1_IRQ       = 21,
+    ADC_IRQ_FIFO    = 22,
+    I2C0_IRQ        = 23,
+    I2C1_IRQ        = 24,
+    RTC_IRQ         = 25,
+};
+
+typedef void (*irq_handler_t)(void);
+
+/* ── Priorities ──────────────────────────────────────────────────────────────
+   Cortex-M0+ implements only the top 2 bits of each 8-bit priority field,
+   so there are four levels: 0x00 (highest), 0x40, 0x80, 0xC0 (lowest).
+   Lower bits are accepted and ignored by the hardware.
+   ────────────────────────────────────────────────────────────────────────── */
+#define IRQ_PRIORITY_HIGHEST  0x00u
+#define IRQ_PRIORITY_DEFAULT  0x80u
+#define IRQ_PRIORITY_LOWEST   0xC0u
+
+/* Copy the Flash vector table into the calling core's SRAM table and point
+   its VTOR at the copy. Called from Reset_Handler after .bss is cleared,
+   and on core 1 by multicore_launch_core1(). No-op if RAM_VECTOR_TABLE
+   is 0.                                                                     */
+void irq_init_vector_table(void);
+
+#if RAM_VECTOR_TABLE
+/* Install fn as the handler for irq in the calling core's vector table.
+   A single aligned word store, so it is atomic with respect to the
+   exception it replaces — safe even while that interrupt is enabled.       */
+void irq_set_handler(enum irq_num irq, irq_handler_t fn);
+#endif
+
+irq_handler_t irq_get_handler(enum irq_num irq);
+
+/* Set the priority of an external interrupt, SVCall, PendSV or SysTick.   */
+void irq_set_priority(enum irq_num irq, uint8_t priority);
+
+/* Enable or disable an external interrupt line in the calling core's NVIC.
+   Any stale pending state is cleared before enabling.                      */
+void irq_set_enabled(enum irq_num irq, int enabled);
+
+/* Nonzero if the line is enabled in the calling core's NVIC               */
+int  irq_is_enabled(enum irq_num irq);
+
+/* Pend an external interrupt from software                                 */
+void irq_set_pending(enum irq_num irq);
+
+/* ── Global interrupt masking ────────────────────────────────────────────────
+   PRIMASK=1 blocks every interrupt except NMI and HardFault. Saving the
+   previous value lets these nest: the inner restore leaves interrupts
+   disabled if the outer caller had them disabled.
+   ────────────────────────────────────────────────────────────────────────── */
+#if HOST_SIM
+/* The host build's PRIMASK is a variable (host/mmio.c), so a test can
+   check that every path left interrupts as it found them                  */
+extern uint32_t host_primask;
+
+static inline uint32_t save_and_disable_interrupts(void) {
+    const uint32_t primask = host_primask;
+    host_primask = 1;
+    return primask;
+}
+
+static inline void restore_interrupts(uint32_t primask) {
+    host_primask = primask;
+}
+#else
+static inline uint32_t save_and_disable_interrupts(void) {
+    uint32_t primask;
+    __asm volatile ("mrs %0, primask\n"
+                    "cpsid i" : "=r" (primask) :: "memory");
+    return primask;
+}
+
+static inline void restore_interrupts(uint32_t primask) {
+    __asm volatile ("msr primask, %0" :: "r" (primask) : "memory");
+}
+#endif
+
+#endif
@@ -0,0 +1,475 @@
+#include <stdint.h>
+#include "flash.h"
+#include "sched.h"
+#include "kv.h"
+
+#define KV_SECTOR_MAGIC         0x3153564Bu     /* "KVS1"                   */
+#define KV_KEY_ERASED           0xFFFFu         /* end of a sector's log    */
+#define KV_LEN_TOMBSTONE        0xFFFEu
+#define KV_NO_SECTOR            0xFFFFFFFFu
+#define KV_RESERVE_SECTORS      1u              /* kept for compaction      */
+
+#define FNV_OFFSET_BASIS        2166136261u
+#define FNV_PRIME               16777619u
+
+struct kv_sector_header {
+    uint32_t magic;
+    uint32_t seq;                       /* higher is newer                  */
+};
+
+/* Followed by the value, padded with 0xFF to a whole word                 */
+struct kv_record {
+    uint16_t key;
+    uint16_t len;                       /* or KV_LEN_TOMBSTONE              */
+    uint32_t check;
+};
+
+#define KV_HEADER_SIZE          ((uint32_t)sizeof(struct kv_sector_header))
+#define KV_RECORD_SIZE          ((uint32_t)sizeof(struct kv_record))
+
+_Static_assert(KV_MAX_KEYS < KV_KEY_ERASED, "KV_MAX_KEYS too large");
+_Static_assert(KV_MAX_VALUE < KV_LEN_TOMBSTONE
+               && KV_HEADER_SIZE + KV_RECORD_SIZE + KV_MAX_VALUE
+                  <= FLASH_SECTOR_SIZE,
+               "KV_MAX_VALUE must fit in one sector");
+_Static_assert(KV_SECTOR_COUNT <= 32u && KV_SECTOR_COUNT > KV_RESERVE_SECTORS,
+               "KV_SECTOR_COUNT out of range");
+
+/* From linker.ld                                                           */
+extern uint8_t _kv_flash_start;
+extern uint8_t _kv_flash_end;
+
+static struct {
+    uint32_t base;                          /* flash offset of sector 0     */
+    uint32_t head;                          /* sector being appended to     */
+    uint32_t next_seq;
+    uint32_t used_mask;                     /* sectors holding a log        */
+    uint32_t seq[KV_SECTOR_COUNT];
+    uint16_t end[KV_SECTOR_COUNT];          /* bytes written, header incl.  */
+    uint16_t live[KV_SECTOR_COUNT];         /* bytes of current records     */
+    uint32_t erases;
+    uint32_t compactions;
+    struct flash_writer writer;             /* positioned at the head       */
+} kv = { .head = KV_NO_SECTOR };
+
+/* Held by every public call after kv_init(): compaction from the kv task
+   must not interleave with a kv_set() from another                         */
+static struct task_mutex kv_lock;
+
+/* Flash offset of each key's current record, 0 if it has none             */
+static uint32_t index_loc[KV_MAX_KEYS];
+
+static uint32_t sector_offset(uint32_t s) {
+    return kv.base + s * FLASH_SECTOR_SIZE;
+}
+
+static uint32_t sector_of(uint32_t offset) {
+    return (offset - kv.base) / FLASH_SECTOR_SIZE;
+}
+
+static const struct kv_record *record_at(uint32_t offset) {
+    return (const struct kv_record *)flash_ptr(offset);
+}
+
+static uint32_t record_size(uint32_t len) {
+    return KV_RECORD_SIZE
+         + (len == KV_LEN_TOMBSTONE ? 0u : (len + 3u) & ~3u);
+}
+
+static uint32_t record_check(uint32_t key, uint32_t len, const void *value) {
+    const uint8_t *p = value;
+    uint32_t h = FNV_OFFSET_BASIS;
+
+    h = (h ^ (key & 0xFFu)) * FNV_PRIME;
+    h = (h ^ (key >> 8)) * FNV_PRIME;
+    h = (h ^ (len & 0xFFu)) * FNV_PRIME;
+    h = (h ^ (len >> 8)) * FNV_PRIME;
+    if (len != KV_LEN_TOMBSTONE) {
+        for (uint32_t i = 0; i < len; i++) {
+            h = (h ^ p[i]) * FNV_PRIME;
+        }
+    }
+    return h;
+}
+
+static uint32_t free_sectors(void) {
+    uint32_t n = 0;
+    for (uint32_t s = 0; s < KV_SECTOR_COUNT; s++) {
+        n += !(kv.used_mask & (1u << s));
+    }
+    return n;
+}
+
+/* Point key at the record at offset (or clear it for a tombstone), moving
+   the record's bytes into its sector's live count                          */
+static void index_apply(uint32_t offset) {
+    const struct kv_record *r = record_at(offset);
+    const uint32_t old = index_loc[r->key];
+
+    if (old) {
+        kv.live[sector_of(old)] -= (uint16_t)record_size(record_at(old)->len);
+    }
+    if (r->len == KV_LEN_TOMBSTONE) {
+        index_loc[r->key] = 0;
+    } else {
+        index_loc[r->key] = offset;
+        kv.live[sector_of(offset)] += (uint16_t)record_size(r->len);
+    }
+}
+
+static int record_valid(const struct kv_record *r, uint32_t room) {
+    if (r->key >= KV_MAX_KEYS
+        || (r->len > KV_MAX_VALUE && r->len != KV_LEN_TOMBSTONE)
+        || record_size(r->len) > room) {
+        return 0;
+    }
+    return r->check == record_check(r->key, r->len, r + 1);
+}
+
+/* Replay one sector into the index; returns where its log ends. A record
+   that does not check out closes the sector: whatever follows it is not
+   trustworthy, and the bits it programmed cannot be written over.          */
+static uint32_t scan_sector(uint32_t s) {
+    const uint32_t base = sector_offset(s);
+    uint32_t pos = KV_HEADER_SIZE;
+
+    while (pos + KV_RECORD_SIZE <= FLASH_SECTOR_SIZE) {
+        const struct kv_record *r = record_at(base + pos);
+        if (r->key == KV_KEY_ERASED && r->len == 0xFFFFu
+            && r->check == 0xFFFFFFFFu) {
+            return pos;
+        }
+        if (!record_valid(r, FLASH_SECTOR_SIZE - pos)) {
+            return FLASH_SECTOR_SIZE;
+        }
+        index_apply(base + pos);
+        pos += record_size(r->len);
+    }
+    return pos;
+}
+
+static int sector_blank(uint32_t s) {
+    const uint32_t *p = flash_ptr(sector_offset(s));
+    for (uint32_t i = 0; i < FLASH_SECTOR_SIZE / 4u; i++) {
+        if (p[i] != 0xFFFFFFFFu) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Start appending to the first erased sector after the head — normally
+   the very next one, the log being a ring. Erases it first unless it
+   already is (a sector whose erase was cut short has no valid header).    */
+static int open_head(void) {
+    uint32_t next = kv.head == KV_NO_SECTOR ? 0u : kv.head + 1u;
+    uint32_t tries = 0;
+
+    next %= KV_SECTOR_COUNT;
+    while (kv.used_mask & (1u << next)) {
+        if (++tries == KV_SECTOR_COUNT) {
+            return -1;
+        }
+        next = (next + 1u) % KV_SECTOR_COUNT;
+    }
+    if (!sector_blank(next)) {
+        if (flash_range_erase(sector_offset(next), FLASH_SECTOR_SIZE) < 0) {
+            return -1;
+        }
+        kv.erases++;
+    }
+
+    const struct kv_sector_header h = {
+        .magic = KV_SECTOR_MAGIC,
+        .seq = kv.next_seq++,
+    };
+    flash_writer_init(&kv.writer, sector_offset(next));
+    if (flash_writer_write(&kv.writer, &h, sizeof(h)) < 0
+        || flash_writer_flush(&kv.writer) < 0) {
+        return -1;
+    }
+
+    kv.used_mask |= 1u << next;
+    kv.seq[next] = h.seq;
+    kv.end[next] = (uint16_t)KV_HEADER_SIZE;
+    kv.live[next] = 0;
+    kv.head = next;
+    return 0;
+}
+
+/* Append a record at the head, opening a new head sector if it does not
+   fit. value may point into flash (compaction copies that way).           */
+static int append(uint32_t key, const void *value, uint32_t len) {
+    static const uint8_t pad[3] = { 0xFFu, 0xFFu, 0xFFu };
+    const uint32_t size = record_size(len);
+
+    if (kv.head == KV_NO_SECTOR
+        || kv.end[kv.head] + size > FLASH_SECTOR_SIZE) {
+        if (open_head() < 0) {
+            return -1;
+        }
+    }
+
+    const struct kv_record r = {
+        .key = (uint16_t)key,
+        .len = (uint16_t)len,
+        .check = record_check(key, len, value),
+    };
+    const uint32_t offset = flash_writer_offset(&kv.writer);
+
+    if (flash_writer_write(&kv.writer, &r, sizeof(r)) < 0) {
+        return -1;
+    }
+    if (len != KV_LEN_TOMBSTONE
+        && (flash_writer_write(&kv.writer, value, len) < 0
+            || flash_writer_write(&kv.writer, pad,
+                                  size - KV_RECORD_SIZE - len) < 0)) {
+        return -1;
+    }
+    if (flash_writer_flush(&kv.writer) < 0) {
+        return -1;
+    }
+
+    kv.end[kv.head] += (uint16_t)size;
+    index_apply(offset);
+    return 0;
+}
+
+static uint32_t oldest_sector(void) {
+    uint32_t oldest = KV_NO_SECTOR;
+    for (uint32_t s = 0; s < KV_SECTOR_COUNT; s++) {
+        if ((kv.used_mask & (1u << s)) && s != kv.head
+            && (oldest == KV_NO_SECTOR || kv.seq[s] < kv.seq[oldest])) {
+            oldest = s;
+        }
+    }
+    return oldest;
+}
+
+/* Superseded records and tombstones, in every sector holding a log       */
+static uint32_t stale_bytes(void) {
+    uint32_t n = 0;
+    for (uint32_t s = 0; s < KV_SECTOR_COUNT; s++) {
+        if (kv.used_mask & (1u << s)) {
+            n += kv.end[s] - KV_HEADER_SIZE - kv.live[s];
+        }
+    }
+    return n;
+}
+
+/* Move the oldest sector's current records to the head and erase it. It
+   is the oldest, so its tombstones have nothing left to hide and go too.
+
+   An oldest sector that is all live gains nothing by itself, but the
+   compactions that would are stuck behind it, so it is moved anyway once
+   the log holds a sector's worth of stale bytes — fewer, and the store is
+   as good as full, and moving it again and again would only wear flash.
+   1 done, 0 nothing to compact, -1 nothing to gain or a flash error.      */
+static int compact_one(void) {
+    const uint32_t victim = oldest_sector();
+    if (victim == KV_NO_SECTOR) {
+        return 0;
+    }
+    if (kv.live[victim] + KV_HEADER_SIZE >= kv.end[victim]
+        && stale_bytes() < FLASH_SECTOR_SIZE) {
+        return -1;
+    }
+
+    /* A sector closed by a torn record ends at FLASH_SECTOR_SIZE, with
+       the torn bytes and whatever follows them in between: stop at the
+       first record that fails the check, as scan_sector() did            */
+    const uint32_t base = sector_offset(victim);
+    for (uint32_t pos = KV_HEADER_SIZE; pos < kv.end[victim]; ) {
+        const struct kv_record *r = record_at(base + pos);
+        if (!record_valid(r, kv.end[victim] - pos)) {
+            break;
+        }
+        if (r->len != KV_LEN_TOMBSTONE && index_loc[r->key] == base + pos
+            && append(r->key, r + 1, r->len) < 0) {
+            return -1;
+        }
+        pos += record_size(r->len);
+    }
+
+    if (flash_range_erase(base, FLASH_SECTOR_SIZE) < 0) {
+        return -1;
+    }
+    kv.used_mask &= ~(1u << victim);
+    kv.end[victim] = 0;
+    kv.live[victim] = 0;
+    kv.erases++;
+    kv.compactions++;
+    return 1;
+}
+
+/* Before a record that will not fit in the head: opening a new head must
+   still leave the reserve sector erased                                    */
+static int make_room(uint32_t size) {
+    if (kv.head != KV_NO_SECTOR
+        && kv.end[kv.head] + size <= FLASH_SECTOR_SIZE) {
+        return 0;
+    }
+    for (uint32_t tries = 0; free_sectors() <= KV_RESERVE_SECTORS; tries++) {
+        if (tries == KV_SECTOR_COUNT || compact_one() <= 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int kv_init(void) {
+    const uintptr_t start = (uintptr_t)&_kv_flash_start;
+    if ((uintptr_t)&_kv_flash_end - start
+        != KV_SECTOR_COUNT * FLASH_SECTOR_SIZE) {
+        return -1;
+    }
+    kv.base = (uint32_t)(start - (uintptr_t)flash_ptr(0));
+    kv.head = KV_NO_SECTOR;
+    kv.next_seq = 0;
+    kv.used_mask = 0;
+    for (uint32_t k = 0; k < KV_MAX_KEYS; k++) {
+        index_loc[k] = 0;
+    }
+
+    for (uint32_t s = 0; s < KV_SECTOR_COUNT; s++) {
+        const struct kv_sector_header *h = flash_ptr(sector_offset(s));
+        kv.end[s] = 0;
+        kv.live[s] = 0;
+        if (h->magic == KV_SECTOR_MAGIC) {
+            kv.used_mask |= 1u << s;
+            kv.seq[s] = h->seq;
+            if (h->seq >= kv.next_seq) {
+                kv.next_seq = h->seq + 1u;
+            }
+        }
+    }
+
+    /* Oldest first, so later records override earlier ones                */
+    uint32_t pending = kv.used_mask;
+    while (pending) {
+        uint32_t next = KV_NO_SECTOR;
+        for (uint32_t s = 0; s < KV_SECTOR_COUNT; s++) {
+            if ((pending & (1u << s))
+                && (next == KV_NO_SECTOR || kv.seq[s] < kv.seq[next])) {
+                next = s;
+            }
+        }
+        pending &= ~(1u << next);
+        kv.end[next] = (uint16_t)scan_sector(next);
+        kv.head = next;
+    }
+
+    if (kv.head != KV_NO_SECTOR) {
+        flash_writer_init(&kv.writer,
+                          sector_offset(kv.head) + kv.end[kv.head]);
+    }
+    return 0;
+}
+
+const void *kv_get_ptr(uint16_t key, uint32_t *len) {
+    if (key >= KV_MAX_KEYS || !index_loc[key]) {
+        return 0;
+    }
+    const struct kv_record *r = record_at(index_loc[key]);
+    *len = r->len;
+    return r + 1;
+}
+
+int kv_get(uint16_t key, void *buf, uint32_t size) {
+    task_mutex_lock(&kv_lock);
+
+    uint32_t len;
+    const uint8_t *value = kv_get_ptr(key, &len);
+    uint8_t *dst = buf;
+    int rc = -1;
+
+    if (value) {
+        for (uint32_t i = 0; i < len && i < size; i++) {
+            dst[i] = value[i];
+        }
+        rc = (int)len;
+    }
+
+    task_mutex_unlock(&kv_lock);
+    return rc;
+}
+
+static int set_value(uint16_t key, const void *value, uint32_t len) {
+    uint32_t old_len;
+    const uint8_t *old = kv_get_ptr(key, &old_len);
+    if (old && old_len == len) {
+        const uint8_t *src = value;
+        uint32_t i = 0;
+        while (i < len && old[i] == src[i]) {
+            i++;
+        }
+        if (i == len) {
+            return 0;
+        }
+    }
+
+    if (make_room(record_size(len)) < 0) {
+        return -1;
+    }
+    return append(key, value, len);
+}
+
+int kv_set(uint16_t key, const void *value, uint32_t len) {
+    if (key >= KV_MAX_KEYS || len > KV_MAX_VALUE) {
+        return -1;
+    }
+
+    task_mutex_lock(&kv_lock);
+    const int rc = set_value(key, value, len);
+    task_mutex_unlock(&kv_lock);
+    return rc;
+}
+
+static int delete_key(uint16_t key) {
+    if (!index_loc[key]) {
+        return 0;
+    }
+    if (make_room(record_size(KV_LEN_TOMBSTONE)) < 0) {
+        return -1;
+    }
+    return append(key, 0, KV_LEN_TOMBSTONE);
+}
+
+int kv_delete(uint16_t key) {
+    if (key >= KV_MAX_KEYS) {
+        return -1;
+    }
+
+    task_mutex_lock(&kv_lock);
+    const int rc = delete_key(key);
+    task_mutex_unlock(&kv_lock);
+    return rc;
+}
+
+int kv_maintain(void) {
+    task_mutex_lock(&kv_lock);
+    const int rc = free_sectors() >= KV_COMPACT_FREE_SECTORS
+                 ? 0 : compact_one();
+    task_mutex_unlock(&kv_lock);
+    return rc;
+}
+
+void kv_get_stats(struct kv_stats *stats) {
+    task_mutex_lock(&kv_lock);
+
+    stats->keys = 0;
+    for (uint32_t k = 0; k < KV_MAX_KEYS; k++) {
+        stats->keys += index_loc[k] != 0;
+    }
+    stats->live_bytes = 0;
+    stats->used_bytes = 0;
+    for (uint32_t s = 0; s < KV_SECTOR_COUNT; s++) {
+        stats->live_bytes += kv.live[s];
+        stats->used_bytes += kv.end[s];
+    }
+    stats->free_sectors = free_sectors();
+    stats->erases = kv.erases;
+    stats->compactions = kv.compactions;
+
+    task_mutex_unlock(&kv_lock);
+}
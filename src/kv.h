@@ -0,0 +1,88 @@
+#ifndef KV_H
+#define KV_H
+
+#include <stdint.h>
+
+/* ── Key/value store ─────────────────────────────────────────────────────────
+   Persistent parameters in the KV_FLASH region linker.ld reserves at the
+   end of flash (KV_SECTOR_COUNT sectors).
+
+   The store is a log: setting a key appends a record, deleting one appends
+   a tombstone, nothing is ever rewritten in place. Each sector starts with
+   a header carrying a sequence number, so kv_init() can replay the sectors
+   oldest first and end up with the latest record of every key in a RAM
+   index — one flash offset per key, so kv_get() is an array lookup.
+
+   Space held by superseded records comes back through compaction: the
+   oldest sector's live records are copied to the head of the log and the
+   sector is erased. The log moves through the region as a ring, so every
+   sector is erased equally often — an oldest sector that is all live
+   data is moved along with the rest rather than left to block the ring.
+   One sector is always kept erased so a compaction has somewhere to copy
+   to.
+
+   Compaction is incremental: kv_maintain() handles at most one sector per
+   call, and should be called when there is nothing better to do — main.c
+   runs it from a low-priority task. kv_set() only compacts on its own
+   when the store would otherwise run out of erased sectors.
+
+   A record is a key, a length and an FNV-1a check over both and the value.
+   A record cut short by a reset fails the check; replay stops there, the
+   sector takes no more writes, and compacting it moves only the records
+   before the torn one.
+
+   Every call but kv_init() and kv_get_ptr() holds a task mutex, so any
+   number of tasks can use the store. Tasks on core 0 only (see flash.h),
+   never from an interrupt handler; kv_init() before sched_start().
+   ────────────────────────────────────────────────────────────────────────── */
+#define KV_SECTOR_COUNT         16u     /* must match KV_FLASH in linker.ld */
+
+#ifndef KV_MAX_KEYS
+#define KV_MAX_KEYS             64u     /* keys are 0 .. KV_MAX_KEYS - 1    */
+#endif
+
+#ifndef KV_MAX_VALUE
+#define KV_MAX_VALUE            256u    /* bytes                            */
+#endif
+
+/* kv_maintain() compacts while fewer sectors than this are erased         */
+#ifndef KV_COMPACT_FREE_SECTORS
+#define KV_COMPACT_FREE_SECTORS 4u
+#endif
+
+struct kv_stats {
+    uint32_t keys;                      /* keys with a value                */
+    uint32_t live_bytes;                /* records still current            */
+    uint32_t used_bytes;                /* everything written, incl. stale  */
+    uint32_t free_sectors;
+    uint32_t erases;                    /* since kv_init()                  */
+    uint32_t compactions;
+};
+
+/* Build the index from flash. Call once, after flash_init(). 0 or -1.     */
+int kv_init(void);
+
+/* Copy up to size bytes of key's value into buf. Returns the value's full
+   length, or -1 if the key has no value.                                  */
+int kv_get(uint16_t key, void *buf, uint32_t size);
+
+/* The value in place, without a copy. Valid until the next kv_set(),
+   kv_delete() or kv_maintain() from any task, any of which may erase its
+   sector — with compaction running in the background, prefer kv_get().   */
+const void *kv_get_ptr(uint16_t key, uint32_t *len);
+
+/* Store a value. Writing what is already stored costs nothing. 0 or -1
+   (bad key or length, or the live data no longer fits).                   */
+int kv_set(uint16_t key, const void *value, uint32_t len);
+
+/* Remove key. 0 or -1.                                                    */
+int kv_delete(uint16_t key);
+
+/* Compact one sector if the store is running low on erased ones. Returns
+   1 if it did, 0 if there was nothing to do, -1 if the store is full of
+   live data.                                                               */
+int kv_maintain(void);
+
+void kv_get_stats(struct kv_stats *stats);
+
+#endif
@@ -1,122 +1,106 @@
 #include <stdint.h>
-
-/* ── Why volatile on every hardware register ──────────────────────────────────
-   The compiler optimises C code by caching values in registers and reordering
-   reads and writes. That is fine for normal variables.
-   
-   But hardware registers are different — reading or writing them triggers
-   physical side effects the compiler cannot see. A write to GPIO_OUT_XOR
-   toggles a real pin. A read of RESETS_RESET_DONE checks real hardware state.
-   
-   Without volatile the compiler might:
-   - Skip a write because "nobody reads that variable"
-   - Hoist a read out of a loop because "the value never changes in C"
-   - Reorder writes because "order doesn't matter for unrelated variables"
-   
-   volatile forces the compiler to emit every read and write exactly where
-   you wrote it, in order, with no caching. Non-negotiable for MMIO.
-   ────────────────────────────────────────────────────────────────────────── */
-#define MMIO32(addr)   (*((volatile uint32_t*)(addr)))
-
-/* ── RESETS ──────────────────────────────────────────────────────────────────
-   On the RP2040, every peripheral starts held in reset after power-on.
-   You must explicitly release a peripheral from reset before using it.
-   
-   The RP2040 has a clever feature: every register has three extra aliases
-   at +0x1000 (XOR), +0x2000 (atomic SET), +0x3000 (atomic CLR).
-   Writing to the CLR alias clears only the bits you specify — no
-   read-modify-write needed, which avoids race conditions with interrupts.
-   ────────────────────────────────────────────────────────────────────────── */
-#define RESETS_BASE         0x4000C000u
-#define RESETS_RESET        MMIO32(RESETS_BASE + 0x000)  /* reset control    */
-#define RESETS_RESET_CLR    MMIO32(RESETS_BASE + 0x3000) /* atomic clear     */
-#define RESETS_RESET_DONE   MMIO32(RESETS_BASE + 0x008)  /* reset status     */
-
-#define RESET_IO_BANK0      (1u << 5)
-#define RESET_PADS_BANK0    (1u << 8)
-
-/* ── PADS_BANK0 ──────────────────────────────────────────────────────────────
-   Controls the electrical properties of each GPIO pin:
-   drive strength, pull-up/pull-down, slew rate, input enable.
-   We need to unreset this block before configuring any GPIO.
-   ────────────────────────────────────────────────────────────────────────── */
-#define PADS_BANK0_BASE     0x4001C000u
-#define PADS_GPIO25         MMIO32(PADS_BANK0_BASE + 0x068)
-
-/* ── IO_BANK0 ────────────────────────────────────────────────────────────────
-   Controls which function each GPIO pin serves.
-   Every GPIO can be SPI, UART, I2C, PWM, or plain GPIO (SIO) among others.
-   We configure GPIO 25 to function 5 = SIO (plain GPIO under software control).
-   
-   Each GPIO has two registers: STATUS (read-only) and CTRL (read-write).
-   They are 8 bytes apart: GPIO_N_CTRL = IO_BANK0_BASE + N*8 + 4
-   GPIO 25 CTRL = 0x40014000 + 25*8 + 4 = 0x400140CC
+#include "rp2040.h"
+#include "boot_profile.h"
+#include "multicore.h"
+#include "swtimer.h"
+#include "sched.h"
+#include "profile.h"
+#include "uart.h"
+#include "flash.h"
+#include "kv.h"
+#include "pool.h"
+#include "fault.h"
+#include "watchdog.h"
+#include "gpio.h"
+
+/* ── GPIO ────────────────────────────────────────────────────────────────────
+   Pins are configured through gpio.h: PADS_BANK0 sets a pin's electrical
+   properties, IO_BANK0 picks the function driving it (SIO = plain GPIO
+   under software control), and the SIO block then sets, clears or toggles
+   any group of pins with a single store.
    ────────────────────────────────────────────────────────────────────────── */
-#define IO_BANK0_BASE       0x40014000u
-#define GPIO25_CTRL         MMIO32(IO_BANK0_BASE + 0x0CC)
-
-#define FUNCSEL_SIO         5u    /* GPIO controlled by software via SIO     */
-
-/* ── SIO (Single-cycle I/O) ──────────────────────────────────────────────────
-   The SIO block gives you direct, single-cycle control over GPIO pins.
-   Unlike most peripherals it is not in the APB peripheral region —
-   it lives at 0xD0000000, directly accessible to each core with no bus
-   contention. It is the fastest way to toggle a pin.
-   
-   OUT_XOR is particularly elegant: writing a bitmask XORs those bits with
-   the current output level. Writing (1 << 25) toggles GPIO 25 every time.
-   ────────────────────────────────────────────────────────────────────────── */
-#define SIO_BASE            0xD0000000u
-#define GPIO_OUT_XOR        MMIO32(SIO_BASE + 0x01C)   /* toggle pins        */
-#define GPIO_OE_SET         MMIO32(SIO_BASE + 0x024)   /* set as output      */
-
-/* ── SysTick ─────────────────────────────────────────────────────────────────
-   SysTick is a 24-bit countdown timer built into every Cortex-M core.
-   It is identical on every Cortex-M chip — learning it here transfers
-   directly to STM32, NXP, Nordic, and every other Cortex-M product.
-   
-   RVR: Reload Value Register — when counter hits 0, it reloads this value
-   CVR: Current Value Register — writing any value resets the counter
-   CSR: Control and Status Register
-        bit 0 (ENABLE)    — start/stop the timer
-        bit 1 (TICKINT)   — fire SysTick_Handler when counter hits 0
-        bit 2 (CLKSOURCE) — 1 = use processor clock, 0 = external ref clock
-   ────────────────────────────────────────────────────────────────────────── */
-#define SYST_CSR            MMIO32(0xE000E010)
-#define SYST_RVR            MMIO32(0xE000E014)
-#define SYST_CVR            MMIO32(0xE000E018)
 
 /* ── LED ─────────────────────────────────────────────────────────────────── */
 #define LED_PIN             25u
 #define LED_MASK            (1u << LED_PIN)
 
-/* ── Shared state between ISR and main ───────────────────────────────────────
-   volatile is required here for the same reason as MMIO:
-   the compiler cannot see that SysTick_Handler modifies this variable
-   asynchronously. Without volatile it may cache tick_count in a register
-   inside main()'s loop and never see the ISR's updates.
+/* ── Console ─────────────────────────────────────────────────────────────────
+   UART0 on GPIO 0 (TX) / GPIO 1 (RX), the Pico's default debug UART pins.
+   Output is buffered and sent by DMA, so printing costs a memcpy.
    ────────────────────────────────────────────────────────────────────────── */
-static volatile uint32_t tick_count = 0;
-
-/* ── SysTick_Handler ─────────────────────────────────────────────────────────
-   This is a plain C function. Its name matches the weak alias in vectors.c
-   so the linker automatically places its address in the vector table at
-   entry 15 (VTOR + 0x3C).
-   
-   When SysTick counts to zero, the CPU saves 8 registers, reads VTOR+0x3C,
-   and jumps here. No special syntax required — the vector table wiring we
-   built earlier handles everything.
+#define CONSOLE_UART        0u
+#define CONSOLE_BAUD        115200u
+#define CONSOLE_TX_PIN      0u
+#define CONSOLE_RX_PIN      1u
+
+/* ── Blink task ──────────────────────────────────────────────────────────────
+   The LED toggles from a task instead of from an interrupt handler. It
+   sleeps on a software timer between toggles (task_sleep_us), so the CPU
+   is interrupted twice a second instead of a thousand times, and the
+   scheduler's idle task keeps it in wfi the rest of the time.
+
+   Every task has its own statically allocated stack. 128 words is plenty
+   for this one — task_stack_unused_words(&blink_task) shows the margin.
+   ────────────────────────────────────────────────────────────────────────── */
+#define BLINK_PERIOD_US     500000u     /* 500 ms → 1 Hz blink               */
+#define BLINK_STACK_WORDS   128u
+#define BLINK_PRIORITY      4u
+
+static struct task blink_task;
+static uint32_t blink_stack[BLINK_STACK_WORDS] __attribute__((aligned(8)));
+static struct watchdog_client blink_watchdog;
+
+static void blink(void *arg) {
+    (void)arg;
+
+    while (1) {
+        task_sleep_us(BLINK_PERIOD_US);
+
+        /* XOR the LED pin bit: if it was 1 it becomes 0, if 0 it becomes 1 */
+        gpio_xor_mask(LED_MASK);
+        watchdog_checkin(&blink_watchdog);
+    }
+}
+
+/* ── KV maintenance task ─────────────────────────────────────────────────────
+   Compacts the KV store in the background, one sector per kv_maintain()
+   call, while fewer than KV_COMPACT_FREE_SECTORS sectors are erased. That
+   way a kv_set() only has to compact in the foreground when writes outrun
+   this task. It runs just above idle, so it only gets the time no other
+   task wants, and checks once a second: compaction is only ever needed
+   after writes, and those are rare. kv.c serialises this task's
+   kv_maintain() with kv_set() and kv_delete() from any other.
+
+   A compaction copies records through the flash page buffer and erases a
+   sector through the bootrom, both on this stack: 256 words.
    ────────────────────────────────────────────────────────────────────────── */
-void SysTick_Handler(void) {
-    tick_count++;
+#define KV_MAINTAIN_PERIOD_US   1000000u
+#define KV_STACK_WORDS          256u
+#define KV_PRIORITY             200u
+
+static struct task kv_task;
+static uint32_t kv_stack[KV_STACK_WORDS] __attribute__((aligned(8)));
 
-    /* Toggle LED every 500 ticks — at 1kHz SysTick this is 500ms (0.5Hz blink)
-       XOR the LED pin bit: if it was 1 it becomes 0, if 0 it becomes 1      */
-    if ((tick_count % 500) == 0) {
-        GPIO_OUT_XOR = LED_MASK;
+static void kv_maintenance(void *arg) {
+    (void)arg;
+
+    while (1) {
+        task_sleep_us(KV_MAINTAIN_PERIOD_US);
+
+        /* 1 per sector compacted; stop at 0 (enough erased) or -1 (full) */
+        while (kv_maintain() > 0);
     }
 }
 
+/* ── Watchdog ────────────────────────────────────────────────────────────────
+   Fed only while every registered loop keeps its deadline (watchdog.h).
+   The timeout covers the longest interrupts-off window, a flash sector
+   erase; the blink task may be up to one period late before it counts as
+   stuck.
+   ────────────────────────────────────────────────────────────────────────── */
+#define WATCHDOG_TIMEOUT_MS     1000u
+#define BLINK_DEADLINE_US       (2u * BLINK_PERIOD_US)
+
 /* ── Peripheral initialisation ───────────────────────────────────────────── */
 static void resets_init(void) {
     /* Release IO_BANK0 and PADS_BANK0 from reset atomically                  */
@@ -128,48 +112,78 @@ static void resets_init(void) {
                               != (RESET_IO_BANK0 | RESET_PADS_BANK0));
 }
 
-static void gpio_init(void) {
+static void led_init(void) {
     /* Connect GPIO 25 to the SIO block (plain software-controlled GPIO)      */
-    GPIO25_CTRL = FUNCSEL_SIO;
+    gpio_init(LED_PIN);
 
     /* Enable GPIO 25 as an output
        The SIO OE_SET register only raises bits — never lowers others
        so we do not need a read-modify-write                                   */
-    GPIO_OE_SET = LED_MASK;
-    GPIO_OUT_XOR = LED_MASK;
+    gpio_set_dir_out_masked(LED_MASK);
+    gpio_xor_mask(LED_MASK);
 }
 
 static void systick_init(void) {
-    /* RP2040 boots using the Ring Oscillator (~6 MHz).
-       6000 ticks at 6MHz = 1ms per SysTick interrupt → 1kHz tick rate
-       This gives us millisecond resolution for timing.
-       
-       In a production system you would configure the crystal oscillator
-       and PLL first, then derive this value from a known clock frequency.
-       For now ROSC is good enough to make the LED blink visibly.             */
-    const uint32_t ticks_per_ms = 6000;
-
-    SYST_RVR = ticks_per_ms - 1;   /* reload value (24-bit max: 16,777,215)  */
+    /* SysTick no longer drives the blink, so it raises no interrupt. It
+       free-runs over its full 24-bit range counting clk_sys cycles, a
+       cycle-accurate clock for measuring short intervals (a wrap every
+       ~134 ms at 125 MHz — compare two reads with (a - b) & SYST_CVR_MASK). */
+    SYST_RVR = SYST_CVR_MASK;       /* reload value (24-bit max: 16,777,215)  */
     SYST_CVR = 0;                   /* reset current count before starting    */
-    SYST_CSR = (1u << 2)            /* CLKSOURCE: processor clock             */
-             | (1u << 1)            /* TICKINT:   fire interrupt on zero       */
-             | (1u << 0);           /* ENABLE:    start the timer              */
+    SYST_CSR = SYST_CSR_CLKSOURCE   /* processor clock                        */
+             | SYST_CSR_ENABLE;     /* start the timer, no TICKINT            */
+}
+
+/* ── core1_main ──────────────────────────────────────────────────────────────
+   Core 1 starts here on its own stack (SCRATCH_Y) with its own vector table,
+   NVIC and SysTick. It has nothing to do yet, so it sleeps; wfe rather than
+   wfi so that a sev from core 0 can wake it once there is work to hand over.
+
+   Its loop runs from Flash, so it registers for the flash lockout first:
+   while core 0 erases or programs (the KV store), core 1 waits in RAM
+   instead of fetching its next instruction with XIP switched off.
+   ────────────────────────────────────────────────────────────────────────── */
+static void core1_main(void) {
+    flash_lockout_victim_init();
+
+    while (1) {
+        cpu_wfe();
+    }
 }
 
 /* ── main ────────────────────────────────────────────────────────────────── */
 int main(void) {
+    boot_profile_mark(BOOT_MARK_MAIN);
     resets_init();
-    gpio_init();
+    boot_profile_mark(BOOT_MARK_RESETS);
+    sram_banks_init();
+    led_init();
+    boot_profile_mark(BOOT_MARK_GPIO);
     systick_init();
-
-    /* main() does nothing — all work happens in SysTick_Handler.
-       In a real application you would check flags set by ISRs here,
-       process data, manage state machines. The ISR only sets flags
-       and does minimal work — main() does the heavy lifting.
-       This pattern is called "deferred processing".                          */
-    while (1) {
-        /* low power sleep — wake on next interrupt
-           saves power and makes interrupt latency more predictable           */
-        //__asm volatile ("wfi");
-    }
-}
\ No newline at end of file
+    boot_profile_mark(BOOT_MARK_SYSTICK);
+    multicore_launch_core1(core1_main);
+
+    swtimer_init();
+    flash_init();
+    kv_init();
+    uart_init(CONSOLE_UART, CONSOLE_BAUD, CONSOLE_TX_PIN, CONSOLE_RX_PIN);
+    boot_profile_dump(uart0_putc);  /* no-op unless built with BOOT_PROFILE */
+    fault_report(uart0_putc);       /* what crashed before the last reset  */
+    watchdog_report_reset(uart0_putc);
+    profile_init();
+    profile_sampler_start(1000);    /* no-ops unless built with PROFILE=1  */
+    task_create(&blink_task, "blink", blink, 0,
+                blink_stack, BLINK_STACK_WORDS, BLINK_PRIORITY);
+    task_create(&kv_task, "kv", kv_maintenance, 0,
+                kv_stack, KV_STACK_WORDS, KV_PRIORITY);
+    watchdog_client_register(&blink_watchdog, "blink", BLINK_DEADLINE_US);
+    watchdog_supervisor_start(WATCHDOG_TIMEOUT_MS);
+
+    /* From here on main() is gone: its stack becomes the interrupt stack
+       and all work happens in tasks. Interrupt handlers only do minimal
+       work and notify a task (task_notify) — the task does the heavy
+       lifting. This pattern is called "deferred processing". When no task
+       is ready, the idle task sleeps in wfi until the next interrupt.        */
+    boot_profile_mark(BOOT_MARK_LOOP);
+    sched_start();
+}
@@ -0,0 +1,17 @@
+#ifndef MEM_OPS_H
+#define MEM_OPS_H
+
+#include <stddef.h>
+
+/* ── Memory primitives (src/mem_ops.S) ───────────────────────────────────────
+   The standard C names, implemented in assembly for Cortex-M0+. They are
+   what GCC calls implicitly for struct copies and large initialisers, so
+   they must keep their libc signatures and semantics exactly.
+   Word-aligned copies and fills run in 16-byte ldmia/stmia bursts.
+   ────────────────────────────────────────────────────────────────────────── */
+void *memcpy(void *dst, const void *src, size_t n);
+void *memset(void *dst, int c, size_t n);
+void *memmove(void *dst, const void *src, size_t n);
+int   memcmp(const void *a, const void *b, size_t n);
+
+#endif
@@ -0,0 +1,79 @@
+#include <stdint.h>
+#include "rp2040.h"
+#include "irq.h"
+#include "multicore.h"
+#include "stack.h"
+
+/* From linker.ld: top of SCRATCH_Y, reserved for core 1's stack            */
+extern uint32_t _core1_stack_top;
+extern uint32_t _core1_stack_limit;
+
+extern const uint32_t vector_table[VECTOR_TABLE_ENTRIES];
+
+/* Written by core 0 before the launch handshake, read once by core 1      */
+static void (*volatile core1_entry)(void);
+
+/* First code core 1 runs. The bootrom has already loaded SP and VTOR from
+   the launch sequence, so all that is left is the per-core setup core 0
+   did in Reset_Handler: its stack painted, a RAM vector table of its own
+   and, with STACK_GUARD, its own MPU guarding its own stack.              */
+static void core1_trampoline(void) {
+    stack_paint_below_sp(&_core1_stack_limit);
+    irq_init_vector_table();
+    stack_guard_init();
+
+    core1_entry();
+
+    while (1) {
+        cpu_wfe();
+    }
+}
+
+void multicore_reset_core1(void) {
+    PSM_FRCE_OFF_SET = PSM_PROC1;
+    while (!(PSM_FRCE_OFF & PSM_PROC1));
+    PSM_FRCE_OFF_CLR = PSM_PROC1;
+
+    /* Coming out of reset, the bootrom on core 1 pushes a single 0 to say
+       it is ready. Consume it so it cannot be mistaken for an echo.        */
+    (void)multicore_fifo_pop_blocking();
+}
+
+void multicore_launch_core1(void (*entry)(void)) {
+    /* A FIFO interrupt handler on this core would swallow core 1's echoes  */
+    const int fifo_irq_was_enabled = irq_is_enabled(SIO_IRQ_PROC0);
+    irq_set_enabled(SIO_IRQ_PROC0, 0);
+
+    multicore_reset_core1();
+
+    core1_entry = entry;
+    /* The entry pointer must be in RAM before core 1 can be told to go     */
+    __asm volatile ("dmb" ::: "memory");
+
+    const uint32_t cmds[] = {
+        0, 0, 1,
+        (uint32_t)vector_table,     /* core 1 copies it to RAM itself        */
+        (uint32_t)&_core1_stack_top,
+        (uint32_t)core1_trampoline,
+    };
+    const uint32_t ncmds = sizeof(cmds) / sizeof(cmds[0]);
+    uint32_t seq = 0;
+
+    do {
+        const uint32_t cmd = cmds[seq];
+
+        /* Before each 0, flush stale words both ways: drain ours, and sev
+           in case core 1 is asleep with something it wants to send         */
+        if (cmd == 0) {
+            multicore_fifo_drain();
+            cpu_sev();
+        }
+
+        multicore_fifo_push_blocking(cmd);
+        const uint32_t response = multicore_fifo_pop_blocking();
+
+        seq = (response == cmd) ? seq + 1 : 0;
+    } while (seq < ncmds);
+
+    irq_set_enabled(SIO_IRQ_PROC0, fifo_irq_was_enabled);
+}
@@ -0,0 +1,129 @@
+#ifndef MULTICORE_H
+#define MULTICORE_H
+
+#include <stdint.h>
+#include "rp2040.h"
+
+/* ── Inter-core FIFOs ────────────────────────────────────────────────────────
+   Two 8-deep, 32-bit FIFOs in the SIO, one in each direction. Each core
+   writes FIFO_WR to send to the other and reads FIFO_RD to receive; the
+   registers are the same addresses on both cores, the SIO routes them.
+
+   FIFO_ST:  bit 0 VLD — RX FIFO has data
+             bit 1 RDY — TX FIFO has room
+             bit 2 WOF — TX was written while full (sticky, write to clear)
+             bit 3 ROE — RX was read while empty (sticky, write to clear)
+   Any of these raise the core's SIO_IRQ_PROCn while RX has data or a
+   sticky error is set.
+   ────────────────────────────────────────────────────────────────────────── */
+#define SIO_FIFO_ST         MMIO32(SIO_BASE + 0x050)
+#define SIO_FIFO_WR         MMIO32(SIO_BASE + 0x054)
+#define SIO_FIFO_RD         MMIO32(SIO_BASE + 0x058)
+
+#define SIO_FIFO_ST_VLD     (1u << 0)
+#define SIO_FIFO_ST_RDY     (1u << 1)
+#define SIO_FIFO_ST_WOF     (1u << 2)
+#define SIO_FIFO_ST_ROE     (1u << 3)
+
+/* ── PSM (power-on state machine) ────────────────────────────────────────────
+   FRCE_OFF holds a block powered down. Pulsing the PROC1 bit resets core 1
+   back into the bootrom, where it waits for the launch handshake.
+   ────────────────────────────────────────────────────────────────────────── */
+#define PSM_BASE            0x40010000u
+#define PSM_FRCE_OFF        MMIO32(PSM_BASE + 0x004)
+#define PSM_FRCE_OFF_SET    MMIO32(PSM_BASE + 0x004 + REG_ALIAS_SET)
+#define PSM_FRCE_OFF_CLR    MMIO32(PSM_BASE + 0x004 + REG_ALIAS_CLR)
+
+#define PSM_PROC1           (1u << 16)
+
+static inline int multicore_fifo_rvalid(void) {
+    return (SIO_FIFO_ST & SIO_FIFO_ST_VLD) != 0;
+}
+
+static inline int multicore_fifo_wready(void) {
+    return (SIO_FIFO_ST & SIO_FIFO_ST_RDY) != 0;
+}
+
+/* Push a word to the other core, waiting for room. sev wakes the other
+   core if it is parked in wfe.                                              */
+static inline void multicore_fifo_push_blocking(uint32_t data) {
+    while (!multicore_fifo_wready());
+    SIO_FIFO_WR = data;
+    cpu_sev();
+}
+
+/* Pop a word from the other core, sleeping in wfe until one arrives        */
+static inline uint32_t multicore_fifo_pop_blocking(void) {
+    while (!multicore_fifo_rvalid()) {
+        cpu_wfe();
+    }
+    return SIO_FIFO_RD;
+}
+
+/* Throw away anything waiting in this core's RX FIFO                       */
+static inline void multicore_fifo_drain(void) {
+    while (multicore_fifo_rvalid()) {
+        (void)SIO_FIFO_RD;
+    }
+}
+
+/* Clear the sticky WOF/ROE flags (and with them a pending FIFO IRQ)        */
+static inline void multicore_fifo_clear_irq(void) {
+    SIO_FIFO_ST = 0xFFu;
+}
+
+/* ── Doorbell ────────────────────────────────────────────────────────────────
+   Once both cores run, the FIFO carries no data of its own: bulk transfer
+   goes through shared-memory queues (spsc.h), and a FIFO word only means
+   "look at your queues". Ring it after publishing work:
+
+   - the token makes SIO_IRQ_PROCn pending on the other core, waking it
+     from wfi or running its FIFO handler if it enabled one
+   - sev sets the other core's event register, waking it from wfe — and
+     if it was not asleep yet, its next wfe returns at once, so a wake-up
+     cannot be lost between "queue empty?" and "sleep"
+
+   If the FIFO is already full the other core has unread doorbells, so the
+   token is dropped instead of blocking the producer.
+   ────────────────────────────────────────────────────────────────────────── */
+#define MULTICORE_DOORBELL  0x0D00BE11u
+
+static inline void multicore_doorbell_ring(void) {
+    if (multicore_fifo_wready()) {
+        SIO_FIFO_WR = MULTICORE_DOORBELL;
+    }
+    cpu_sev();
+}
+
+/* Consume every pending doorbell, so SIO_IRQ_PROCn is no longer asserted.
+   Call before re-checking the queues, never after: a doorbell rung in
+   between must survive until the next check.                               */
+static inline void multicore_doorbell_clear(void) {
+    multicore_fifo_drain();
+    multicore_fifo_clear_irq();
+}
+
+/* ── Core 1 launch ───────────────────────────────────────────────────────────
+   After reset core 1 sits in the bootrom, asleep, waiting for core 0 to send
+   it a six-word sequence over the FIFO:
+
+       0, 0, 1, vector table, stack pointer, entry point
+
+   Core 1 echoes each word back. A mismatch means it was out of step (left
+   over words, a previous half-finished launch) and the sequence restarts.
+   The leading zeros make the bootrom drop whatever it had received.
+
+   Once launched, core 1 runs entry on the stack at the top of SCRATCH_Y
+   with its own RAM vector table. Nothing else is shared by default: each
+   core has its own NVIC, SysTick, VTOR and SIO FIFO status.
+   ────────────────────────────────────────────────────────────────────────── */
+
+/* Force core 1 back into the bootrom. Needed before a launch if core 1 may
+   already be running, e.g. after a debugger reset of core 0 only.          */
+void multicore_reset_core1(void);
+
+/* Reset core 1 and start it running entry. Call from core 0. entry should
+   not return; if it does, core 1 sleeps in wfe forever.                    */
+void multicore_launch_core1(void (*entry)(void));
+
+#endif
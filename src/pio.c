@@ -0,0 +1,191 @@
+#include <stdint.h>
+#include "rp2040.h"
+#include "clocks.h"
+#include "dma.h"
+#include "gpio.h"
+#include "sync.h"
+#include "pio.h"
+
+/* FDEBUG: sticky per-SM flags, write 1 to clear */
+#define PIO_FDEBUG_SM_MASK(sm)  (0x01010101u << (sm))
+
+#define PIO_SET_MAX_PINS        5u      /* SET writes at most 5 pins         */
+
+/* One bit per instruction slot and per state machine in use, guarded by
+   the shared claim spinlock like the DMA channel claims                    */
+static uint32_t used_instructions[PIO_NUM];
+static uint32_t claimed_sms[PIO_NUM];
+
+void pio_init(uint32_t p) {
+    /* No reset_block(): state machines already running would stop          */
+    unreset_block_wait(p ? RESET_PIO1 : RESET_PIO0);
+}
+
+static uint32_t program_mask(uint32_t length, uint32_t offset) {
+    const uint32_t bits = length >= 32u ? 0xFFFFFFFFu : (1u << length) - 1u;
+    return bits << offset;
+}
+
+/* Either the program's fixed origin if that range is free, or the highest
+   free range: programs fill memory from the top, so fixed-origin programs
+   (usually wanting address 0) still find their slot afterwards.           */
+static int find_offset(uint32_t used, const struct pio_program *program) {
+    if (program->length > PIO_INSTRUCTION_COUNT) {
+        return -1;
+    }
+    if (program->origin >= 0) {
+        const uint32_t origin = (uint32_t)program->origin;
+        if (origin + program->length > PIO_INSTRUCTION_COUNT
+            || (used & program_mask(program->length, origin))) {
+            return -1;
+        }
+        return (int)origin;
+    }
+    for (int offset = (int)(PIO_INSTRUCTION_COUNT - program->length);
+         offset >= 0; offset--) {
+        if (!(used & program_mask(program->length, (uint32_t)offset))) {
+            return offset;
+        }
+    }
+    return -1;
+}
+
+int pio_add_program(uint32_t p, const struct pio_program *program) {
+    spin_lock_t *lock = spin_lock_instance(SPINLOCK_ID_CLAIM);
+    const uint32_t saved = spin_lock_blocking(lock);
+
+    const int offset = find_offset(used_instructions[p], program);
+    if (offset >= 0) {
+        for (uint32_t i = 0; i < program->length; i++) {
+            uint16_t instr = program->instructions[i];
+            /* JMP is the only instruction holding an absolute address      */
+            if ((instr & PIO_INSTR_MASK) == PIO_INSTR_JMP) {
+                instr = (uint16_t)((instr & ~0x1Fu)
+                                   | ((instr + (uint32_t)offset) & 0x1Fu));
+            }
+            PIO_INSTR_MEM(p, (uint32_t)offset + i) = instr;
+        }
+        used_instructions[p] |= program_mask(program->length,
+                                             (uint32_t)offset);
+    }
+
+    spin_unlock(lock, saved);
+    return offset;
+}
+
+void pio_remove_program(uint32_t p, const struct pio_program *program,
+                        uint32_t offset) {
+    spin_lock_t *lock = spin_lock_instance(SPINLOCK_ID_CLAIM);
+    const uint32_t saved = spin_lock_blocking(lock);
+    used_instructions[p] &= ~program_mask(program->length, offset);
+    spin_unlock(lock, saved);
+}
+
+int pio_claim_unused_sm(uint32_t p) {
+    spin_lock_t *lock = spin_lock_instance(SPINLOCK_ID_CLAIM);
+    const uint32_t saved = spin_lock_blocking(lock);
+    int sm = -1;
+
+    for (uint32_t i = 0; i < PIO_NUM_SMS; i++) {
+        if (!(claimed_sms[p] & (1u << i))) {
+            claimed_sms[p] |= 1u << i;
+            sm = (int)i;
+            break;
+        }
+    }
+
+    spin_unlock(lock, saved);
+    return sm;
+}
+
+void pio_sm_unclaim(uint32_t p, uint32_t sm) {
+    spin_lock_t *lock = spin_lock_instance(SPINLOCK_ID_CLAIM);
+    const uint32_t saved = spin_lock_blocking(lock);
+    claimed_sms[p] &= ~(1u << sm);
+    spin_unlock(lock, saved);
+}
+
+void sm_config_set_clkdiv_hz(pio_sm_config *c, uint32_t hz) {
+    const uint64_t clk = clock_get_hz(CLK_SYS);
+    uint64_t div = ((clk << 8) + hz / 2u) / hz;     /* 16.8 fixed point      */
+
+    if (div < 0x100u) {
+        div = 0x100u;                               /* at most clk_sys       */
+    } else if (div >= 0x1000000u) {
+        div = 0;                                    /* 0 = divide by 65536   */
+    }
+    sm_config_set_clkdiv_int_frac(c, (uint32_t)(div >> 8),
+                                  (uint32_t)div & 0xFFu);
+}
+
+void pio_gpio_init(uint32_t p, uint32_t pin) {
+    gpio_set_function(pin, p ? GPIO_FUNC_PIO1 : GPIO_FUNC_PIO0);
+}
+
+void pio_sm_init(uint32_t p, uint32_t sm, uint32_t initial_pc,
+                 const pio_sm_config *config) {
+    pio_sm_set_enabled(p, sm, 0);
+
+    PIO_SM_CLKDIV(p, sm)    = config->clkdiv;
+    PIO_SM_EXECCTRL(p, sm)  = config->execctrl;
+    PIO_SM_SHIFTCTRL(p, sm) = config->shiftctrl;
+    PIO_SM_PINCTRL(p, sm)   = config->pinctrl;
+
+    /* Changing the FIFO join empties both FIFOs; toggling it twice does
+       that and leaves the join as configured                               */
+    hw_xor_bits(&PIO_SM_SHIFTCTRL(p, sm), PIO_SHIFT_FJOIN_RX);
+    hw_xor_bits(&PIO_SM_SHIFTCTRL(p, sm), PIO_SHIFT_FJOIN_RX);
+
+    PIO_FDEBUG(p) = PIO_FDEBUG_SM_MASK(sm);
+
+    /* Both restart bits self-clear: the first resets the SM's internal
+       state (shift counters, stalls), the second the divider's phase       */
+    hw_set_bits(&PIO_CTRL(p), (1u << (PIO_CTRL_SM_RESTART_LSB + sm))
+                              | (1u << (PIO_CTRL_CLKDIV_RESTART_LSB + sm)));
+
+    pio_sm_exec(p, sm, pio_encode_jmp(initial_pc));
+}
+
+void pio_sm_set_consecutive_pindirs(uint32_t p, uint32_t sm, uint32_t base,
+                                    uint32_t count, int out) {
+    const uint32_t pinctrl = PIO_SM_PINCTRL(p, sm);
+    const uint32_t execctrl = PIO_SM_EXECCTRL(p, sm);
+
+    /* A sticky OUT would re-assert the old directions over the SET         */
+    PIO_SM_EXECCTRL(p, sm) = execctrl & ~PIO_EXEC_OUT_STICKY;
+
+    while (count) {
+        const uint32_t n = count < PIO_SET_MAX_PINS ? count : PIO_SET_MAX_PINS;
+        PIO_SM_PINCTRL(p, sm) = (base << PIO_PIN_SET_BASE_LSB)
+                              | (n << PIO_PIN_SET_COUNT_LSB);
+        pio_sm_exec(p, sm, pio_encode_set(PIO_SET_PINDIRS,
+                                          out ? 0x1Fu : 0u));
+        base = (base + n) & 0x1Fu;
+        count -= n;
+    }
+
+    PIO_SM_PINCTRL(p, sm) = pinctrl;
+    PIO_SM_EXECCTRL(p, sm) = execctrl;
+}
+
+void pio_sm_dma_to_tx(uint32_t p, uint32_t sm, uint32_t ch,
+                      const volatile void *src, uint32_t count,
+                      enum dma_size size) {
+    dma_channel_config c = dma_channel_get_default_config(ch);
+    channel_config_set_transfer_data_size(&c, size);
+    channel_config_set_read_increment(&c, 1);
+    channel_config_set_write_increment(&c, 0);
+    channel_config_set_dreq(&c, DREQ_PIO_TX(p, sm));
+    dma_channel_configure(ch, &c, &PIO_TXF(p, sm), src, count, 1);
+}
+
+void pio_sm_dma_from_rx(uint32_t p, uint32_t sm, uint32_t ch,
+                        volatile void *dst, uint32_t count,
+                        enum dma_size size) {
+    dma_channel_config c = dma_channel_get_default_config(ch);
+    channel_config_set_transfer_data_size(&c, size);
+    channel_config_set_read_increment(&c, 0);
+    channel_config_set_write_increment(&c, 1);
+    channel_config_set_dreq(&c, DREQ_PIO_RX(p, sm));
+    dma_channel_configure(ch, &c, dst, &PIO_RXF(p, sm), count, 1);
+}
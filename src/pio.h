@@ -0,0 +1,377 @@
+#ifndef PIO_H
+#define PIO_H
+
+#include <stdint.h>
+#include "rp2040.h"
+#include "dma.h"
+
+/* ── PIO ─────────────────────────────────────────────────────────────────────
+   Two PIO blocks, each with four state machines sharing a 32-instruction
+   memory. A state machine is a tiny processor with two shift registers, two
+   scratch registers, a 4-deep TX and RX FIFO and direct access to the GPIOs,
+   running one instruction per (divided) clk_sys cycle. Protocols that would
+   tie up a CPU bit-banging — WS2812, extra UARTs, parallel buses, logic
+   capture — run on a state machine instead, fed or drained by DMA.
+
+   Per-SM registers repeat every 0x18 bytes from SM0_CLKDIV.
+   ────────────────────────────────────────────────────────────────────────── */
+#define PIO0_BASE               0x50200000u
+#define PIO1_BASE               0x50300000u
+#define PIO_NUM                 2u
+#define PIO_NUM_SMS             4u
+#define PIO_INSTRUCTION_COUNT   32u
+
+#define PIO_BASE(p)             ((p) ? PIO1_BASE : PIO0_BASE)
+#define PIO_CTRL(p)             MMIO32(PIO_BASE(p) + 0x000)
+#define PIO_FSTAT(p)            MMIO32(PIO_BASE(p) + 0x004)
+#define PIO_FDEBUG(p)           MMIO32(PIO_BASE(p) + 0x008)
+#define PIO_FLEVEL(p)           MMIO32(PIO_BASE(p) + 0x00C)
+#define PIO_TXF(p, sm)          MMIO32(PIO_BASE(p) + 0x010 + 4u * (sm))
+#define PIO_RXF(p, sm)          MMIO32(PIO_BASE(p) + 0x020 + 4u * (sm))
+#define PIO_IRQ(p)              MMIO32(PIO_BASE(p) + 0x030)
+#define PIO_INSTR_MEM(p, i)     MMIO32(PIO_BASE(p) + 0x048 + 4u * (i))
+
+#define PIO_SM_BASE(p, sm)      (PIO_BASE(p) + 0x0C8 + 0x18u * (sm))
+#define PIO_SM_CLKDIV(p, sm)    MMIO32(PIO_SM_BASE(p, sm) + 0x00)
+#define PIO_SM_EXECCTRL(p, sm)  MMIO32(PIO_SM_BASE(p, sm) + 0x04)
+#define PIO_SM_SHIFTCTRL(p, sm) MMIO32(PIO_SM_BASE(p, sm) + 0x08)
+#define PIO_SM_ADDR(p, sm)      MMIO32(PIO_SM_BASE(p, sm) + 0x0C)
+#define PIO_SM_INSTR(p, sm)     MMIO32(PIO_SM_BASE(p, sm) + 0x10)
+#define PIO_SM_PINCTRL(p, sm)   MMIO32(PIO_SM_BASE(p, sm) + 0x14)
+
+/* CTRL: one bit per state machine in each field */
+#define PIO_CTRL_SM_ENABLE_LSB      0
+#define PIO_CTRL_SM_RESTART_LSB     4
+#define PIO_CTRL_CLKDIV_RESTART_LSB 8
+
+/* FSTAT: one bit per state machine in each field */
+#define PIO_FSTAT_RXFULL_LSB    0
+#define PIO_FSTAT_RXEMPTY_LSB   8
+#define PIO_FSTAT_TXFULL_LSB    16
+#define PIO_FSTAT_TXEMPTY_LSB   24
+
+/* CLKDIV: 16.8 fixed point, 0 means 65536 */
+#define PIO_CLKDIV_FRAC_LSB     8
+#define PIO_CLKDIV_INT_LSB      16
+
+/* EXECCTRL */
+#define PIO_EXEC_STATUS_N_LSB       0
+#define PIO_EXEC_STATUS_SEL         (1u << 4)
+#define PIO_EXEC_WRAP_BOTTOM_LSB    7
+#define PIO_EXEC_WRAP_TOP_LSB       12
+#define PIO_EXEC_OUT_STICKY         (1u << 17)
+#define PIO_EXEC_INLINE_OUT_EN      (1u << 18)
+#define PIO_EXEC_OUT_EN_SEL_LSB     19
+#define PIO_EXEC_JMP_PIN_LSB        24
+#define PIO_EXEC_SIDE_PINDIR        (1u << 29)
+#define PIO_EXEC_SIDE_EN            (1u << 30)
+#define PIO_EXEC_STALLED            (1u << 31)
+
+/* SHIFTCTRL */
+#define PIO_SHIFT_AUTOPUSH          (1u << 16)
+#define PIO_SHIFT_AUTOPULL          (1u << 17)
+#define PIO_SHIFT_IN_SHIFTDIR       (1u << 18)  /* 1 = shift right          */
+#define PIO_SHIFT_OUT_SHIFTDIR      (1u << 19)
+#define PIO_SHIFT_PUSH_THRESH_LSB   20
+#define PIO_SHIFT_PULL_THRESH_LSB   25
+#define PIO_SHIFT_FJOIN_TX          (1u << 30)
+#define PIO_SHIFT_FJOIN_RX          (1u << 31)
+
+/* PINCTRL */
+#define PIO_PIN_OUT_BASE_LSB        0
+#define PIO_PIN_SET_BASE_LSB        5
+#define PIO_PIN_SIDESET_BASE_LSB    10
+#define PIO_PIN_IN_BASE_LSB         15
+#define PIO_PIN_OUT_COUNT_LSB       20
+#define PIO_PIN_SET_COUNT_LSB       26
+#define PIO_PIN_SIDESET_COUNT_LSB   29
+
+#define RESET_PIO0              (1u << 10)
+#define RESET_PIO1              (1u << 11)
+
+/* DMA pacing: TX FIFO not full / RX FIFO not empty, one line per SM         */
+#define DREQ_PIO_TX(p, sm)      (8u * (p) + (sm))
+#define DREQ_PIO_RX(p, sm)      (8u * (p) + 4u + (sm))
+
+/* ── Instruction encoding ────────────────────────────────────────────────────
+   Enough to build the instructions the driver itself executes on a state
+   machine; programs come from pioasm (or are written out by hand).
+   ────────────────────────────────────────────────────────────────────────── */
+#define PIO_INSTR_JMP           0x0000u
+#define PIO_INSTR_SET           0xE000u
+#define PIO_INSTR_MASK          0xE000u     /* the 3-bit major opcode        */
+
+enum pio_set_dest {
+    PIO_SET_PINS    = 0,
+    PIO_SET_X       = 1,
+    PIO_SET_Y       = 2,
+    PIO_SET_PINDIRS = 4,
+};
+
+static inline uint16_t pio_encode_jmp(uint32_t addr) {
+    return (uint16_t)(PIO_INSTR_JMP | (addr & 0x1Fu));
+}
+
+static inline uint16_t pio_encode_set(enum pio_set_dest dest, uint32_t value) {
+    return (uint16_t)(PIO_INSTR_SET | ((uint32_t)dest << 5) | (value & 0x1Fu));
+}
+
+/* ── Programs ────────────────────────────────────────────────────────────────
+   Instructions are assembled as if loaded at address 0. JMP targets are
+   absolute, so pio_add_program() relocates them by the load offset; every
+   other instruction is position-independent. wrap_target and wrap are the
+   program's .wrap_target/.wrap, also relative to its first instruction.
+
+       static const uint16_t square_insns[] = {
+           0xE081,     //     set pindirs, 1
+           0xE101,     // .wrap_target
+                       //     set pins, 1 [1]
+           0xE000,     //     set pins, 0
+                       // .wrap
+       };
+       static const struct pio_program square = {
+           .instructions = square_insns, .length = 3, .origin = -1,
+           .wrap_target = 1, .wrap = 2,
+       };
+   ────────────────────────────────────────────────────────────────────────── */
+struct pio_program {
+    const uint16_t *instructions;
+    uint8_t length;
+    int8_t origin;                  /* required load address, -1 = any     */
+    uint8_t wrap_target;
+    uint8_t wrap;
+};
+
+/* Release PIO block p from reset. Idempotent, like dma_init().            */
+void pio_init(uint32_t p);
+
+/* Load a program into free instruction memory. Returns its offset (where
+   its instruction 0 went), or -1 if there is no room.                     */
+int  pio_add_program(uint32_t p, const struct pio_program *program);
+
+void pio_remove_program(uint32_t p, const struct pio_program *program,
+                        uint32_t offset);
+
+/* Claim a free state machine. Returns its number, or -1 if none is free.  */
+int  pio_claim_unused_sm(uint32_t p);
+
+void pio_sm_unclaim(uint32_t p, uint32_t sm);
+
+/* ── State machine configuration ─────────────────────────────────────────────
+   Like dma_channel_config: the register values being built up before
+   pio_sm_init() writes them, so a config can live on the stack. Start
+   from pio_get_default_sm_config() (or pio_program_default_config()).
+   ────────────────────────────────────────────────────────────────────────── */
+typedef struct {
+    uint32_t clkdiv;
+    uint32_t execctrl;
+    uint32_t shiftctrl;
+    uint32_t pinctrl;
+} pio_sm_config;
+
+/* The hardware reset state: full speed, wrap over the whole memory, both
+   shift registers shifting right without autopush/autopull.               */
+static inline pio_sm_config pio_get_default_sm_config(void) {
+    pio_sm_config c;
+    c.clkdiv    = 1u << PIO_CLKDIV_INT_LSB;
+    c.execctrl  = 31u << PIO_EXEC_WRAP_TOP_LSB;
+    c.shiftctrl = PIO_SHIFT_IN_SHIFTDIR | PIO_SHIFT_OUT_SHIFTDIR;
+    c.pinctrl   = 5u << PIO_PIN_SET_COUNT_LSB;
+    return c;
+}
+
+static inline void sm_config_set_field(uint32_t *reg, uint32_t mask,
+                                       uint32_t value) {
+    *reg = (*reg & ~mask) | (value & mask);
+}
+
+/* Absolute addresses, i.e. already offset by where the program loaded      */
+static inline void sm_config_set_wrap(pio_sm_config *c, uint32_t wrap_target,
+                                      uint32_t wrap) {
+    sm_config_set_field(&c->execctrl,
+                        (0x1Fu << PIO_EXEC_WRAP_BOTTOM_LSB)
+                        | (0x1Fu << PIO_EXEC_WRAP_TOP_LSB),
+                        (wrap_target << PIO_EXEC_WRAP_BOTTOM_LSB)
+                        | (wrap << PIO_EXEC_WRAP_TOP_LSB));
+}
+
+/* Defaults plus the program's wrap, relocated to offset                    */
+static inline pio_sm_config pio_program_default_config(
+        const struct pio_program *program, uint32_t offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + program->wrap_target,
+                       offset + program->wrap);
+    return c;
+}
+
+/* Pins used by OUT, SET, IN and side-set: a base GPIO and, except for IN,
+   a count. Pin numbers wrap around at 32.                                 */
+static inline void sm_config_set_out_pins(pio_sm_config *c, uint32_t base,
+                                          uint32_t count) {
+    sm_config_set_field(&c->pinctrl,
+                        (0x1Fu << PIO_PIN_OUT_BASE_LSB)
+                        | (0x3Fu << PIO_PIN_OUT_COUNT_LSB),
+                        (base << PIO_PIN_OUT_BASE_LSB)
+                        | (count << PIO_PIN_OUT_COUNT_LSB));
+}
+
+static inline void sm_config_set_set_pins(pio_sm_config *c, uint32_t base,
+                                          uint32_t count) {
+    sm_config_set_field(&c->pinctrl,
+                        (0x1Fu << PIO_PIN_SET_BASE_LSB)
+                        | (0x7u << PIO_PIN_SET_COUNT_LSB),
+                        (base << PIO_PIN_SET_BASE_LSB)
+                        | (count << PIO_PIN_SET_COUNT_LSB));
+}
+
+static inline void sm_config_set_in_pins(pio_sm_config *c, uint32_t base) {
+    sm_config_set_field(&c->pinctrl, 0x1Fu << PIO_PIN_IN_BASE_LSB,
+                        base << PIO_PIN_IN_BASE_LSB);
+}
+
+static inline void sm_config_set_sideset_pins(pio_sm_config *c,
+                                              uint32_t base) {
+    sm_config_set_field(&c->pinctrl, 0x1Fu << PIO_PIN_SIDESET_BASE_LSB,
+                        base << PIO_PIN_SIDESET_BASE_LSB);
+}
+
+/* bit_count includes the enable bit when side-set is optional              */
+static inline void sm_config_set_sideset(pio_sm_config *c, uint32_t bit_count,
+                                         int optional, int pindirs) {
+    sm_config_set_field(&c->pinctrl, 0x7u << PIO_PIN_SIDESET_COUNT_LSB,
+                        bit_count << PIO_PIN_SIDESET_COUNT_LSB);
+    sm_config_set_field(&c->execctrl,
+                        PIO_EXEC_SIDE_EN | PIO_EXEC_SIDE_PINDIR,
+                        (optional ? PIO_EXEC_SIDE_EN : 0)
+                        | (pindirs ? PIO_EXEC_SIDE_PINDIR : 0));
+}
+
+/* Divide clk_sys by div_int + div_frac/256 (div_int 0 means 65536)         */
+static inline void sm_config_set_clkdiv_int_frac(pio_sm_config *c,
+                                                 uint32_t div_int,
+                                                 uint32_t div_frac) {
+    c->clkdiv = (div_int << PIO_CLKDIV_INT_LSB)
+              | (div_frac << PIO_CLKDIV_FRAC_LSB);
+}
+
+/* Nearest divider for the given instruction rate from clk_sys as actually
+   configured                                                               */
+void sm_config_set_clkdiv_hz(pio_sm_config *c, uint32_t hz);
+
+static inline void sm_config_set_jmp_pin(pio_sm_config *c, uint32_t pin) {
+    sm_config_set_field(&c->execctrl, 0x1Fu << PIO_EXEC_JMP_PIN_LSB,
+                        pin << PIO_EXEC_JMP_PIN_LSB);
+}
+
+/* threshold is in bits, 1-32 (32 is encoded as 0)                          */
+static inline void sm_config_set_in_shift(pio_sm_config *c, int shift_right,
+                                          int autopush, uint32_t threshold) {
+    sm_config_set_field(&c->shiftctrl,
+                        PIO_SHIFT_IN_SHIFTDIR | PIO_SHIFT_AUTOPUSH
+                        | (0x1Fu << PIO_SHIFT_PUSH_THRESH_LSB),
+                        (shift_right ? PIO_SHIFT_IN_SHIFTDIR : 0)
+                        | (autopush ? PIO_SHIFT_AUTOPUSH : 0)
+                        | ((threshold & 0x1Fu) << PIO_SHIFT_PUSH_THRESH_LSB));
+}
+
+static inline void sm_config_set_out_shift(pio_sm_config *c, int shift_right,
+                                           int autopull, uint32_t threshold) {
+    sm_config_set_field(&c->shiftctrl,
+                        PIO_SHIFT_OUT_SHIFTDIR | PIO_SHIFT_AUTOPULL
+                        | (0x1Fu << PIO_SHIFT_PULL_THRESH_LSB),
+                        (shift_right ? PIO_SHIFT_OUT_SHIFTDIR : 0)
+                        | (autopull ? PIO_SHIFT_AUTOPULL : 0)
+                        | ((threshold & 0x1Fu) << PIO_SHIFT_PULL_THRESH_LSB));
+}
+
+enum pio_fifo_join {
+    PIO_FIFO_JOIN_NONE = 0,
+    PIO_FIFO_JOIN_TX   = 1,     /* 8-deep TX, no RX                         */
+    PIO_FIFO_JOIN_RX   = 2,     /* 8-deep RX, no TX                         */
+};
+
+static inline void sm_config_set_fifo_join(pio_sm_config *c,
+                                           enum pio_fifo_join join) {
+    sm_config_set_field(&c->shiftctrl,
+                        PIO_SHIFT_FJOIN_TX | PIO_SHIFT_FJOIN_RX,
+                        join == PIO_FIFO_JOIN_TX ? PIO_SHIFT_FJOIN_TX
+                        : join == PIO_FIFO_JOIN_RX ? PIO_SHIFT_FJOIN_RX : 0);
+}
+
+/* ── State machine control ───────────────────────────────────────────────── */
+
+/* Hand a GPIO to PIO block p (still needs its pin direction set)           */
+void pio_gpio_init(uint32_t p, uint32_t pin);
+
+/* Stop the SM, apply config, clear its FIFOs, shift counters and debug
+   flags, restart it and jump to initial_pc. Leaves it disabled.           */
+void pio_sm_init(uint32_t p, uint32_t sm, uint32_t initial_pc,
+                 const pio_sm_config *config);
+
+static inline void pio_sm_set_enabled(uint32_t p, uint32_t sm, int enabled) {
+    if (enabled) {
+        hw_set_bits(&PIO_CTRL(p), 1u << (PIO_CTRL_SM_ENABLE_LSB + sm));
+    } else {
+        hw_clear_bits(&PIO_CTRL(p), 1u << (PIO_CTRL_SM_ENABLE_LSB + sm));
+    }
+}
+
+/* Start several SMs on the same cycle, with their clock dividers in phase  */
+static inline void pio_enable_sm_mask_in_sync(uint32_t p, uint32_t sm_mask) {
+    hw_set_bits(&PIO_CTRL(p), (sm_mask << PIO_CTRL_SM_ENABLE_LSB)
+                              | (sm_mask << PIO_CTRL_CLKDIV_RESTART_LSB));
+}
+
+/* Execute one instruction immediately, ahead of the program               */
+static inline void pio_sm_exec(uint32_t p, uint32_t sm, uint16_t instr) {
+    PIO_SM_INSTR(p, sm) = instr;
+}
+
+/* Set the direction of count consecutive pins from base, using SET PINDIRS
+   on the (stopped or running) SM itself — PIO owns the output enables     */
+void pio_sm_set_consecutive_pindirs(uint32_t p, uint32_t sm, uint32_t base,
+                                    uint32_t count, int out);
+
+/* ── FIFOs ───────────────────────────────────────────────────────────────── */
+static inline int pio_sm_is_tx_fifo_full(uint32_t p, uint32_t sm) {
+    return (PIO_FSTAT(p) >> (PIO_FSTAT_TXFULL_LSB + sm)) & 1u;
+}
+
+static inline int pio_sm_is_rx_fifo_empty(uint32_t p, uint32_t sm) {
+    return (PIO_FSTAT(p) >> (PIO_FSTAT_RXEMPTY_LSB + sm)) & 1u;
+}
+
+static inline void pio_sm_put(uint32_t p, uint32_t sm, uint32_t data) {
+    PIO_TXF(p, sm) = data;
+}
+
+static inline void pio_sm_put_blocking(uint32_t p, uint32_t sm,
+                                       uint32_t data) {
+    while (pio_sm_is_tx_fifo_full(p, sm));
+    PIO_TXF(p, sm) = data;
+}
+
+static inline uint32_t pio_sm_get(uint32_t p, uint32_t sm) {
+    return PIO_RXF(p, sm);
+}
+
+static inline uint32_t pio_sm_get_blocking(uint32_t p, uint32_t sm) {
+    while (pio_sm_is_rx_fifo_empty(p, sm));
+    return PIO_RXF(p, sm);
+}
+
+/* ── DMA ─────────────────────────────────────────────────────────────────────
+   Start channel ch moving count transfers of the given size between memory
+   and an SM's FIFO, paced by the FIFO's DREQ so it never over- or underruns.
+   The channel stays configured: re-arm it for the next buffer with
+   dma_channel_set_read_addr_trigger() / _set_write_addr_trigger().
+   ────────────────────────────────────────────────────────────────────────── */
+void pio_sm_dma_to_tx(uint32_t p, uint32_t sm, uint32_t ch,
+                      const volatile void *src, uint32_t count,
+                      enum dma_size size);
+
+void pio_sm_dma_from_rx(uint32_t p, uint32_t sm, uint32_t ch,
+                        volatile void *dst, uint32_t count,
+                        enum dma_size size);
+
+#endif
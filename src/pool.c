@@ -0,0 +1,179 @@
+#include <stdint.h>
+#include "sync.h"
+#include "print.h"
+#include "pool.h"
+
+/* From linker.ld: the SRAM_BANKn regions, non-striped alias              */
+extern uint8_t _sram_bank0_start, _sram_bank0_end;
+extern uint8_t _sram_bank1_start, _sram_bank1_end;
+extern uint8_t _sram_bank2_start, _sram_bank2_end;
+extern uint8_t _sram_bank3_start, _sram_bank3_end;
+
+static struct arena bank_arenas[SRAM_NUM_BANKS];
+
+static struct arena *arenas;
+static struct pool *pools;
+
+void arena_init(struct arena *a, const char *name, void *base,
+                uint32_t size) {
+    a->name = name;
+    a->base = base;
+    a->size = size;
+    a->used = 0;
+    a->high_water = 0;
+    a->failed = 0;
+
+    spin_lock_t *lock = spin_lock_instance(SPINLOCK_ID_POOL);
+    const uint32_t saved = spin_lock_blocking(lock);
+    a->next = arenas;
+    arenas = a;
+    spin_unlock(lock, saved);
+}
+
+void sram_banks_init(void) {
+    uint8_t *const bounds[SRAM_NUM_BANKS][2] = {
+        { &_sram_bank0_start, &_sram_bank0_end },
+        { &_sram_bank1_start, &_sram_bank1_end },
+        { &_sram_bank2_start, &_sram_bank2_end },
+        { &_sram_bank3_start, &_sram_bank3_end },
+    };
+    static const char *const names[SRAM_NUM_BANKS] = {
+        "sram0", "sram1", "sram2", "sram3",
+    };
+
+    for (uint32_t b = 0; b < SRAM_NUM_BANKS; b++) {
+        arena_init(&bank_arenas[b], names[b], bounds[b][0],
+                   (uint32_t)(bounds[b][1] - bounds[b][0]));
+    }
+}
+
+struct arena *sram_bank_arena(uint32_t bank) {
+    return &bank_arenas[bank];
+}
+
+void *arena_alloc(struct arena *a, uint32_t size, uint32_t align) {
+    spin_lock_t *lock = spin_lock_instance(SPINLOCK_ID_POOL);
+    const uint32_t saved = spin_lock_blocking(lock);
+    void *block = 0;
+
+    /* Align the address, not the offset: base need not be aligned        */
+    const uint32_t addr = (uint32_t)a->base + a->used;
+    const uint32_t start = ((addr + align - 1u) & ~(align - 1u))
+                         - (uint32_t)a->base;
+
+    if (start <= a->size && size <= a->size - start) {
+        block = a->base + start;
+        a->used = start + size;
+        if (a->used > a->high_water) {
+            a->high_water = a->used;
+        }
+    } else {
+        a->failed++;
+    }
+
+    spin_unlock(lock, saved);
+    return block;
+}
+
+void arena_release(struct arena *a, uint32_t mark) {
+    spin_lock_t *lock = spin_lock_instance(SPINLOCK_ID_POOL);
+    const uint32_t saved = spin_lock_blocking(lock);
+    if (mark < a->used) {
+        a->used = mark;
+    }
+    spin_unlock(lock, saved);
+}
+
+int pool_init(struct pool *p, const char *name, struct arena *a,
+              uint32_t block_size, uint32_t count) {
+    block_size = (block_size + 3u) & ~3u;
+    if (block_size < sizeof(void *)) {
+        block_size = sizeof(void *);
+    }
+
+    uint8_t *storage = arena_alloc(a, block_size * count, 8u);
+    if (!storage) {
+        return -1;
+    }
+
+    /* Thread the free list through the blocks, lowest address first      */
+    void *free_list = 0;
+    for (uint32_t i = count; i-- > 0; ) {
+        void **block = (void **)(storage + i * block_size);
+        *block = free_list;
+        free_list = block;
+    }
+
+    p->name = name;
+    p->free_list = free_list;
+    p->block_size = block_size;
+    p->count = count;
+    p->in_use = 0;
+    p->high_water = 0;
+    p->failed = 0;
+
+    spin_lock_t *lock = spin_lock_instance(SPINLOCK_ID_POOL);
+    const uint32_t saved = spin_lock_blocking(lock);
+    p->next = pools;
+    pools = p;
+    spin_unlock(lock, saved);
+    return 0;
+}
+
+void *pool_alloc(struct pool *p) {
+    spin_lock_t *lock = spin_lock_instance(SPINLOCK_ID_POOL);
+    const uint32_t saved = spin_lock_blocking(lock);
+
+    void **block = p->free_list;
+    if (block) {
+        p->free_list = *block;
+        if (++p->in_use > p->high_water) {
+            p->high_water = p->in_use;
+        }
+    } else {
+        p->failed++;
+    }
+
+    spin_unlock(lock, saved);
+    return block;
+}
+
+void pool_free(struct pool *p, void *block) {
+    spin_lock_t *lock = spin_lock_instance(SPINLOCK_ID_POOL);
+    const uint32_t saved = spin_lock_blocking(lock);
+    *(void **)block = p->free_list;
+    p->free_list = block;
+    p->in_use--;
+    spin_unlock(lock, saved);
+}
+
+void pool_report(putc_fn out) {
+    for (const struct arena *a = arenas; a; a = a->next) {
+        print_str(out, "A ");
+        print_str(out, a->name);
+        print_str(out, " used=");
+        print_dec(out, a->used);
+        print_str(out, " high=");
+        print_dec(out, a->high_water);
+        print_str(out, " size=");
+        print_dec(out, a->size);
+        print_str(out, " failed=");
+        print_dec(out, a->failed);
+        print_str(out, "\r\n");
+    }
+    for (const struct pool *p = pools; p; p = p->next) {
+        print_str(out, "P ");
+        print_str(out, p->name);
+        print_str(out, " block=");
+        print_dec(out, p->block_size);
+        print_str(out, " in_use=");
+        print_dec(out, p->in_use);
+        print_str(out, " high=");
+        print_dec(out, p->high_water);
+        print_str(out, " count=");
+        print_dec(out, p->count);
+        print_str(out, " failed=");
+        print_dec(out, p->failed);
+        print_str(out, "\r\n");
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdint.h>
+#include "print.h"
+
+/* ── Arenas and pools ────────────────────────────────────────────────────────
+   There is still no heap. Memory that used to be hand-sized static arrays
+   can instead come from one of two allocators, each with usage counters so
+   buffers can be sized from what a run actually needed:
+
+   arena   a bump allocator over a fixed region. Allocation moves a pointer;
+           nothing is freed individually, but arena_release() rolls back to
+           an earlier arena_mark() (per-frame scratch, init-time buffers).
+   pool    fixed-size blocks carved from an arena once, handed out and
+           returned through an intrusive free list. Both operations are
+           O(1), and being all one size the blocks cannot fragment.
+
+   Four arenas come ready-made, one per striped SRAM bank: 7 KiB near the
+   top of each of SRAM0-3 (the last 1 KiB carries core 0's stack), which
+   linker.ld keeps out of RAM and exposes through the non-striped alias at
+   0x21000000 (SRAM_BANKn). In the striped RAM every bank holds every
+   fourth word, so all data is spread over all banks; a buffer in
+   SRAM_BANKn touches only bank n. Give each core and each busy
+   DMA stream a bank of its own and they never wait for each other on the
+   bus fabric.
+
+   Everything here is safe from either core and from interrupts: each
+   operation takes SPINLOCK_ID_POOL for a few loads and stores. Memory is
+   not zeroed.
+   ────────────────────────────────────────────────────────────────────────── */
+#define SRAM_NUM_BANKS          4u
+
+struct arena {
+    const char *name;
+    uint8_t *base;
+    uint32_t size;
+    uint32_t used;
+    uint32_t high_water;            /* most ever used                       */
+    uint32_t failed;                /* allocations that did not fit         */
+    struct arena *next;             /* pool_report() list                   */
+};
+
+struct pool {
+    const char *name;
+    void *free_list;                /* first word of a free block: the next */
+    uint32_t block_size;
+    uint32_t count;
+    uint32_t in_use;
+    uint32_t high_water;            /* most blocks ever out at once         */
+    uint32_t failed;                /* pool_alloc() calls that got 0        */
+    struct pool *next;
+};
+
+/* Set up the per-bank arenas from linker.ld. Call once, before the banks
+   are used.                                                               */
+void sram_banks_init(void);
+
+/* The arena over SRAM_BANKn                                               */
+struct arena *sram_bank_arena(uint32_t bank);
+
+/* An arena over any other region, e.g. a static array                     */
+void arena_init(struct arena *a, const char *name, void *base, uint32_t size);
+
+/* size bytes aligned to align (a power of two), or 0                      */
+void *arena_alloc(struct arena *a, uint32_t size, uint32_t align);
+
+/* Everything allocated after a mark is given back by releasing to it      */
+static inline uint32_t arena_mark(const struct arena *a) {
+    return a->used;
+}
+
+void arena_release(struct arena *a, uint32_t mark);
+
+/* Take count blocks of block_size bytes (rounded up to a word) from a.
+   0 or -1 if the arena is too small.                                      */
+int  pool_init(struct pool *p, const char *name, struct arena *a,
+               uint32_t block_size, uint32_t count);
+
+/* A block, or 0 if all are in use                                         */
+void *pool_alloc(struct pool *p);
+
+void pool_free(struct pool *p, void *block);
+
+/* One line per arena and pool:
+       A name used= high= size= failed=
+       P name block= in_use= high= count= failed=                          */
+void pool_report(putc_fn out);
+
+#endif
@@ -0,0 +1,47 @@
+#include <stdint.h>
+#include "print.h"
+
+void print_str(putc_fn out, const char *s) {
+    while (*s) {
+        out(*s++);
+    }
+}
+
+/* Writes the digits of value backwards into buf, returns how many           */
+static uint32_t format_dec(char *buf, uint32_t value) {
+    uint32_t n = 0;
+
+    do {
+        buf[n++] = (char)('0' + value % 10u);
+        value /= 10u;
+    } while (value);
+
+    return n;
+}
+
+void print_dec(putc_fn out, uint32_t value) {
+    print_dec_width(out, value, 0);
+}
+
+void print_dec_width(putc_fn out, uint32_t value, uint32_t width) {
+    char buf[10];                   /* 4294967295 has 10 digits              */
+    uint32_t n = format_dec(buf, value);
+
+    while (width > n) {
+        out(' ');
+        width--;
+    }
+    while (n) {
+        out(buf[--n]);
+    }
+}
+
+void print_hex(putc_fn out, uint32_t value) {
+    static const char digits[] = "0123456789abcdef";
+
+    out('0');
+    out('x');
+    for (int shift = 28; shift >= 0; shift -= 4) {
+        out(digits[(value >> shift) & 0xFu]);
+    }
+}
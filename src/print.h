@@ -0,0 +1,25 @@
+#ifndef PRINT_H
+#define PRINT_H
+
+#include <stdint.h>
+
+/* ── Minimal text output ─────────────────────────────────────────────────────
+   There is no libc, so no printf. Reports (boot timeline, profiles, crash
+   records) are written through these helpers to whatever character sink
+   the caller passes in: a UART, a RAM buffer, a semihosting hook.
+   Deliberately tiny — everything is unsigned and there is no format string.
+   ────────────────────────────────────────────────────────────────────────── */
+typedef void (*putc_fn)(char c);
+
+void print_str(putc_fn out, const char *s);
+
+/* Unsigned decimal, no padding                                              */
+void print_dec(putc_fn out, uint32_t value);
+
+/* Unsigned decimal right-aligned in a field of the given width              */
+void print_dec_width(putc_fn out, uint32_t value, uint32_t width);
+
+/* "0x" followed by exactly 8 hex digits                                     */
+void print_hex(putc_fn out, uint32_t value);
+
+#endif
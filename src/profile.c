@@ -0,0 +1,172 @@
+#include <stdint.h>
+#include "rp2040.h"
+#include "clocks.h"
+#include "irq.h"
+#include "timer.h"
+#include "print.h"
+#include "profile.h"
+
+#if PROFILE
+
+#if !RAM_VECTOR_TABLE
+#error "the sampling profiler installs its handler at runtime and needs RAM_VECTOR_TABLE=1"
+#endif
+
+#define ALARM_MASK          (1u << PROFILE_SAMPLER_ALARM)
+#define SAMPLE_INDEX_MASK   (PROFILE_SAMPLE_BUFFER - 1u)
+#define SAMPLE_JITTER_MASK  63u         /* up to 63 µs added per interval   */
+
+_Static_assert((PROFILE_SAMPLE_BUFFER & SAMPLE_INDEX_MASK) == 0,
+               "PROFILE_SAMPLE_BUFFER must be a power of two");
+
+/* In profile_entry.S: finds the interrupted frame, then calls
+   profile_sampler_frame() with it                                          */
+extern void profile_sampler_isr(void);
+
+static struct profile_counter *counters;
+static uint32_t cycles_per_us;
+static uint32_t systick_max_us;     /* longest interval SysTick can time    */
+
+volatile uint32_t profile_sample_count;
+uint32_t profile_samples[PROFILE_SAMPLE_BUFFER];
+
+static uint32_t sample_interval_us;
+static uint32_t next_sample_us;
+static uint32_t jitter_state = 0x2545F491u;
+
+void profile_init(void) {
+    if (!(SYST_CSR & SYST_CSR_ENABLE)) {
+        SYST_RVR = SYST_CVR_MASK;
+        SYST_CVR = 0;
+        SYST_CSR = SYST_CSR_CLKSOURCE | SYST_CSR_ENABLE;
+    }
+
+    cycles_per_us = clock_get_hz(CLK_SYS) / 1000000u;
+
+    /* One wrap is (RVR + 1) cycles. Keep two microseconds of margin for
+       the TIMER reads not being simultaneous with the SysTick reads.       */
+    systick_max_us = (SYST_RVR + 1u) / cycles_per_us - 2u;
+}
+
+void profile_end(struct profile_counter *c) {
+    const uint32_t end_cvr = SYST_CVR;
+    const uint32_t end_us  = time_us_32();
+    const uint32_t elapsed_us = end_us - c->start_us;
+    uint32_t cycles;
+
+    if (elapsed_us < systick_max_us) {
+        /* Down-counter: start - end, corrected for at most one reload      */
+        cycles = c->start_cvr - end_cvr;
+        if (end_cvr > c->start_cvr) {
+            cycles += SYST_RVR + 1u;
+        }
+    } else {
+        cycles = elapsed_us * cycles_per_us;
+    }
+
+    c->calls++;
+    c->total_cycles += cycles;
+    if (cycles < c->min_cycles) {
+        c->min_cycles = cycles;
+    }
+    if (cycles > c->max_cycles) {
+        c->max_cycles = cycles;
+    }
+
+    if (!c->registered) {
+        const uint32_t primask = save_and_disable_interrupts();
+        c->next = counters;
+        counters = c;
+        c->registered = 1;
+        restore_interrupts(primask);
+    }
+}
+
+/* Program the alarm for the next sample. The alarm is an equality match,
+   so if the deadline has already gone by, move it out and try again.       */
+static void sampler_arm_next(void) {
+    jitter_state ^= jitter_state << 13;
+    jitter_state ^= jitter_state >> 17;
+    jitter_state ^= jitter_state << 5;
+
+    next_sample_us += sample_interval_us + (jitter_state & SAMPLE_JITTER_MASK);
+    TIMER_ALARM(PROFILE_SAMPLER_ALARM) = next_sample_us;
+
+    while ((int32_t)(next_sample_us - time_us_32()) <= 0) {
+        next_sample_us = time_us_32() + sample_interval_us;
+        TIMER_ALARM(PROFILE_SAMPLER_ALARM) = next_sample_us;
+    }
+}
+
+/* frame points at the exception frame the hardware stacked for whatever
+   was interrupted: r0, r1, r2, r3, r12, lr, pc, xPSR                       */
+void profile_sampler_frame(const uint32_t *frame) {
+    TIMER_INTR = ALARM_MASK;
+
+    const uint32_t n = profile_sample_count;
+    profile_samples[n & SAMPLE_INDEX_MASK] = frame[6];
+    profile_sample_count = n + 1;
+
+    sampler_arm_next();
+}
+
+void profile_sampler_start(uint32_t interval_us) {
+    sample_interval_us = interval_us;
+
+    irq_set_handler(TIMER_IRQ_1, profile_sampler_isr);
+    irq_set_priority(TIMER_IRQ_1, IRQ_PRIORITY_HIGHEST);
+
+    TIMER_INTR = ALARM_MASK;
+    TIMER_INTE_SET = ALARM_MASK;
+    irq_set_enabled(TIMER_IRQ_1, 1);
+
+    const uint32_t primask = save_and_disable_interrupts();
+    next_sample_us = time_us_32();
+    sampler_arm_next();
+    restore_interrupts(primask);
+}
+
+void profile_sampler_stop(void) {
+    irq_set_enabled(TIMER_IRQ_1, 0);
+    TIMER_INTE_CLR = ALARM_MASK;
+    TIMER_ARMED = ALARM_MASK;
+    TIMER_INTR = ALARM_MASK;
+}
+
+void profile_dump(putc_fn out) {
+    print_str(out, "profile counters\r\n");
+
+    for (const struct profile_counter *c = counters; c; c = c->next) {
+        print_str(out, "C ");
+        print_str(out, c->name);
+        print_str(out, " calls=");
+        print_dec(out, c->calls);
+        print_str(out, " min=");
+        print_dec(out, c->min_cycles);
+        print_str(out, " max=");
+        print_dec(out, c->max_cycles);
+        print_str(out, " mean=");
+        print_dec(out, (uint32_t)(c->total_cycles / c->calls));
+        print_str(out, " total_kcyc=");
+        print_dec(out, (uint32_t)(c->total_cycles / 1000u));
+        print_str(out, "\r\n");
+    }
+
+    const uint32_t count = profile_sample_count;
+    const uint32_t first = count > PROFILE_SAMPLE_BUFFER
+                         ? count - PROFILE_SAMPLE_BUFFER : 0;
+
+    print_str(out, "profile samples ");
+    print_dec(out, count - first);
+    print_str(out, " of ");
+    print_dec(out, count);
+    print_str(out, "\r\n");
+
+    for (uint32_t i = first; i < count; i++) {
+        print_str(out, "S ");
+        print_hex(out, profile_samples[i & SAMPLE_INDEX_MASK]);
+        print_str(out, "\r\n");
+    }
+}
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+#include "rp2040.h"
+#include "timer.h"
+#include "print.h"
+
+/* ── Profiling ───────────────────────────────────────────────────────────────
+   make PROFILE=1 enables two tools; with PROFILE=0 (the default) all of the
+   macros below compile to nothing.
+
+   Scoped cycle counters
+       PROFILE_COUNTER(ctl_loop, "ctl_loop");
+       ...
+       PROFILE_BEGIN(ctl_loop);
+       run_control_step();
+       PROFILE_END(ctl_loop);
+
+   The Cortex-M0+ has no DWT cycle counter. SysTick, free-running over its
+   full 24-bit range (main()'s systick_init()), stands in for one: exact to
+   the cycle, but it wraps every ~134 ms at 125 MHz. Each scope therefore
+   also samples the 64-bit TIMER, and an interval too long for SysTick is
+   converted from microseconds instead. Intervals include ~10 cycles of
+   measurement overhead.
+
+   A counter is not reentrant: do not nest it inside itself, or use the same
+   one from an interrupt and from the code it interrupts.
+
+   Sampling profiler
+       profile_sampler_start(1000);    // ~1 kHz
+
+   TIMER alarm 1 interrupts at the given interval (with a little random
+   jitter, so a periodic workload cannot hide between samples), at the
+   highest priority so it lands inside other handlers too, and records the
+   PC it interrupted into a ring buffer. profile_dump() prints the samples;
+   tools/profile_symbolize.py turns them into a per-function histogram
+   using the ELF or the map file.
+   ────────────────────────────────────────────────────────────────────────── */
+#ifndef PROFILE
+#define PROFILE 0
+#endif
+
+#define PROFILE_SAMPLER_ALARM   1u
+#define PROFILE_SAMPLE_BUFFER   1024u   /* PCs kept, oldest overwritten     */
+
+struct profile_counter {
+    const char *name;
+    struct profile_counter *next;       /* list of every counter used       */
+    uint32_t calls;
+    uint32_t min_cycles;
+    uint32_t max_cycles;
+    uint64_t total_cycles;
+    uint32_t start_cvr;
+    uint32_t start_us;
+    uint8_t registered;
+};
+
+#if PROFILE
+
+#define PROFILE_COUNTER(var, label) \
+    static struct profile_counter var = { .name = (label), \
+                                          .min_cycles = 0xFFFFFFFFu }
+
+#define PROFILE_BEGIN(var)  profile_begin(&(var))
+#define PROFILE_END(var)    profile_end(&(var))
+
+/* Both timestamps, SysTick last so it is closest to the measured code      */
+static inline void profile_begin(struct profile_counter *c) {
+    c->start_us  = time_us_32();
+    c->start_cvr = SYST_CVR;
+}
+
+void profile_end(struct profile_counter *c);
+
+/* Samples recorded so far; samples[] holds the newest PROFILE_SAMPLE_BUFFER
+   of them, at index (n % PROFILE_SAMPLE_BUFFER)                            */
+extern volatile uint32_t profile_sample_count;
+extern uint32_t profile_samples[PROFILE_SAMPLE_BUFFER];
+
+/* Start SysTick free-running if nobody has, and note clk_sys for the
+   microsecond fallback. Call once after clocks and timer are up.           */
+void profile_init(void);
+
+/* Needs RAM_VECTOR_TABLE: the sampler installs its own alarm 1 handler     */
+void profile_sampler_start(uint32_t interval_us);
+void profile_sampler_stop(void);
+
+/* Every counter, then every buffered sample as "S 0x........" lines       */
+void profile_dump(putc_fn out);
+
+#else
+
+#define PROFILE_COUNTER(var, label) \
+    static struct profile_counter var __attribute__((unused))
+#define PROFILE_BEGIN(var)  ((void)0)
+#define PROFILE_END(var)    ((void)0)
+
+static inline void profile_init(void) {}
+static inline void profile_sampler_start(uint32_t interval_us) {
+    (void)interval_us;
+}
+static inline void profile_sampler_stop(void) {}
+static inline void profile_dump(putc_fn out) { (void)out; }
+
+#endif
+
+#endif
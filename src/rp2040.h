@@ -0,0 +1,216 @@
+#ifndef RP2040_H
+#define RP2040_H
+
+#include <stdint.h>
+
+/* ── Why volatile on every hardware register ──────────────────────────────────
+   The compiler optimises C code by caching values in registers and reordering
+   reads and writes. That is fine for normal variables.
+
+   But hardware registers are different — reading or writing them triggers
+   physical side effects the compiler cannot see. A write to GPIO_OUT_XOR
+   toggles a real pin. A read of RESETS_RESET_DONE checks real hardware state.
+
+   Without volatile the compiler might:
+   - Skip a write because "nobody reads that variable"
+   - Hoist a read out of a loop because "the value never changes in C"
+   - Reorder writes because "order doesn't matter for unrelated variables"
+
+   volatile forces the compiler to emit every read and write exactly where
+   you wrote it, in order, with no caching. Non-negotiable for MMIO.
+   ────────────────────────────────────────────────────────────────────────── */
+#ifndef HOST_SIM
+#define HOST_SIM 0
+#endif
+
+#if HOST_SIM
+/* make host: the modules it builds run on the development machine, their
+   registers plain memory in host/mmio.c — see there for what is modelled */
+volatile uint32_t *host_mmio(uintptr_t addr);
+#define MMIO32(addr)   (*host_mmio((uintptr_t)(addr)))
+#else
+#define MMIO32(addr)   (*((volatile uint32_t*)(addr)))
+#endif
+
+/* ── Atomic register aliases ─────────────────────────────────────────────────
+   The RP2040 has a clever feature: every APB/AHB peripheral register has
+   three extra aliases at +0x1000 (XOR), +0x2000 (atomic SET), +0x3000
+   (atomic CLR). Writing to the CLR alias clears only the bits you specify —
+   no read-modify-write needed, which avoids race conditions with interrupts.
+   (SIO and the Cortex-M0+ PPB registers do NOT have these aliases.)
+   ────────────────────────────────────────────────────────────────────────── */
+#define REG_ALIAS_XOR       0x1000u
+#define REG_ALIAS_SET       0x2000u
+#define REG_ALIAS_CLR       0x3000u
+
+/* ── Register access helpers ─────────────────────────────────────────────────
+   The aliases as functions of the register itself, so a driver never
+   computes "+ 0x2000" by hand. Each is one str to the alias address; the
+   compiler folds the address when the register is a constant.
+
+       hw_set_bits(&CLK_CTRL(CLK_ADC), CLK_CTRL_ENABLE);
+       hw_write_masked(&PADS_GPIO(pin), FIELD_PREP(PADS_DRIVE, 3),
+                       PADS_DRIVE_MASK);
+
+   hw_write_masked() changes a multi-bit field with one load and one store
+   through XOR: only the bits that differ from the new value flip, so other
+   bits of the register cannot be lost to an interrupt (or the other core)
+   writing them in between, as a read-modify-write could.
+
+   Only for registers that have the aliases: not SIO, not the PPB (NVIC,
+   SysTick, SCB) — there these addresses are different registers or none.
+
+   The host build's mock registers have no aliases, so there the helpers
+   modify the register itself.
+   ────────────────────────────────────────────────────────────────────────── */
+static inline __attribute__((always_inline))
+void hw_set_bits(volatile uint32_t *reg, uint32_t mask) {
+#if HOST_SIM
+    *reg |= mask;
+#else
+    MMIO32((uintptr_t)reg + REG_ALIAS_SET) = mask;
+#endif
+}
+
+static inline __attribute__((always_inline))
+void hw_clear_bits(volatile uint32_t *reg, uint32_t mask) {
+#if HOST_SIM
+    *reg &= ~mask;
+#else
+    MMIO32((uintptr_t)reg + REG_ALIAS_CLR) = mask;
+#endif
+}
+
+static inline __attribute__((always_inline))
+void hw_xor_bits(volatile uint32_t *reg, uint32_t mask) {
+#if HOST_SIM
+    *reg ^= mask;
+#else
+    MMIO32((uintptr_t)reg + REG_ALIAS_XOR) = mask;
+#endif
+}
+
+static inline __attribute__((always_inline))
+void hw_write_masked(volatile uint32_t *reg, uint32_t value, uint32_t mask) {
+    hw_xor_bits(reg, (*reg ^ value) & mask);
+}
+
+/* ── Barriers and sleep hints ────────────────────────────────────────────────
+   dmb:  memory accesses before it are seen by other bus masters (the other
+         core, DMA) before any after it; also a compiler barrier
+   dsb:  dmb, and wait for them to complete — before relying on a write to
+         a system register (VTOR, MPU) having taken effect
+   sev:  set the event register of both cores, waking a wfe
+   wfe:  sleep until an event (or an interrupt); returns at once, clearing
+         it, if the event register was already set
+   wfi:  sleep until an interrupt is pending
+
+   On the host build the barriers are a full fence and the hints nothing:
+   code that waits with them re-checks its condition anyway.
+   ────────────────────────────────────────────────────────────────────────── */
+static inline __attribute__((always_inline)) void cpu_dmb(void) {
+#if HOST_SIM
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+#else
+    __asm volatile ("dmb" ::: "memory");
+#endif
+}
+
+static inline __attribute__((always_inline)) void cpu_dsb(void) {
+#if HOST_SIM
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+#else
+    __asm volatile ("dsb" ::: "memory");
+#endif
+}
+
+static inline __attribute__((always_inline)) void cpu_sev(void) {
+#if !HOST_SIM
+    __asm volatile ("sev");
+#endif
+}
+
+static inline __attribute__((always_inline)) void cpu_wfe(void) {
+#if !HOST_SIM
+    __asm volatile ("wfe");
+#endif
+}
+
+static inline __attribute__((always_inline)) void cpu_wfi(void) {
+#if !HOST_SIM
+    __asm volatile ("wfi");
+#endif
+}
+
+/* Fields are described by a NAME_LSB and a NAME_MASK (already shifted):
+   FIELD_PREP builds a field value to write, FIELD_GET extracts one from a
+   register value. Both are constant expressions given constant inputs.    */
+#define FIELD_PREP(name, v) (((uint32_t)(v) << name##_LSB) & name##_MASK)
+#define FIELD_GET(name, r)  (((uint32_t)(r) & name##_MASK) >> name##_LSB)
+
+/* ── RESETS ──────────────────────────────────────────────────────────────────
+   On the RP2040, every peripheral starts held in reset after power-on.
+   You must explicitly release a peripheral from reset before using it.
+   A bit set in RESET holds that block in reset; RESET_DONE reports which
+   blocks have actually come out of it.
+   ────────────────────────────────────────────────────────────────────────── */
+#define RESETS_BASE         0x4000C000u
+#define RESETS_RESET        MMIO32(RESETS_BASE + 0x000)  /* reset control    */
+#define RESETS_RESET_SET    MMIO32(RESETS_BASE + 0x2000) /* atomic set       */
+#define RESETS_RESET_CLR    MMIO32(RESETS_BASE + 0x3000) /* atomic clear     */
+#define RESETS_RESET_DONE   MMIO32(RESETS_BASE + 0x008)  /* reset status     */
+
+#define RESET_IO_BANK0      (1u << 5)
+#define RESET_PADS_BANK0    (1u << 8)
+#define RESET_PLL_SYS       (1u << 12)
+#define RESET_PLL_USB       (1u << 13)
+
+/* Hold the given blocks in reset, then release them and wait until the
+   hardware confirms they are out. Used to bring a block up from a known
+   state regardless of what the bootrom left behind.                         */
+static inline void reset_block(uint32_t mask) {
+    RESETS_RESET_SET = mask;
+}
+
+static inline void unreset_block_wait(uint32_t mask) {
+    RESETS_RESET_CLR = mask;
+    while ((RESETS_RESET_DONE & mask) != mask);
+}
+
+/* ── SIO ─────────────────────────────────────────────────────────────────────
+   Single-cycle I/O: GPIO, the inter-core FIFOs, spinlocks and the integer
+   dividers. Each core sees its own copy of the per-core registers at the
+   same addresses. CPUID reads 0 on core 0 and 1 on core 1.
+   ────────────────────────────────────────────────────────────────────────── */
+#define NUM_CORES           2u
+
+#define SIO_BASE            0xD0000000u
+#define SIO_CPUID           MMIO32(SIO_BASE + 0x000)
+
+static inline uint32_t get_core_num(void) {
+    return SIO_CPUID;
+}
+
+/* ── SysTick ─────────────────────────────────────────────────────────────────
+   SysTick is a 24-bit countdown timer built into every Cortex-M core.
+   It is identical on every Cortex-M chip — learning it here transfers
+   directly to STM32, NXP, Nordic, and every other Cortex-M product.
+   
+   RVR: Reload Value Register — when counter hits 0, it reloads this value
+   CVR: Current Value Register — writing any value resets the counter
+   CSR: Control and Status Register
+        bit 0 (ENABLE)    — start/stop the timer
+        bit 1 (TICKINT)   — fire SysTick_Handler when counter hits 0
+        bit 2 (CLKSOURCE) — 1 = use processor clock, 0 = external ref clock
+   Like the NVIC, each core has its own SysTick at the same address.
+   ────────────────────────────────────────────────────────────────────────── */
+#define SYST_CSR            MMIO32(0xE000E010)
+#define SYST_RVR            MMIO32(0xE000E014)
+#define SYST_CVR            MMIO32(0xE000E018)
+
+#define SYST_CSR_ENABLE     (1u << 0)
+#define SYST_CSR_TICKINT    (1u << 1)
+#define SYST_CSR_CLKSOURCE  (1u << 2)
+#define SYST_CVR_MASK       0x00FFFFFFu    /* the counter is 24 bits wide   */
+
+#endif
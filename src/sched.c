@@ -0,0 +1,285 @@
+#include <stdint.h>
+#include "rp2040.h"
+#include "irq.h"
+#include "sections.h"
+#include "swtimer.h"
+#include "sched.h"
+
+/* ICSR.PENDSVSET: pend a PendSV exception from software                    */
+#define SCB_ICSR            MMIO32(0xE000ED04)
+#define SCB_ICSR_PENDSVSET  (1u << 28)
+
+/* Initial xPSR: only the Thumb bit. Clearing it would fault on return.     */
+#define TASK_INITIAL_XPSR   0x01000000u
+
+/* r4-r11 saved by sched_switch.S + r0-r3, r12, lr, pc, xPSR by hardware   */
+#define TASK_FRAME_WORDS    16u
+
+/* Idle needs room for one exception frame plus what PendSV saves          */
+#define IDLE_STACK_WORDS    64u
+
+_Static_assert(SCHED_MAX_TASKS + 1u <= 32u,
+               "task_mutex keeps its waiters in a 32-bit mask");
+
+/* The user tasks, then idle in the extra slot                              */
+static struct task *tasks[SCHED_MAX_TASKS + 1u];
+static uint32_t task_count;
+static uint32_t current_index;
+static struct task *current;
+static uint32_t switch_count;
+static int running;
+
+static struct task idle_task;
+static uint32_t idle_stack[IDLE_STACK_WORDS] __attribute__((aligned(8)));
+
+static void pend_switch(void) {
+    if (running) {
+        SCB_ICSR = SCB_ICSR_PENDSVSET;
+    }
+}
+
+/* Where a task's entry function returns to — its initial lr                */
+static void task_exit(void) {
+    const uint32_t primask = save_and_disable_interrupts();
+    current->state = TASK_DONE;
+    pend_switch();
+    restore_interrupts(primask);
+
+    while (1);      /* not reached: PendSV switches away and never back    */
+}
+
+static void idle_entry(void *arg) {
+    (void)arg;
+
+    while (1) {
+        cpu_wfi();
+    }
+}
+
+static void task_init(struct task *task, const char *name,
+                      task_entry_t entry, void *arg, uint32_t *stack,
+                      uint32_t stack_words, uint8_t priority) {
+    for (uint32_t i = 0; i < stack_words; i++) {
+        stack[i] = TASK_STACK_PAINT;
+    }
+
+    /* Exception entry needs an 8-byte aligned frame; round the top down   */
+    uint32_t *sp = (uint32_t *)((uintptr_t)(stack + stack_words)
+                                & ~(uintptr_t)7u);
+    sp -= TASK_FRAME_WORDS;
+
+    /* The frame sched_switch.S pops on the first switch in: r4-r11, then
+       what the hardware unstacks on exception return                       */
+    for (uint32_t i = 0; i < 8; i++) {
+        sp[i] = 0;                              /* r4-r11                   */
+    }
+    sp[8]  = (uint32_t)(uintptr_t)arg;          /* r0: the entry argument   */
+    sp[9]  = 0;                                 /* r1                       */
+    sp[10] = 0;                                 /* r2                       */
+    sp[11] = 0;                                 /* r3                       */
+    sp[12] = 0;                                 /* r12                      */
+    sp[13] = (uint32_t)(uintptr_t)task_exit;    /* lr                       */
+    sp[14] = (uint32_t)(uintptr_t)entry & ~1u;  /* pc, without the Thumb bit */
+    sp[15] = TASK_INITIAL_XPSR;
+
+    task->sp          = sp;
+    task->stack_base  = stack;
+    task->stack_words = stack_words;
+    task->name        = name;
+    task->priority    = priority;
+    task->notified    = 0;
+    task->wait_mask   = 0;
+    task->state       = TASK_READY;
+}
+
+int task_create(struct task *task, const char *name, task_entry_t entry,
+                void *arg, uint32_t *stack, uint32_t stack_words,
+                uint8_t priority) {
+    if (running || task_count >= SCHED_MAX_TASKS) {
+        return -1;
+    }
+    task_init(task, name, entry, arg, stack, stack_words, priority);
+    tasks[task_count++] = task;
+    return 0;
+}
+
+/* Highest-priority ready task. The scan starts just after the current task
+   and keeps the first of equal priority, so equals take turns.            */
+static uint32_t TIME_CRITICAL pick_next(void) {
+    uint32_t best = current_index;
+    uint32_t best_priority = 256;
+    uint32_t i = current_index;
+
+    for (uint32_t n = 0; n < task_count; n++) {
+        if (++i == task_count) {
+            i = 0;
+        }
+        if (tasks[i]->state == TASK_READY
+                && tasks[i]->priority < best_priority) {
+            best = i;
+            best_priority = tasks[i]->priority;
+        }
+    }
+
+    return best;
+}
+
+/* Called by PendSV_Handler with the outgoing task's stack pointer (r4-r11
+   already pushed). Returns the stack pointer of the task to resume.
+   In RAM with its caller, so a switch never waits on an XIP miss.          */
+uint32_t * TIME_CRITICAL sched_switch(uint32_t *sp) {
+    const uint32_t primask = save_and_disable_interrupts();
+
+    current->sp = sp;
+    const uint32_t next = pick_next();
+    if (next != current_index) {
+        current_index = next;
+        current = tasks[next];
+        switch_count++;
+        stack_guard_task(current->stack_base, current->stack_words);
+    }
+
+    restore_interrupts(primask);
+    return current->sp;
+}
+
+/* Called by SVC_Handler to pick the first task and find its frame. Here
+   rather than in sched_start(), because nothing may pend PendSV before
+   the switch to PSP. SVCall is left at its reset priority, 0, so no
+   interrupt preempts SVC_Handler; one that is taken after it sees
+   running set and a task on PSP, and a switch it pends is a normal one. */
+uint32_t *sched_first_task_sp(void) {
+    current_index = task_count - 1;
+    current_index = pick_next();
+    current = tasks[current_index];
+    stack_guard_task(current->stack_base, current->stack_words);
+    running = 1;
+    return current->sp;
+}
+
+void sched_start(void) {
+    task_init(&idle_task, "idle", idle_entry, 0,
+              idle_stack, IDLE_STACK_WORDS, SCHED_PRIORITY_IDLE);
+    tasks[task_count++] = &idle_task;
+
+    /* PendSV below every interrupt: a switch is only ever done once all
+       handlers have returned, never in the middle of one                   */
+    irq_set_priority(PENDSV_IRQn, IRQ_PRIORITY_LOWEST);
+
+#if HOST_SIM
+    /* No exceptions on the host: the test plays SVC here, and PendSV by
+       calling sched_switch() itself whenever SCB_ICSR says one is pending */
+    sched_first_task_sp();
+#else
+    __asm volatile ("svc 0");
+
+    while (1);      /* not reached                                          */
+#endif
+}
+
+struct task *task_current(void) {
+    return current;
+}
+
+void task_yield(void) {
+    pend_switch();
+}
+
+uint32_t task_wait(uint32_t mask) {
+    struct task *self = current;
+
+    while (1) {
+        const uint32_t primask = save_and_disable_interrupts();
+        const uint32_t got = self->notified & mask;
+
+        if (got) {
+            self->notified &= ~got;
+            restore_interrupts(primask);
+            return got;
+        }
+
+        self->wait_mask = mask;
+        self->state = TASK_BLOCKED;
+        pend_switch();
+
+        /* PendSV is taken here, as soon as interrupts are unmasked. We come
+           back once task_notify() has made us ready again — or straight
+           away if a notification slipped in first; either way, re-check.   */
+        restore_interrupts(primask);
+    }
+}
+
+void task_notify(struct task *task, uint32_t bits) {
+    const uint32_t primask = save_and_disable_interrupts();
+
+    task->notified |= bits;
+    if (task->state == TASK_BLOCKED && (task->notified & task->wait_mask)) {
+        task->state = TASK_READY;
+        if (task->priority < current->priority) {
+            pend_switch();
+        }
+    }
+
+    restore_interrupts(primask);
+}
+
+static void sleep_expired(struct swtimer *timer) {
+    task_notify((struct task *)timer->user_data, TASK_NOTIFY_SLEEP);
+}
+
+void task_sleep_us(uint32_t us) {
+    struct task *self = current;
+
+    swtimer_start(&self->sleep_timer, us, 0, sleep_expired, self);
+    task_wait(TASK_NOTIFY_SLEEP);
+}
+
+void task_mutex_lock(struct task_mutex *m) {
+    while (1) {
+        const uint32_t primask = save_and_disable_interrupts();
+        if (!m->locked) {
+            m->locked = 1;
+            restore_interrupts(primask);
+            return;
+        }
+        m->waiters |= 1u << current_index;
+        restore_interrupts(primask);
+
+        /* An unlock between the two is not lost: its notification stays
+           pending and task_wait() returns at once                         */
+        task_wait(TASK_NOTIFY_MUTEX);
+    }
+}
+
+void task_mutex_unlock(struct task_mutex *m) {
+    const uint32_t primask = save_and_disable_interrupts();
+    const uint32_t waiters = m->waiters;
+
+    m->locked = 0;
+    m->waiters = 0;
+    for (uint32_t i = 0; i < task_count; i++) {
+        if (waiters & (1u << i)) {
+            task_notify(tasks[i], TASK_NOTIFY_MUTEX);
+        }
+    }
+
+    restore_interrupts(primask);
+}
+
+uint32_t task_stack_unused_words(const struct task *task) {
+    const uint32_t *floor = stack_guard_task_floor(task->stack_base,
+                                                   task->stack_words);
+    return stack_unused_words(floor, task->stack_base + task->stack_words);
+}
+
+uint32_t sched_task_count(void) {
+    return task_count;
+}
+
+struct task *sched_get_task(uint32_t i) {
+    return tasks[i];
+}
+
+uint32_t sched_switch_count(void) {
+    return switch_count;
+}
@@ -0,0 +1,132 @@
+#ifndef SCHED_H
+#define SCHED_H
+
+#include <stdint.h>
+#include "swtimer.h"
+#include "stack.h"
+
+/* ── Fixed-priority task scheduler ───────────────────────────────────────────
+   A handful of tasks, each with its own statically allocated stack, on
+   core 0. The highest-priority ready task always runs; tasks of equal
+   priority take turns when one yields or blocks. There is no time slice:
+   a task runs until it blocks, yields, or an interrupt readies something
+   more urgent — and in the last case it is preempted as soon as that
+   interrupt returns.
+
+   Mechanics (see sched_switch.S):
+   - Tasks run in thread mode on the process stack (PSP); interrupt
+     handlers keep running on the main stack (MSP) in SCRATCH_X, so no task
+     stack has to budget for the deepest interrupt nesting.
+   - Switches happen in PendSV, set to the lowest priority so it only runs
+     once every other handler has finished. Anything that makes a switch
+     necessary just pends it.
+   - sched_start() enters the first task through SVC, the one way to go
+     from thread mode on MSP to thread mode on a task's PSP.
+
+   There is always an idle task at the lowest priority, sleeping in wfi.
+   ────────────────────────────────────────────────────────────────────────── */
+/* Tasks task_create() accepts; the idle task has a slot of its own        */
+#define SCHED_MAX_TASKS         8u
+
+/* 0 is the most urgent. The idle task uses SCHED_PRIORITY_IDLE.           */
+#define SCHED_PRIORITY_IDLE     255u
+
+/* Task stacks are filled with this before the task starts, so the deepest
+   point it ever reached can be found later (task_stack_unused_words).      */
+#define TASK_STACK_PAINT        STACK_PAINT
+
+/* Notification bits used internally by task_sleep_us() and task mutexes  */
+#define TASK_NOTIFY_SLEEP       (1u << 31)
+#define TASK_NOTIFY_MUTEX       (1u << 30)
+
+enum task_state {
+    TASK_UNUSED = 0,
+    TASK_READY,
+    TASK_BLOCKED,
+    TASK_DONE,
+};
+
+struct task {
+    uint32_t *sp;               /* saved stack pointer — MUST stay first,
+                                   sched_switch.S reads it at offset 0     */
+    uint32_t *stack_base;       /* lowest address of the stack             */
+    uint32_t stack_words;
+    const char *name;
+    uint8_t priority;
+    volatile uint8_t state;     /* enum task_state                         */
+    volatile uint32_t notified; /* bits set by task_notify(), not yet taken */
+    uint32_t wait_mask;         /* bits task_wait() is blocked on          */
+    struct swtimer sleep_timer;
+};
+
+typedef void (*task_entry_t)(void *arg);
+
+/* Register a task. stack must be 8-byte aligned and stay valid forever;
+   stack_words is its size in 32-bit words. Call before sched_start().
+   A task that returns from entry is marked TASK_DONE and never runs again.
+   0, or -1 if SCHED_MAX_TASKS are already registered or the scheduler has
+   started; the task is then left untouched.                               */
+int  task_create(struct task *task, const char *name, task_entry_t entry,
+                 void *arg, uint32_t *stack, uint32_t stack_words,
+                 uint8_t priority);
+
+/* Start running tasks. Requires swtimer_init() (for task_sleep_us).
+   Never returns; main()'s stack becomes the interrupt stack.
+   In the host build it returns once the first task is chosen.             */
+#if HOST_SIM
+void sched_start(void);
+#else
+void sched_start(void) __attribute__((noreturn));
+#endif
+
+struct task *task_current(void);
+
+/* Let another ready task of the same (or higher) priority run             */
+void task_yield(void);
+
+/* Block until any bit in mask has been notified. Returns the notified bits
+   within mask and clears them.                                             */
+uint32_t task_wait(uint32_t mask);
+
+/* Set notification bits on a task, waking it if it waits for any of them.
+   Safe from interrupt handlers — the usual way to hand work from an ISR
+   to a task. If the woken task outranks the running one, the switch
+   happens when the last active handler returns.                           */
+void task_notify(struct task *task, uint32_t bits);
+
+/* Block for at least us microseconds, using a software timer              */
+void task_sleep_us(uint32_t us);
+
+/* Words at the bottom of the stack that still hold TASK_STACK_PAINT: the
+   margin left at the task's deepest point so far. 0 means it very likely
+   overflowed. With STACK_GUARD the guard block is not counted.            */
+uint32_t task_stack_unused_words(const struct task *task);
+
+/* ── Task mutex ──────────────────────────────────────────────────────────────
+   Exclusion between tasks for work too long to do with interrupts masked,
+   such as a KV compaction erasing flash. A task that finds the mutex held
+   blocks; unlocking wakes every waiter and the most urgent one takes it.
+
+   There is no priority inheritance: the owner keeps its own priority, so
+   a low-priority owner can be held off by busy tasks in between while an
+   urgent one waits. Keep what a mutex guards short.
+
+   Tasks on core 0 only, never from an interrupt handler. Zero-initialised
+   is unlocked. Before sched_start() locking never has to wait.
+   ────────────────────────────────────────────────────────────────────────── */
+struct task_mutex {
+    volatile uint32_t locked;
+    volatile uint32_t waiters;  /* bit i: the task at table index i        */
+};
+
+void task_mutex_lock(struct task_mutex *m);
+void task_mutex_unlock(struct task_mutex *m);
+
+/* Every registered task, idle included once sched_start() has run         */
+uint32_t sched_task_count(void);
+struct task *sched_get_task(uint32_t i);
+
+/* Number of context switches so far                                        */
+uint32_t sched_switch_count(void);
+
+#endif
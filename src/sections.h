@@ -0,0 +1,40 @@
+#ifndef SECTIONS_H
+#define SECTIONS_H
+
+/* ── TIME_CRITICAL ───────────────────────────────────────────────────────────
+   Places a function in .time_critical, which linker.ld links to run from
+   RAM and Reset_Handler copies there from Flash before main().
+
+   Code in Flash runs through the XIP cache. A hit costs nothing, but a miss
+   stalls the CPU for a whole QSPI transfer — tens of cycles, and whether it
+   happens depends on what ran before. RAM has no cache and no wait states,
+   so a TIME_CRITICAL handler takes the same number of cycles every time.
+
+   noinline stops GCC from copying the body back into a Flash-resident
+   caller, which would silently undo the placement.
+
+   Anything a TIME_CRITICAL function calls should be TIME_CRITICAL too
+   (or inline); otherwise the hot path still ends up fetching from Flash.
+   That includes compiler helpers: '/' and '%' become calls to
+   __aeabi_uidiv and friends, which src/divider.S provides in RAM, but
+   64-bit shifts, multiplies and divides go to libgcc in Flash.
+
+   Usage:
+       void TIME_CRITICAL SysTick_Handler(void) { ... }
+   ────────────────────────────────────────────────────────────────────────── */
+#define TIME_CRITICAL   __attribute__((section(".time_critical"), noinline))
+
+/* ── NOINIT ──────────────────────────────────────────────────────────────────
+   Places a variable in .noinit, a RAM section Reset_Handler neither copies
+   nor zeroes. Its contents are garbage after power-on but survive a warm
+   reset (watchdog, debugger, SYSRESETREQ), and it can be written before
+   startup has initialised .data/.bss.
+
+   Always validate contents with a magic number before trusting them.
+
+   Usage:
+       NOINIT struct boot_timeline boot_timeline;
+   ────────────────────────────────────────────────────────────────────────── */
+#define NOINIT          __attribute__((section(".noinit")))
+
+#endif
@@ -0,0 +1,39 @@
+#include <stdint.h>
+#include "multicore.h"
+#include "spsc.h"
+
+void spsc_init(struct spsc_queue *q, void **slots, uint32_t capacity) {
+    q->head  = 0;
+    q->tail  = 0;
+    q->mask  = capacity - 1;
+    q->slots = (void *volatile *)slots;
+    cpu_dmb();                  /* initialised before the other core looks  */
+}
+
+void spsc_push_blocking(struct spsc_queue *q, void *item) {
+    /* wfe cannot miss the consumer's sev: an event sent after the full
+       check but before the wfe leaves the event register set              */
+    while (!spsc_try_push(q, item)) {
+        cpu_wfe();
+    }
+
+    multicore_doorbell_ring();
+}
+
+void *spsc_pop_blocking(struct spsc_queue *q) {
+    void *item;
+
+    while (1) {
+        /* Clear first, then look: a doorbell rung after the clear is still
+           pending (and its sev still latched) when we reach wfe            */
+        multicore_doorbell_clear();
+        if (spsc_try_pop(q, &item)) {
+            break;
+        }
+        cpu_wfe();
+    }
+
+    /* A slot just came free; wake a producer waiting in spsc_push_blocking */
+    cpu_sev();
+    return item;
+}
@@ -0,0 +1,83 @@
+#ifndef SPSC_H
+#define SPSC_H
+
+#include <stdint.h>
+#include "multicore.h"
+
+/* ── Single-producer / single-consumer pointer queue ─────────────────────────
+   Moves pointers to payloads from one core to the other through shared SRAM
+   without locks. The payload itself never moves: the producer fills a
+   buffer, pushes its address, and ownership passes to the consumer until
+   it hands the buffer back (typically through a second queue).
+
+   head and tail are free-running counters, masked into the slot array.
+   Only the producer writes head and only the consumer writes tail, so each
+   side reads the other's index but never contends for its own. With
+   capacity a power of two, head - tail is the fill level even across
+   32-bit wrap.
+
+   Ordering: the Cortex-M0+ has no cache and executes in order, but the
+   compiler still reorders plain accesses, and the architecture only
+   promises other bus masters see stores in order after a dmb. So:
+   - push: store the slot, dmb, then publish it by storing head
+   - pop:  load head, dmb, load the slot, dmb, then release it via tail
+
+   Both cores see the same striped SRAM, so the queue and its slots can be
+   ordinary static variables. Adjacent words sit in different banks, which
+   keeps the two sides' index stores from colliding.
+   ────────────────────────────────────────────────────────────────────────── */
+struct spsc_queue {
+    volatile uint32_t head;     /* next slot to fill — producer only        */
+    volatile uint32_t tail;     /* next slot to drain — consumer only       */
+    uint32_t mask;              /* capacity - 1                              */
+    void *volatile *slots;
+};
+
+/* capacity must be a power of two; slots must hold that many pointers.
+   Call before either core touches the queue.                               */
+void spsc_init(struct spsc_queue *q, void **slots, uint32_t capacity);
+
+static inline uint32_t spsc_level(const struct spsc_queue *q) {
+    return q->head - q->tail;
+}
+
+/* Producer side. Returns 0 (and changes nothing) if the queue is full.
+   Does not ring the doorbell, so a burst can be pushed and signalled once. */
+static inline int spsc_try_push(struct spsc_queue *q, void *item) {
+    const uint32_t head = q->head;
+
+    if (head - q->tail > q->mask) {
+        return 0;
+    }
+
+    q->slots[head & q->mask] = item;
+    cpu_dmb();                  /* slot visible before the new head          */
+    q->head = head + 1;
+    return 1;
+}
+
+/* Consumer side. Returns 0 if the queue is empty.                          */
+static inline int spsc_try_pop(struct spsc_queue *q, void **item) {
+    const uint32_t tail = q->tail;
+
+    if (q->head == tail) {
+        return 0;
+    }
+
+    cpu_dmb();                  /* head read before the slot it covers       */
+    *item = q->slots[tail & q->mask];
+    cpu_dmb();                  /* slot read before it is handed back        */
+    q->tail = tail + 1;
+    return 1;
+}
+
+/* Push and ring the other core's doorbell. Sleeps in wfe while the queue
+   is full; spsc_pop_blocking() sends an event whenever it frees a slot.    */
+void spsc_push_blocking(struct spsc_queue *q, void *item);
+
+/* Pop, sleeping in wfe until the producer rings the doorbell. Clears
+   pending doorbells, so it must only be used by a core whose FIFO carries
+   nothing but doorbells.                                                   */
+void *spsc_pop_blocking(struct spsc_queue *q);
+
+#endif
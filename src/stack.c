@@ -0,0 +1,84 @@
+#include <stdint.h>
+#include "rp2040.h"
+#include "print.h"
+#include "sched.h"
+#include "stack.h"
+
+/* From linker.ld: each main stack's bank                                   */
+extern uint32_t _stack_limit, _stack_top;
+extern uint32_t _core1_stack_limit, _core1_stack_top;
+
+void __attribute__((noinline)) stack_paint_below_sp(uint32_t *limit) {
+    uint32_t *sp;
+#if HOST_SIM
+    sp = __builtin_frame_address(0);
+#else
+    __asm volatile ("mov %0, sp" : "=r" (sp));
+#endif
+
+    for (uint32_t *p = limit; p < sp; p++) {
+        *p = STACK_PAINT;
+    }
+}
+
+uint32_t stack_unused_words(const uint32_t *floor, const uint32_t *top) {
+    uint32_t n = 0;
+    while (floor + n < top && floor[n] == STACK_PAINT) {
+        n++;
+    }
+    return n;
+}
+
+/* The guard block is the bottom of the stack, so reading starts above it  */
+static uint32_t *main_floor(uint32_t *limit) {
+    return STACK_GUARD ? limit + STACK_GUARD_SIZE / 4u : limit;
+}
+
+uint32_t stack_main_unused_bytes(void) {
+    return 4u * stack_unused_words(main_floor(&_stack_limit), &_stack_top);
+}
+
+uint32_t stack_core1_unused_bytes(void) {
+    return 4u * stack_unused_words(main_floor(&_core1_stack_limit),
+                                   &_core1_stack_top);
+}
+
+static void report_line(putc_fn out, const char *name, uint32_t size,
+                        uint32_t unused) {
+    print_str(out, "K ");
+    print_str(out, name);
+    print_str(out, " size=");
+    print_dec(out, size);
+    print_str(out, " used=");
+    print_dec(out, size - unused);
+    print_str(out, " free=");
+    print_dec(out, unused);
+    print_str(out, "\r\n");
+}
+
+void stack_report(putc_fn out) {
+    report_line(out, "main",
+                4u * (uint32_t)(&_stack_top - &_stack_limit),
+                stack_main_unused_bytes());
+    report_line(out, "core1",
+                4u * (uint32_t)(&_core1_stack_top - &_core1_stack_limit),
+                stack_core1_unused_bytes());
+
+    for (uint32_t i = 0; i < sched_task_count(); i++) {
+        const struct task *t = sched_get_task(i);
+        report_line(out, t->name, 4u * t->stack_words,
+                    4u * task_stack_unused_words(t));
+    }
+}
+
+void stack_guard_init(void) {
+#if STACK_GUARD
+    uint32_t *limit = get_core_num() ? &_core1_stack_limit : &_stack_limit;
+
+    MPU_RBAR = (uint32_t)limit | MPU_RBAR_VALID | STACK_GUARD_REGION_MAIN;
+    MPU_RASR = STACK_GUARD_RASR;
+    MPU_CTRL = MPU_CTRL_PRIVDEFENA | MPU_CTRL_ENABLE;
+    __asm volatile ("dsb\n"
+                    "isb" ::: "memory");
+#endif
+}
@@ -0,0 +1,123 @@
+#ifndef STACK_H
+#define STACK_H
+
+#include <stdint.h>
+#include "rp2040.h"
+#include "print.h"
+
+/* ── Stack usage ─────────────────────────────────────────────────────────────
+   Every stack is filled with STACK_PAINT before it is used: the main stack
+   by Reset_Handler, core 1's by its first function, task stacks by
+   task_create(). The words at the bottom that still hold the pattern are
+   the margin the deepest call so far left unused. A margin of 0 means the
+   stack very likely overflowed: core 0's main stack into the SRAM_BANKn
+   arenas below STACK0_LOW, core 1's into the top of core 0's (SCRATCH_Y
+   sits right above SCRATCH_X).
+
+   The reading is a high-water mark for the code paths that actually ran —
+   exercise the worst case (deepest interrupt nesting included) before
+   trusting it to shrink a stack.
+   ────────────────────────────────────────────────────────────────────────── */
+#define STACK_PAINT             0x5A5A5A5Au
+
+/* ── STACK_GUARD ─────────────────────────────────────────────────────────────
+   0 (default): painting only.
+   1:           the MPU makes the lowest 256 bytes of each stack
+                inaccessible, so an overflow faults on the first word
+                instead of silently corrupting what lies below:
+                - region 0: this core's main stack, set by
+                  stack_guard_init() on each core
+                - region 1: the running task's stack, moved by the
+                  scheduler on every switch. A task stack needs 512 bytes
+                  or more for a guard; smaller ones (idle) go without.
+                Memory outside the guards keeps the default map.
+
+   An overflow on the main stack (MSP) faults while the fault's own frame
+   cannot be pushed, which locks the core up: still a stop, not corruption,
+   and the watchdog or a debugger takes it from there. A task overflow
+   (PSP) is a plain HardFault.
+   ────────────────────────────────────────────────────────────────────────── */
+#ifndef STACK_GUARD
+#define STACK_GUARD 0
+#endif
+
+#define STACK_GUARD_SIZE        256u
+
+/* ── MPU (Cortex-M0+, 8 regions, 256 bytes minimum) ──────────────────────── */
+#define MPU_TYPE                MMIO32(0xE000ED90)
+#define MPU_CTRL                MMIO32(0xE000ED94)
+#define MPU_RNR                 MMIO32(0xE000ED98)
+#define MPU_RBAR                MMIO32(0xE000ED9C)
+#define MPU_RASR                MMIO32(0xE000EDA0)
+
+#define MPU_CTRL_ENABLE         (1u << 0)
+#define MPU_CTRL_PRIVDEFENA     (1u << 2)   /* default map outside regions  */
+#define MPU_RBAR_VALID          (1u << 4)   /* RBAR's low bits pick region  */
+#define MPU_RASR_ENABLE         (1u << 0)
+#define MPU_RASR_SIZE_LSB       1           /* region is 2^(SIZE+1) bytes   */
+#define MPU_RASR_AP_NONE        (0u << 24)
+#define MPU_RASR_XN             (1u << 28)
+
+#define STACK_GUARD_RASR        (MPU_RASR_XN | MPU_RASR_AP_NONE       \
+                                 | (7u << MPU_RASR_SIZE_LSB)          \
+                                 | MPU_RASR_ENABLE)
+#define STACK_GUARD_REGION_MAIN 0u
+#define STACK_GUARD_REGION_TASK 1u
+
+/* Fill [limit, sp) with STACK_PAINT, sp being the caller's stack pointer:
+   everything below it is free, even on the stack already in use           */
+void stack_paint_below_sp(uint32_t *limit);
+
+/* Words from floor up that still hold STACK_PAINT                         */
+uint32_t stack_unused_words(const uint32_t *floor, const uint32_t *top);
+
+/* Margins of the two main stacks, guard excluded                          */
+uint32_t stack_main_unused_bytes(void);
+uint32_t stack_core1_unused_bytes(void);
+
+/* One line per stack, main stacks then tasks:
+       K name size= used= free=                                            */
+void stack_report(putc_fn out);
+
+/* Guard this core's main stack and enable the MPU. No-op unless
+   STACK_GUARD.                                                            */
+void stack_guard_init(void);
+
+/* Lowest word of a task stack above its guard: where painting is read
+   from, the guard itself being unreadable                                 */
+static inline __attribute__((always_inline))
+uint32_t *stack_guard_task_floor(uint32_t *base, uint32_t words) {
+#if STACK_GUARD
+    const uint32_t start = ((uint32_t)base + STACK_GUARD_SIZE - 1u)
+                         & ~(STACK_GUARD_SIZE - 1u);
+    /* A 256-aligned block inside the bottom half of the stack             */
+    if (start + STACK_GUARD_SIZE <= (uint32_t)base + 2u * words) {
+        return (uint32_t *)(start + STACK_GUARD_SIZE);
+    }
+#else
+    (void)words;
+#endif
+    return base;
+}
+
+/* Move region 1 to the incoming task. Inline: called from sched_switch()
+   in RAM.                                                                  */
+static inline __attribute__((always_inline))
+void stack_guard_task(uint32_t *base, uint32_t words) {
+#if STACK_GUARD
+    const uint32_t floor = (uint32_t)stack_guard_task_floor(base, words);
+    if (floor != (uint32_t)base) {
+        MPU_RBAR = (floor - STACK_GUARD_SIZE) | MPU_RBAR_VALID
+                 | STACK_GUARD_REGION_TASK;
+        MPU_RASR = STACK_GUARD_RASR;
+    } else {
+        MPU_RNR = STACK_GUARD_REGION_TASK;
+        MPU_RASR = 0;
+    }
+#else
+    (void)base;
+    (void)words;
+#endif
+}
+
+#endif
@@ -1,4 +1,12 @@
 #include <stdint.h> // Standard integer types
+#include "clocks.h"
+#include "mem_ops.h"
+#include "dma.h"
+#include "irq.h"
+#include "timer.h"
+#include "sync.h"
+#include "boot_profile.h"
+#include "stack.h"
 
 /* Symbols from the linker script ---------------------------------------------
     These are NOT variables. They are addresses the linker calculated.
@@ -6,8 +14,8 @@
     The & operator is how you get their actual address value in C.
     
     Notice we declare them as uint32_t (32-bit unsigned).
-    ARM is a 32-bit architecture - we copy memory word by word (bytes at a time) 
-    which is the natural and most efficient unit on this CPU.
+    The linker places every one of them on a word boundary, which is what
+    lets memcpy/memset below move them in multi-word bursts.
     ---------------------------------------------------------------------------*/
 
 extern uint32_t _data_start;    /* where .data begins in RAM */
@@ -15,10 +23,86 @@ extern uint32_t _data_end;      /* where .data ends in RAM.  */
 extern uint32_t _data_flash;    /* where .data initial values sit in Flash */
 extern uint32_t _bss_start;     /* where .bss begins in RAM*/
 extern uint32_t _bss_end;       /* where .bss ends in RAM */
+extern uint32_t _ramfunc_start; /* where RAM-resident code begins in RAM */
+extern uint32_t _ramfunc_end;   /* where RAM-resident code ends in RAM */
+extern uint32_t _ramfunc_flash; /* where that code is stored in Flash */
+extern uint32_t _stack_limit;   /* bottom of core 0's stack */
 
 /* --- Forward declaration ----------------------------------------------------*/
 extern int main(void);
 
+/* STARTUP_DMA -------------------------------------------------------------------
+    0 (default): the CPU copies .data/.ramfunc and zeroes .bss itself, then
+                 brings up the clocks.
+    1:           three DMA channels do the copies and the .bss fill while the
+                 CPU brings up the clocks in parallel — XOSC startup alone is
+                 ~1 ms of the CPU doing nothing but polling a status bit.
+                 Worth it on images with large static buffers.
+    ----------------------------------------------------------------------------*/
+#ifndef STARTUP_DMA
+#define STARTUP_DMA 0
+#endif
+
+#if STARTUP_DMA
+/* Channels 0-2 are used before any driver exists to claim them, and are
+   idle again (and unclaimed, since the claim bitmap is in .bss) by main().  */
+#define STARTUP_DMA_CH_DATA     0u
+#define STARTUP_DMA_CH_RAMFUNC  1u
+#define STARTUP_DMA_CH_BSS      2u
+
+/* Source word for the .bss fill: with read increment off, DMA reads it
+   over and over. In Flash, because RAM is not initialised yet.             */
+static const uint32_t startup_zero = 0;
+
+static uint32_t section_words(uint32_t *start, uint32_t *end) {
+    return (uint32_t)(end - start);
+}
+
+/* Nothing here may write .data or .bss: the DMA is still filling them.
+   Only registers and the stack (which sits above .bss) are safe.           */
+static void startup_dma_begin(void) {
+    dma_init();
+
+    /* Each config chains to its own channel, i.e. not at all. One built
+       for another channel would retrigger that channel when it finishes,
+       which would then copy on from where it stopped, past its section.   */
+    dma_channel_config copy =
+        dma_channel_get_default_config(STARTUP_DMA_CH_DATA);
+    channel_config_set_write_increment(&copy, 1);
+
+    dma_channel_config fill =
+        dma_channel_get_default_config(STARTUP_DMA_CH_BSS);
+    channel_config_set_read_increment(&fill, 0);
+    channel_config_set_write_increment(&fill, 1);
+
+    /* A zero-length section has nothing to do; do not arm its channel    */
+    uint32_t words = section_words(&_data_start, &_data_end);
+    if (words) {
+        dma_channel_configure(STARTUP_DMA_CH_DATA, &copy, &_data_start,
+                              &_data_flash, words, 1);
+    }
+
+    words = section_words(&_ramfunc_start, &_ramfunc_end);
+    if (words) {
+        channel_config_set_chain_to(&copy, STARTUP_DMA_CH_RAMFUNC);
+        dma_channel_configure(STARTUP_DMA_CH_RAMFUNC, &copy, &_ramfunc_start,
+                              &_ramfunc_flash, words, 1);
+    }
+
+    words = section_words(&_bss_start, &_bss_end);
+    if (words) {
+        dma_channel_configure(STARTUP_DMA_CH_BSS, &fill, &_bss_start,
+                              &startup_zero, words, 1);
+    }
+}
+
+static void startup_dma_finish(void) {
+    dma_channel_wait_for_finish_blocking(STARTUP_DMA_CH_DATA);
+    dma_channel_wait_for_finish_blocking(STARTUP_DMA_CH_RAMFUNC);
+    dma_channel_wait_for_finish_blocking(STARTUP_DMA_CH_BSS);
+}
+#endif
+
 /* Reset_Handler ---------------------------------------------------------------
     This is the entry point of your application.
     boot2 reads its address from your vector table and jumps here.
@@ -30,40 +114,112 @@ extern int main(void);
     is nothing to return to. No OS, no runtime, nothing.
     ----------------------------------------------------------------------------*/
 void Reset_Handler(void) {
+/* Paint the stack first, while nothing but this frame is on it: the words
+   that still hold STACK_PAINT later are what the deepest call left unused. */
+stack_paint_below_sp(&_stack_limit);
+
+/* With BOOT_PROFILE=1 every phase below is timestamped into boot_timeline,
+   starting now — the first instruction after boot2's jump. boot2 itself
+   cannot be timed on-chip: nothing is counting while it runs.               */
+boot_profile_start();
+
+#if STARTUP_DMA
+    /* ---- Steps 1-2 by DMA -------------------------------------------------------
+    Kick off the .data copy, the .ramfunc copy and the .bss fill described below
+    on three DMA channels and carry straight on with the clocks. Until
+    startup_dma_finish() returns, no C code may touch a global variable.
+    ----------------------------------------------------------------------------*/
+
+startup_dma_begin();
+
+#else
     /* Problem: global variables with initial values ( int x = 42) have their 
     initial values stored in Flash (non-volatile, survives power off).
     But they need to live in RAM so your code can modify them at runtime.
     
     Solution: copy them from Flash to RAM right now, before main() runs.
     
-    sr  starts at where the values sit in Flash.
-    dst starts at where they should live in RAM.
-    We copy word by word until dst reaches the end of the .data region.
+    The size in bytes is the distance between the start and end symbols.
+    memcpy (src/mem_ops.S) moves 16 bytes per ldmia/stmia pair rather than
+    one word per loop iteration, which matters once .data grows.
     ----------------------------------------------------------------------------*/
 
-uint32_t *src = &_data_flash;
-uint32_t *dst = &_data_start;
+memcpy(&_data_start, &_data_flash,
+       (size_t)((uint8_t *)&_data_end - (uint8_t *)&_data_start));
 
-while (dst < &_data_end){
-    *dst++ = *src++;
-}
+/* ----- Step 1b: Copy RAM-resident code -------------------------------------------
+Functions marked TIME_CRITICAL are linked to run from RAM but stored in Flash,
+exactly like .data. Same problem, same solution: copy them across before
+anything can call them. No interrupt source has been enabled yet, so no
+handler can run from RAM before its code has arrived.
+----------------------------------------------------------------------------------*/
+
+memcpy(&_ramfunc_start, &_ramfunc_flash,
+       (size_t)((uint8_t *)&_ramfunc_end - (uint8_t *)&_ramfunc_start));
 
 /* ----- Step2: Zero out .bss ---------------------------------------------------
 Problem: global variables with no initial value (int counter) must be zero at
 program start - the C standard guarantees this. But RAM powers on with random
 noise ( whatever charge was left in the capacitors ).
 
-Solution: walk through the entire .bss region and write zero to every word.
-After this loop, all your uninitialized globals are guaranteed zero.
+Solution: write zero over the entire .bss region, 16 bytes per store burst.
+After this, all your uninitialized globals are guaranteed zero.
 ----------------------------------------------------------------------------------*/
 
-dst = &_bss_start;
+memset(&_bss_start, 0,
+       (size_t)((uint8_t *)&_bss_end - (uint8_t *)&_bss_start));
 
-while (dst < &_bss_end){
-    *dst++ = 0;
-}
+boot_profile_mark(BOOT_MARK_RAM_INIT);
+#endif
+
+/* ---- Step 3: Bring up the clocks -----------------------------------------------
+    We are still running from the ~6 MHz ring oscillator the bootrom left us on.
+    Start the crystal and PLLs and move clk_sys to 125 MHz before main() runs,
+    so every driver sees its final clock frequencies from the first line on.
+
+    clocks_init() only touches registers and the stack, which is what allows
+    it to overlap with the DMA transfers when STARTUP_DMA is enabled. That
+    includes not dividing at run time: the divide routines are TIME_CRITICAL
+    and so not in RAM yet, which is why its dividers are constants.
+    ------------------------------------------------------------------------------*/
+
+clocks_init();
+boot_profile_mark(BOOT_MARK_CLOCKS);
+
+#if STARTUP_DMA
+/* The DMA copies ran alongside the clocks, so RAM_INIT is whatever part of
+   them the clock bring-up did not already hide                              */
+startup_dma_finish();
+boot_profile_mark(BOOT_MARK_RAM_INIT);
+#endif
+
+/* ---- Step 3b: Move the vector table to RAM ---------------------------------------
+    boot2 pointed VTOR at the table in Flash. Copy it into SRAM and point VTOR
+    there instead, so exception entry never waits on an XIP miss and handlers
+    can be swapped at runtime with irq_set_handler(). The copy lives in .bss,
+    which is why this has to come after Step 2.
+    ------------------------------------------------------------------------------*/
+
+irq_init_vector_table();
+boot_profile_mark(BOOT_MARK_VECTORS);
+
+/* With STACK_GUARD=1 the bottom 256 bytes of the stack become a no-access
+   MPU region from here on: an overflow faults instead of running into
+   core 1's stack.                                                           */
+stack_guard_init();
+
+/* The microsecond tick is running now; take the 64-bit TIMER out of reset
+   so everything from here on can timestamp and busy-wait in real units.      */
+timer_init();
+boot_profile_timer_started();
+boot_profile_mark(BOOT_MARK_TIMER);
+
+/* The SIO survives a core-only reset (debugger, watchdog core reset), so a
+   spinlock held when it happened would still be held. Free them all before
+   anything tries to take one.                                               */
+spin_locks_reset();
 
-/* ---- Step 3: Call main --------------------------------------------------------
+/* ---- Step 4: Call main --------------------------------------------------------
     RAM is now in a valid state. .data has correct initial values.
     .bss is zeroed. Stack is ready (SP was set by boot2).
     The C environment is fully initialized. We can safely run C code.
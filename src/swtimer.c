@@ -0,0 +1,142 @@
+#include <stdint.h>
+#include "rp2040.h"
+#include "irq.h"
+#include "timer.h"
+#include "swtimer.h"
+
+#define ALARM_MASK          (1u << SWTIMER_ALARM_NUM)
+
+/* The alarm only sees the low 32 bits of the counter. A deadline further
+   away than half that range is reached in steps: the alarm fires early,
+   finds nothing due, and is programmed again.                              */
+#define MAX_ALARM_STEP_US   0x80000000u
+
+/* Sorted by deadline, soonest first. Only touched with interrupts masked. */
+static struct swtimer *timer_list;
+
+/* Timers with equal deadlines expire in the order they were started       */
+static void list_insert(struct swtimer *timer) {
+    struct swtimer **link = &timer_list;
+
+    while (*link && (*link)->deadline_us <= timer->deadline_us) {
+        link = &(*link)->next;
+    }
+
+    timer->next = *link;
+    *link = timer;
+    timer->active = 1;
+}
+
+static void list_remove(struct swtimer *timer) {
+    for (struct swtimer **link = &timer_list; *link; link = &(*link)->next) {
+        if (*link == timer) {
+            *link = timer->next;
+            break;
+        }
+    }
+
+    timer->active = 0;
+}
+
+/* Point the alarm at the head of the list, or disarm it if there is none.
+   Called with interrupts masked.                                           */
+static void alarm_program(void) {
+    if (!timer_list) {
+        TIMER_ARMED = ALARM_MASK;
+        return;
+    }
+
+    uint64_t target = timer_list->deadline_us;
+    const uint64_t now = time_us_64();
+    if (target > now + MAX_ALARM_STEP_US) {
+        target = now + MAX_ALARM_STEP_US;
+    }
+
+    TIMER_ALARM(SWTIMER_ALARM_NUM) = (uint32_t)target;
+
+    /* Equality match: if the deadline passed before (or while) the alarm
+       was written it will not fire, so run the handler by hand instead     */
+    if (time_us_64() >= target) {
+        irq_set_pending(TIMER_IRQ_0);
+    }
+}
+
+void swtimer_init(void) {
+    TIMER_INTR = ALARM_MASK;
+    TIMER_INTE_SET = ALARM_MASK;
+    irq_set_enabled(TIMER_IRQ_0, 1);
+}
+
+void swtimer_start_at(struct swtimer *timer, uint64_t deadline_us,
+                      uint32_t period_us, swtimer_callback_t callback,
+                      void *user_data) {
+    const uint32_t primask = save_and_disable_interrupts();
+
+    if (timer->active) {
+        list_remove(timer);
+    }
+
+    timer->deadline_us = deadline_us;
+    timer->period_us   = period_us;
+    timer->callback    = callback;
+    timer->user_data   = user_data;
+    list_insert(timer);
+
+    /* Only a new head changes when the next interrupt is needed            */
+    if (timer_list == timer) {
+        alarm_program();
+    }
+
+    restore_interrupts(primask);
+}
+
+void swtimer_start(struct swtimer *timer, uint32_t delay_us,
+                   uint32_t period_us, swtimer_callback_t callback,
+                   void *user_data) {
+    swtimer_start_at(timer, time_us_64() + delay_us, period_us, callback,
+                     user_data);
+}
+
+void swtimer_cancel(struct swtimer *timer) {
+    const uint32_t primask = save_and_disable_interrupts();
+
+    if (timer->active) {
+        const int was_head = (timer_list == timer);
+        list_remove(timer);
+        if (was_head) {
+            alarm_program();
+        }
+    }
+
+    restore_interrupts(primask);
+}
+
+/* ── TIMER_IRQ0_Handler ──────────────────────────────────────────────────────
+   Overrides the weak alias in vectors.c. Runs every timer that is due,
+   then programs the alarm for whatever is next. List manipulation is done
+   with interrupts masked, callbacks are not — a higher-priority interrupt
+   that starts a timer must not have to wait for someone else's callback.
+   ────────────────────────────────────────────────────────────────────────── */
+void TIMER_IRQ0_Handler(void) {
+    TIMER_INTR = ALARM_MASK;
+
+    uint32_t primask = save_and_disable_interrupts();
+
+    while (timer_list && timer_list->deadline_us <= time_us_64()) {
+        struct swtimer *timer = timer_list;
+        timer_list = timer->next;
+        timer->active = 0;
+
+        if (timer->period_us) {
+            timer->deadline_us += timer->period_us;
+            list_insert(timer);
+        }
+
+        restore_interrupts(primask);
+        timer->callback(timer);
+        primask = save_and_disable_interrupts();
+    }
+
+    alarm_program();
+    restore_interrupts(primask);
+}
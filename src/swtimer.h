@@ -0,0 +1,55 @@
+#ifndef SWTIMER_H
+#define SWTIMER_H
+
+#include <stdint.h>
+
+/* ── Software timers ─────────────────────────────────────────────────────────
+   Any number of one-shot or periodic timers multiplexed onto hardware
+   alarm 0. Active timers sit in a list sorted by deadline; only the head
+   is programmed into the alarm, so the CPU is interrupted exactly when
+   something is due and can sleep in wfi the rest of the time — no tick.
+
+   Deadlines are absolute 64-bit microsecond times, so they never wrap.
+   Callbacks run in the TIMER_IRQ_0 handler: keep them short, and hand
+   anything longer to the main loop or a task. A callback may start or
+   cancel timers, including its own.
+
+   Timers are a core 0 facility: the alarm interrupt is enabled in core 0's
+   NVIC and the list is guarded by masking interrupts, not by a spinlock.
+
+   struct swtimer is owned by the caller (static or embedded in a driver's
+   state) and must stay valid while the timer is active. No allocation.
+   ────────────────────────────────────────────────────────────────────────── */
+#define SWTIMER_ALARM_NUM   0u
+
+struct swtimer;
+typedef void (*swtimer_callback_t)(struct swtimer *timer);
+
+struct swtimer {
+    struct swtimer *next;
+    uint64_t deadline_us;       /* absolute TIMER time of the next expiry  */
+    uint32_t period_us;         /* 0 = one-shot                            */
+    swtimer_callback_t callback;
+    void *user_data;
+    volatile uint8_t active;
+};
+
+/* Enable the alarm interrupt. Call on core 0 after timer_init().           */
+void swtimer_init(void);
+
+/* Start (or restart) a timer that first expires delay_us from now, then
+   every period_us after that unless period_us is 0. Periodic deadlines are
+   advanced by exactly period_us each time, so they do not drift.           */
+void swtimer_start(struct swtimer *timer, uint32_t delay_us,
+                   uint32_t period_us, swtimer_callback_t callback,
+                   void *user_data);
+
+/* Same, with an absolute first deadline                                    */
+void swtimer_start_at(struct swtimer *timer, uint64_t deadline_us,
+                      uint32_t period_us, swtimer_callback_t callback,
+                      void *user_data);
+
+/* Stop a timer. Harmless if it is not active.                              */
+void swtimer_cancel(struct swtimer *timer);
+
+#endif
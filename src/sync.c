@@ -0,0 +1,79 @@
+#include <stdint.h>
+#include "rp2040.h"
+#include "sync.h"
+
+/* One bit per lock, protected by SPINLOCK_ID_CLAIM. The fixed locks below
+   SPINLOCK_ID_FIRST_FREE are never handed out.                            */
+static uint32_t claimed_locks;
+
+void spin_locks_reset(void) {
+    for (uint32_t i = 0; i < NUM_SPIN_LOCKS; i++) {
+        SIO_SPINLOCK(i) = 0;
+    }
+}
+
+int spin_lock_claim_unused(void) {
+    spin_lock_t *lock = spin_lock_instance(SPINLOCK_ID_CLAIM);
+    const uint32_t saved = spin_lock_blocking(lock);
+    int num = -1;
+
+    for (uint32_t i = SPINLOCK_ID_FIRST_FREE; i < NUM_SPIN_LOCKS; i++) {
+        if (!(claimed_locks & (1u << i))) {
+            claimed_locks |= 1u << i;
+            num = (int)i;
+            break;
+        }
+    }
+
+    spin_unlock(lock, saved);
+    return num;
+}
+
+void spin_lock_unclaim(uint32_t lock_num) {
+    spin_lock_t *lock = spin_lock_instance(SPINLOCK_ID_CLAIM);
+    const uint32_t saved = spin_lock_blocking(lock);
+    claimed_locks &= ~(1u << lock_num);
+    spin_unlock(lock, saved);
+}
+
+int critical_section_init(critical_section_t *cs) {
+    const int num = spin_lock_claim_unused();
+    if (num < 0) {
+        return -1;
+    }
+
+    critical_section_init_with_lock_num(cs, (uint32_t)num);
+    return 0;
+}
+
+#if SPINLOCK_PROFILE
+/* Each entry is only written by the current holder of its lock, so the
+   lock itself protects its statistics.                                     */
+struct spinlock_stats spinlock_stats[NUM_SPIN_LOCKS];
+
+void spinlock_profile_acquired(uint32_t lock_num) {
+    struct spinlock_stats *s = &spinlock_stats[lock_num];
+    s->held_since = SYST_CVR & SYST_CVR_MASK;
+    s->acquisitions++;
+}
+
+void spinlock_profile_releasing(uint32_t lock_num) {
+    if (!(SYST_CSR & SYST_CSR_ENABLE)) {
+        return;     /* SysTick not running yet: nothing to measure against */
+    }
+
+    struct spinlock_stats *s = &spinlock_stats[lock_num];
+    const uint32_t now = SYST_CVR & SYST_CVR_MASK;
+
+    /* SysTick counts down from RVR to 0 and reloads; a hold that crossed
+       the reload shows up as now > held_since                              */
+    uint32_t held = s->held_since - now;
+    if (now > s->held_since) {
+        held += SYST_RVR + 1u;
+    }
+
+    if (held > s->max_hold_cycles) {
+        s->max_hold_cycles = held;
+    }
+}
+#endif
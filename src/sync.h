@@ -0,0 +1,148 @@
+#ifndef SYNC_H
+#define SYNC_H
+
+#include <stdint.h>
+#include "rp2040.h"
+#include "irq.h"
+
+/* ── Hardware spinlocks ──────────────────────────────────────────────────────
+   The SIO has 32 one-bit locks shared by both cores. Reading SPINLOCKn
+   claims lock n and returns nonzero if the claim succeeded (zero if it was
+   already held); writing any value releases it. The claim is a single bus
+   transaction, so it is atomic across cores without ldrex/strex — which the
+   Cortex-M0+ does not have anyway.
+
+   A spinlock alone only excludes the other core. An interrupt on the same
+   core that tries to take a lock its own thread holds would spin forever,
+   so every lock below is taken with interrupts masked on the calling core
+   and the previous PRIMASK is handed back to restore on release. Only the
+   holder's core is masked: the other core keeps taking interrupts unless
+   it is itself waiting for the lock.
+
+   Keep the held region short — a few register or RAM accesses. Anything
+   longer belongs in a queue (spsc.h) handed to the other core.
+   ────────────────────────────────────────────────────────────────────────── */
+#define SIO_SPINLOCK_ST     MMIO32(SIO_BASE + 0x05C)   /* bit n = lock n held */
+#define SIO_SPINLOCK(n)     MMIO32(SIO_BASE + 0x100 + 4u * (n))
+
+#define NUM_SPIN_LOCKS      32u
+
+typedef volatile uint32_t spin_lock_t;
+
+/* Locks 0-7 have fixed owners, so drivers that need one at init time never
+   depend on claim order. 8-31 are handed out by spin_lock_claim_unused().  */
+#define SPINLOCK_ID_CLAIM       0u  /* claim bitmaps: spinlocks, DMA        */
+#define SPINLOCK_ID_POOL        1u  /* arenas and pools (pool.h)            */
+#define SPINLOCK_ID_FIRST_FREE  8u
+
+/* ── SPINLOCK_PROFILE ────────────────────────────────────────────────────────
+   0 (default): no overhead beyond the lock itself.
+   1:           every release records how many clk_sys cycles the lock was
+                held (by SysTick, so holds must stay under one SysTick
+                period) and keeps the maximum and an acquisition count per
+                lock in spinlock_stats, readable over SWD.
+   ────────────────────────────────────────────────────────────────────────── */
+#ifndef SPINLOCK_PROFILE
+#define SPINLOCK_PROFILE 0
+#endif
+
+#if SPINLOCK_PROFILE
+struct spinlock_stats {
+    uint32_t max_hold_cycles;
+    uint32_t acquisitions;
+    uint32_t held_since;        /* SysTick CVR at acquisition               */
+};
+
+extern struct spinlock_stats spinlock_stats[NUM_SPIN_LOCKS];
+
+void spinlock_profile_acquired(uint32_t lock_num);
+void spinlock_profile_releasing(uint32_t lock_num);
+#endif
+
+static inline spin_lock_t *spin_lock_instance(uint32_t lock_num) {
+    return &SIO_SPINLOCK(lock_num);
+}
+
+static inline uint32_t spin_lock_get_num(spin_lock_t *lock) {
+    return ((uint32_t)lock - (uint32_t)&SIO_SPINLOCK(0)) / 4u;
+}
+
+/* Take the lock, masking interrupts on this core first. Returns the PRIMASK
+   value to pass to spin_unlock().                                          */
+static inline uint32_t spin_lock_blocking(spin_lock_t *lock) {
+    const uint32_t saved = save_and_disable_interrupts();
+
+    while (*lock == 0);
+    /* Nothing inside the critical region may be observed before the claim  */
+    cpu_dmb();
+
+#if SPINLOCK_PROFILE
+    spinlock_profile_acquired(spin_lock_get_num(lock));
+#endif
+    return saved;
+}
+
+/* Release the lock and restore the interrupt state spin_lock_blocking()
+   saved. Stores made while holding it are visible before the release.     */
+static inline void spin_unlock(spin_lock_t *lock, uint32_t saved) {
+#if SPINLOCK_PROFILE
+    spinlock_profile_releasing(spin_lock_get_num(lock));
+#endif
+    cpu_dmb();
+    *lock = 0;
+    restore_interrupts(saved);
+}
+
+static inline int spin_lock_is_held(spin_lock_t *lock) {
+    return (SIO_SPINLOCK_ST & (1u << spin_lock_get_num(lock))) != 0;
+}
+
+/* Release every spinlock. The SIO is not reset when only the cores are
+   (debugger reset, watchdog core reset), so a lock held at that moment
+   would stay held. Called from Reset_Handler before main().                */
+void spin_locks_reset(void);
+
+/* Claim a free lock number from 8-31. Returns -1 if none is free.          */
+int  spin_lock_claim_unused(void);
+
+void spin_lock_unclaim(uint32_t lock_num);
+
+/* ── Critical sections ───────────────────────────────────────────────────────
+   A spinlock plus the interrupt state saved when it was taken — mutual
+   exclusion against the other core and against this core's interrupts,
+   without masking interrupts anywhere else.
+
+       static critical_section_t cs;
+       critical_section_init(&cs);             // once, at init time
+       critical_section_enter_blocking(&cs);
+       ... touch the shared state ...
+       critical_section_exit(&cs);
+
+   Not recursive: entering a section this core already holds deadlocks.
+   ────────────────────────────────────────────────────────────────────────── */
+typedef struct {
+    spin_lock_t *lock;
+    uint32_t saved_primask;
+} critical_section_t;
+
+/* Give the section its own lock. Returns -1 if no lock was free.           */
+int critical_section_init(critical_section_t *cs);
+
+/* Share an existing lock, e.g. one of the fixed SPINLOCK_ID_* locks        */
+static inline void critical_section_init_with_lock_num(critical_section_t *cs,
+                                                       uint32_t lock_num) {
+    cs->lock = spin_lock_instance(lock_num);
+    cs->saved_primask = 0;
+}
+
+static inline void critical_section_enter_blocking(critical_section_t *cs) {
+    /* Store after the claim: saved_primask belongs to whoever holds it     */
+    const uint32_t saved = spin_lock_blocking(cs->lock);
+    cs->saved_primask = saved;
+}
+
+static inline void critical_section_exit(critical_section_t *cs) {
+    spin_unlock(cs->lock, cs->saved_primask);
+}
+
+#endif
@@ -0,0 +1,34 @@
+#include <stdint.h>
+#include "rp2040.h"
+#include "timer.h"
+
+void timer_init(void) {
+    reset_block(RESET_TIMER);
+    unreset_block_wait(RESET_TIMER);
+}
+
+uint64_t time_us_64(void) {
+    /* The two halves cannot be read in one access. Read high, low, high
+       again: if high changed the low half wrapped in between, so retry.    */
+    uint32_t hi = TIMER_TIMERAWH;
+    uint32_t lo;
+    uint32_t next_hi;
+
+    while (1) {
+        lo      = TIMER_TIMERAWL;
+        next_hi = TIMER_TIMERAWH;
+        if (hi == next_hi) {
+            break;
+        }
+        hi = next_hi;
+    }
+
+    return ((uint64_t)hi << 32) | lo;
+}
+
+void busy_wait_us(uint32_t us) {
+    const uint32_t start = time_us_32();
+
+    /* Unsigned subtraction handles the 32-bit wrap for free                 */
+    while ((time_us_32() - start) < us);
+}
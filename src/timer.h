@@ -0,0 +1,61 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stdint.h>
+#include "rp2040.h"
+
+/* ── TIMER ───────────────────────────────────────────────────────────────────
+   A 64-bit microsecond counter shared by both cores. It counts ticks from the
+   watchdog tick generator, which clocks_init() sets to 1 MHz from clk_ref.
+   At 1 µs per tick the 64-bit count never wraps; the low 32 bits wrap
+   every ~71.6 minutes.
+
+   TIMERAWH/TIMERAWL read the counter directly with no side effects.
+   (TIMEHR/TIMELR latch the high half on a low read, which is not safe
+   when both cores use the timer, so we never use them.)
+   ────────────────────────────────────────────────────────────────────────── */
+#define TIMER_BASE          0x40054000u
+#define TIMER_TIMERAWH      MMIO32(TIMER_BASE + 0x24)
+#define TIMER_TIMERAWL      MMIO32(TIMER_BASE + 0x28)
+
+/* ── Alarms ──────────────────────────────────────────────────────────────────
+   Four alarms compare against the LOW 32 bits of the counter. Writing
+   ALARMn arms it; when TIMERAWL equals the value the alarm disarms itself
+   and raises TIMER_IRQ_n. It is an equality match: a value already in the
+   past only fires after the counter wraps, ~71 minutes later, so whoever
+   arms an alarm must check for a missed deadline afterwards.
+
+   ARMED: read which alarms are armed; write 1 to disarm
+   INTR:  raw interrupt status; write 1 to acknowledge
+   INTE:  enable; INTF: force; INTS: status after enable and force
+   ────────────────────────────────────────────────────────────────────────── */
+#define TIMER_ALARM(n)      MMIO32(TIMER_BASE + 0x10 + 4u * (n))
+#define TIMER_ARMED         MMIO32(TIMER_BASE + 0x20)
+#define TIMER_INTR          MMIO32(TIMER_BASE + 0x34)
+#define TIMER_INTE          MMIO32(TIMER_BASE + 0x38)
+#define TIMER_INTE_SET      MMIO32(TIMER_BASE + 0x38 + REG_ALIAS_SET)
+#define TIMER_INTE_CLR      MMIO32(TIMER_BASE + 0x38 + REG_ALIAS_CLR)
+#define TIMER_INTF          MMIO32(TIMER_BASE + 0x3C)
+#define TIMER_INTS          MMIO32(TIMER_BASE + 0x40)
+
+#define TIMER_NUM_ALARMS    4u
+
+#define RESET_TIMER         (1u << 21)
+
+/* Release the TIMER from reset. Called from Reset_Handler after the clocks
+   (and with them the microsecond tick) are running.                        */
+void timer_init(void);
+
+/* Low 32 bits of the microsecond counter — one load, cheap enough for
+   interval measurements below ~71 minutes (use unsigned subtraction).      */
+static inline uint32_t time_us_32(void) {
+    return TIMER_TIMERAWL;
+}
+
+/* Full 64-bit microsecond count since timer_init()                          */
+uint64_t time_us_64(void);
+
+/* Busy-wait for at least us microseconds                                    */
+void busy_wait_us(uint32_t us);
+
+#endif
@@ -0,0 +1,290 @@
+#include <stdint.h>
+#include "rp2040.h"
+#include "clocks.h"
+#include "dma.h"
+#include "gpio.h"
+#include "irq.h"
+#include "sync.h"
+#include "sched.h"
+#include "uart.h"
+
+_Static_assert((UART_TX_BUFFER_SIZE & (UART_TX_BUFFER_SIZE - 1u)) == 0
+               && UART_TX_BUFFER_SIZE >= 2u && UART_TX_BUFFER_SIZE <= 32768u,
+               "UART_TX_BUFFER_SIZE must be a power of two the DMA can wrap");
+_Static_assert((UART_RX_BUFFER_SIZE & (UART_RX_BUFFER_SIZE - 1u)) == 0,
+               "UART_RX_BUFFER_SIZE must be a power of two");
+
+/* Free-running indices, masked on use: head - tail is the fill level       */
+struct uart_port {
+    critical_section_t tx_lock;
+    volatile uint32_t tx_head;      /* written by uart_write()              */
+    volatile uint32_t tx_tail;      /* advanced as DMA transfers complete   */
+    volatile uint32_t tx_in_flight; /* bytes the running transfer covers    */
+    int tx_dma;                     /* channel number, -1 before init       */
+
+    volatile uint32_t rx_head;      /* written by the IRQ handler           */
+    volatile uint32_t rx_tail;      /* written by uart_read()               */
+    struct task *volatile rx_task;
+    uint32_t rx_bits;
+
+    struct uart_stats stats;
+};
+
+static struct uart_port ports[UART_NUM] = {
+    { .tx_dma = -1 },
+    { .tx_dma = -1 },
+};
+
+/* The DMA read ring wraps on a buffer-sized boundary, so the buffer must
+   sit on one                                                               */
+static uint8_t tx_buffers[UART_NUM][UART_TX_BUFFER_SIZE]
+    __attribute__((aligned(UART_TX_BUFFER_SIZE)));
+static uint8_t rx_buffers[UART_NUM][UART_RX_BUFFER_SIZE];
+
+static uint32_t log2_u32(uint32_t v) {
+    uint32_t bits = 0;
+    while (v > 1u) {
+        v >>= 1;
+        bits++;
+    }
+    return bits;
+}
+
+/* PL011 divisor: a 16-bit integer part and a 6-bit fraction of
+   clk_peri / (16 * baud). Worked in 1/128ths to round the fraction.        */
+static uint32_t set_baud(uint32_t n, uint32_t baud) {
+    const uint32_t clk = clock_get_hz(CLK_PERI);
+    const uint32_t div = (8u * clk) / baud;
+    uint32_t ibrd = div >> 7;
+    uint32_t fbrd;
+
+    if (ibrd == 0) {
+        ibrd = 1;
+        fbrd = 0;
+    } else if (ibrd >= UART_IBRD_MASK) {
+        ibrd = UART_IBRD_MASK;
+        fbrd = 0;
+    } else {
+        fbrd = ((div & 0x7Fu) + 1u) / 2u;
+    }
+
+    UART_IBRD(n) = ibrd;
+    UART_FBRD(n) = fbrd;
+
+    return (4u * clk) / (64u * ibrd + fbrd);
+}
+
+/* Start a transfer over everything queued, if none is running. Caller
+   holds tx_lock (or is the DMA IRQ, which the lock also excludes).         */
+static void tx_kick(struct uart_port *p, uint32_t n) {
+    if (p->tx_in_flight) {
+        return;
+    }
+    const uint32_t count = p->tx_head - p->tx_tail;
+    if (!count) {
+        return;
+    }
+
+    p->tx_in_flight = count;
+    DMA_READ_ADDR(p->tx_dma) =
+        (uint32_t)&tx_buffers[n][p->tx_tail & (UART_TX_BUFFER_SIZE - 1u)];
+    dma_channel_set_trans_count_trigger((uint32_t)p->tx_dma, count);
+}
+
+uint32_t uart_init(uint32_t n, uint32_t baud, uint32_t tx_pin,
+                   uint32_t rx_pin) {
+    struct uart_port *p = &ports[n];
+
+    if (p->tx_dma < 0) {
+        p->tx_dma = dma_claim_unused_channel();
+        if (p->tx_dma < 0) {
+            return 0;
+        }
+        if (critical_section_init(&p->tx_lock) < 0) {
+            dma_channel_unclaim((uint32_t)p->tx_dma);
+            p->tx_dma = -1;
+            return 0;
+        }
+    }
+    const uint32_t ch = (uint32_t)p->tx_dma;
+
+    const uint32_t reset = n ? RESET_UART1 : RESET_UART0;
+    reset_block(reset);
+    unreset_block_wait(reset | RESET_IO_BANK0 | RESET_PADS_BANK0);
+    dma_init();
+
+    const uint32_t actual = set_baud(n, baud);
+    /* LCR_H must follow IBRD/FBRD: writing it is what latches the divisor  */
+    UART_LCR_H(n) = UART_LCR_H_WLEN_8 | UART_LCR_H_FEN;
+    UART_IFLS(n) = UART_IFLS_RX_HALF;
+    UART_DMACR(n) = UART_DMACR_TXDMAE;
+    UART_CR(n) = UART_CR_UARTEN | UART_CR_TXE | UART_CR_RXE;
+
+    gpio_set_function(tx_pin, GPIO_FUNC_UART);
+    gpio_set_function(rx_pin, GPIO_FUNC_UART);
+
+    p->tx_head = p->tx_tail = p->tx_in_flight = 0;
+    p->rx_head = p->rx_tail = 0;
+
+    /* Bytes from the ring into DR, one per TX DREQ, wrapping the read
+       address at the end of the buffer                                     */
+    dma_channel_config c = dma_channel_get_default_config(ch);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_dreq(&c, n ? DREQ_UART1_TX : DREQ_UART0_TX);
+    channel_config_set_ring(&c, 0, log2_u32(UART_TX_BUFFER_SIZE));
+    dma_channel_configure(ch, &c, &UART_DR(n), tx_buffers[n], 0, 0);
+
+    dma_channel_acknowledge_irq1(ch);
+    dma_channel_set_irq1_enabled(ch, 1);
+    irq_set_enabled(DMA_IRQ_1, 1);
+
+    const enum irq_num irq = n ? UART1_IRQ : UART0_IRQ;
+    UART_ICR(n) = UART_INT_ALL;
+    UART_IMSC(n) = UART_INT_RX | UART_INT_RT | UART_INT_OE;
+    irq_set_enabled(irq, 1);
+
+    return actual;
+}
+
+static uint32_t tx_enqueue(uint32_t n, const void *data, uint32_t len,
+                           int all_or_nothing) {
+    struct uart_port *p = &ports[n];
+    const uint8_t *src = data;
+    uint8_t *buf = tx_buffers[n];
+
+    critical_section_enter_blocking(&p->tx_lock);
+
+    uint32_t head = p->tx_head;
+    const uint32_t space = UART_TX_BUFFER_SIZE - (head - p->tx_tail);
+    uint32_t count = len < space ? len : space;
+    if (all_or_nothing && count != len) {
+        count = 0;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        buf[head++ & (UART_TX_BUFFER_SIZE - 1u)] = src[i];
+    }
+    p->tx_head = head;
+    p->stats.tx_dropped += len - count;
+
+    tx_kick(p, n);
+
+    critical_section_exit(&p->tx_lock);
+    return count;
+}
+
+uint32_t uart_write(uint32_t n, const void *data, uint32_t len) {
+    return tx_enqueue(n, data, len, 0);
+}
+
+int uart_write_all(uint32_t n, const void *data, uint32_t len) {
+    return tx_enqueue(n, data, len, 1) == len ? 0 : -1;
+}
+
+uint32_t uart_read(uint32_t n, void *data, uint32_t len) {
+    struct uart_port *p = &ports[n];
+    const uint8_t *buf = rx_buffers[n];
+    uint8_t *dst = data;
+    uint32_t tail = p->rx_tail;
+    const uint32_t avail = p->rx_head - tail;
+    const uint32_t count = len < avail ? len : avail;
+
+    /* Ordering against the handler's buffer writes, as in spsc.h           */
+    __asm volatile ("dmb" ::: "memory");
+
+    for (uint32_t i = 0; i < count; i++) {
+        dst[i] = buf[tail++ & (UART_RX_BUFFER_SIZE - 1u)];
+    }
+
+    __asm volatile ("dmb" ::: "memory");
+    p->rx_tail = tail;
+    return count;
+}
+
+uint32_t uart_rx_available(uint32_t n) {
+    return ports[n].rx_head - ports[n].rx_tail;
+}
+
+uint32_t uart_tx_pending(uint32_t n) {
+    return ports[n].tx_head - ports[n].tx_tail;
+}
+
+void uart_set_rx_notify(uint32_t n, struct task *task, uint32_t bits) {
+    ports[n].rx_bits = bits;
+    ports[n].rx_task = task;
+}
+
+const struct uart_stats *uart_get_stats(uint32_t n) {
+    return &ports[n].stats;
+}
+
+void uart0_putc(char c) {
+    (void)uart_write(0, &c, 1);
+}
+
+void uart1_putc(char c) {
+    (void)uart_write(1, &c, 1);
+}
+
+/* ── Interrupt handlers ──────────────────────────────────────────────────── */
+
+static void uart_rx_irq(uint32_t n) {
+    struct uart_port *p = &ports[n];
+    uint8_t *buf = rx_buffers[n];
+    uint32_t head = p->rx_head;
+    const uint32_t start = head;
+
+    if (UART_MIS(n) & UART_INT_OE) {
+        p->stats.rx_overruns++;
+    }
+    /* RX and RT clear themselves once the FIFO is drained below the level */
+    UART_ICR(n) = UART_INT_OE;
+
+    while (!(UART_FR(n) & UART_FR_RXFE)) {
+        const uint32_t dr = UART_DR(n);
+        if (dr & (UART_DR_FE | UART_DR_PE | UART_DR_BE)) {
+            p->stats.rx_errors++;
+            continue;
+        }
+        if (head - p->rx_tail >= UART_RX_BUFFER_SIZE) {
+            p->stats.rx_dropped++;
+            continue;
+        }
+        buf[head++ & (UART_RX_BUFFER_SIZE - 1u)] =
+            (uint8_t)FIELD_GET(UART_DR_DATA, dr);
+    }
+
+    __asm volatile ("dmb" ::: "memory");
+    p->rx_head = head;
+
+    struct task *task = p->rx_task;
+    if (task && head != start) {
+        task_notify(task, p->rx_bits);
+    }
+}
+
+void UART0_IRQ_Handler(void) {
+    uart_rx_irq(0);
+}
+
+void UART1_IRQ_Handler(void) {
+    uart_rx_irq(1);
+}
+
+/* A TX transfer finished: retire its bytes and send what queued meanwhile.
+   The lock keeps out a writer on the other core mid-update.                */
+void DMA_IRQ1_Handler(void) {
+    for (uint32_t n = 0; n < UART_NUM; n++) {
+        struct uart_port *p = &ports[n];
+        if (p->tx_dma < 0 || !(DMA_INTS1 & (1u << p->tx_dma))) {
+            continue;
+        }
+        dma_channel_acknowledge_irq1((uint32_t)p->tx_dma);
+
+        critical_section_enter_blocking(&p->tx_lock);
+        p->tx_tail += p->tx_in_flight;
+        p->tx_in_flight = 0;
+        tx_kick(p, n);
+        critical_section_exit(&p->tx_lock);
+    }
+}
@@ -0,0 +1,144 @@
+#ifndef UART_H
+#define UART_H
+
+#include <stdint.h>
+#include "rp2040.h"
+#include "sched.h"
+
+/* ── UART ────────────────────────────────────────────────────────────────────
+   Two ARM PL011 UARTs, each with 32-entry TX and RX FIFOs. The register
+   layout is the PL011's; only the base addresses are RP2040-specific.
+   ────────────────────────────────────────────────────────────────────────── */
+#define UART0_BASE              0x40034000u
+#define UART1_BASE              0x40038000u
+#define UART_NUM                2u
+
+#define UART_BASE(n)            ((n) ? UART1_BASE : UART0_BASE)
+#define UART_DR(n)              MMIO32(UART_BASE(n) + 0x000)
+#define UART_RSR(n)             MMIO32(UART_BASE(n) + 0x004)
+#define UART_FR(n)              MMIO32(UART_BASE(n) + 0x018)
+#define UART_IBRD(n)            MMIO32(UART_BASE(n) + 0x024)
+#define UART_FBRD(n)            MMIO32(UART_BASE(n) + 0x028)
+#define UART_LCR_H(n)           MMIO32(UART_BASE(n) + 0x02C)
+#define UART_CR(n)              MMIO32(UART_BASE(n) + 0x030)
+#define UART_IFLS(n)            MMIO32(UART_BASE(n) + 0x034)
+#define UART_IMSC(n)            MMIO32(UART_BASE(n) + 0x038)
+#define UART_MIS(n)             MMIO32(UART_BASE(n) + 0x040)
+#define UART_ICR(n)             MMIO32(UART_BASE(n) + 0x044)
+#define UART_DMACR(n)           MMIO32(UART_BASE(n) + 0x048)
+
+/* DR: the received byte plus the error flags that came with it             */
+#define UART_DR_DATA_LSB        0
+#define UART_DR_DATA_MASK       (0xFFu << UART_DR_DATA_LSB)
+#define UART_DR_FE              (1u << 8)   /* framing error                */
+#define UART_DR_PE              (1u << 9)   /* parity error                 */
+#define UART_DR_BE              (1u << 10)  /* break                        */
+#define UART_DR_OE              (1u << 11)  /* FIFO overrun                 */
+#define UART_DR_ERRORS_LSB      8
+#define UART_DR_ERRORS_MASK     (0xFu << UART_DR_ERRORS_LSB)
+
+/* Baud divisor: 16-bit integer part, 6-bit fraction                        */
+#define UART_IBRD_MASK          0xFFFFu
+#define UART_FBRD_MASK          0x3Fu
+
+#define UART_FR_BUSY            (1u << 3)
+#define UART_FR_RXFE            (1u << 4)
+#define UART_FR_TXFF            (1u << 5)
+#define UART_FR_TXFE            (1u << 7)
+
+#define UART_LCR_H_FEN          (1u << 4)
+#define UART_LCR_H_WLEN_LSB     5
+#define UART_LCR_H_WLEN_MASK    (3u << UART_LCR_H_WLEN_LSB)
+#define UART_LCR_H_WLEN_8       FIELD_PREP(UART_LCR_H_WLEN, 3)
+
+#define UART_CR_UARTEN          (1u << 0)
+#define UART_CR_TXE             (1u << 8)
+#define UART_CR_RXE             (1u << 9)
+
+/* IMSC / MIS / ICR share one bit layout                                    */
+#define UART_INT_RX             (1u << 4)   /* RX FIFO at or above IFLS     */
+#define UART_INT_RT             (1u << 6)   /* receive timeout              */
+#define UART_INT_OE             (1u << 10)  /* overrun                      */
+#define UART_INT_ALL            0x7FFu
+
+/* IFLS RXIFLSEL: 2 = interrupt when the RX FIFO is half full (16 bytes)    */
+#define UART_IFLS_RXIFLSEL_LSB  3
+#define UART_IFLS_RXIFLSEL_MASK (7u << UART_IFLS_RXIFLSEL_LSB)
+#define UART_IFLS_RX_HALF       FIELD_PREP(UART_IFLS_RXIFLSEL, 2)
+
+#define UART_DMACR_TXDMAE       (1u << 1)
+
+#define RESET_UART0             (1u << 22)
+#define RESET_UART1             (1u << 23)
+
+/* DMA pacing: each UART raises TX and RX data requests                     */
+#define DREQ_UART0_TX           20u
+#define DREQ_UART1_TX           22u
+
+/* ── Buffered driver ─────────────────────────────────────────────────────────
+   Nothing here waits for the wire.
+
+   TX: uart_write() copies into a ring buffer and returns. A DMA channel,
+   paced by the UART's TX DREQ, reads the ring with its hardware address
+   wrap, so one transfer covers any run of pending bytes even across the
+   end of the buffer. When it finishes, DMA_IRQ_1 queues whatever arrived
+   meanwhile. If the ring is full the excess is dropped and counted —
+   losing a log line is better than stalling the control loop.
+
+   RX: the FIFO interrupt fires at half full; the receive timeout fires
+   once the line has been idle for 32 bit periods with bytes still in the
+   FIFO, so a short message is not held back waiting for more. Both drain
+   the FIFO into the RX ring and, if set, notify a task.
+
+   DMA_IRQ_1 belongs to this driver; other DMA users take DMA_IRQ_0.
+
+   Writers on both cores (or a task and an ISR) may share a port; the TX
+   ring is guarded by a critical section. Each RX ring has one reader.
+   ────────────────────────────────────────────────────────────────────────── */
+#ifndef UART_TX_BUFFER_SIZE
+#define UART_TX_BUFFER_SIZE     512u    /* power of two, 2..32768           */
+#endif
+#ifndef UART_RX_BUFFER_SIZE
+#define UART_RX_BUFFER_SIZE     128u    /* power of two                     */
+#endif
+
+struct uart_stats {
+    uint32_t tx_dropped;    /* bytes uart_write() had no room for           */
+    uint32_t rx_dropped;    /* bytes lost because the RX ring was full      */
+    uint32_t rx_overruns;   /* hardware FIFO overruns                       */
+    uint32_t rx_errors;     /* bytes received with framing/parity/break     */
+};
+
+/* Set up port n (0 or 1) at 8N1 on the given GPIOs (TX/RX functions: UART0
+   on GPIO 0/1, 12/13, 16/17, 28/29; UART1 on 4/5, 8/9, 20/21, 24/25). The
+   divisor comes from clk_peri as actually configured. Returns the baud
+   rate achieved, or 0 if no DMA channel or lock was free.                  */
+uint32_t uart_init(uint32_t n, uint32_t baud, uint32_t tx_pin,
+                   uint32_t rx_pin);
+
+/* Queue len bytes. Returns how many fit; the rest were dropped.            */
+uint32_t uart_write(uint32_t n, const void *data, uint32_t len);
+
+/* Queue all len bytes, or none if they do not fit: for framed records
+   that would be garbage if cut short. Returns 0, or -1 if dropped.        */
+int uart_write_all(uint32_t n, const void *data, uint32_t len);
+
+/* Copy up to len received bytes out of the RX ring. Returns the count.     */
+uint32_t uart_read(uint32_t n, void *data, uint32_t len);
+
+/* Received bytes waiting in the RX ring                                    */
+uint32_t uart_rx_available(uint32_t n);
+
+/* Bytes accepted by uart_write() and not yet handed to the FIFO            */
+uint32_t uart_tx_pending(uint32_t n);
+
+/* Notify task with bits whenever bytes arrive (task NULL to stop)          */
+void uart_set_rx_notify(uint32_t n, struct task *task, uint32_t bits);
+
+const struct uart_stats *uart_get_stats(uint32_t n);
+
+/* print.h sinks, for print_str(uart0_putc, ...) and the *_dump() reports   */
+void uart0_putc(char c);
+void uart1_putc(char c);
+
+#endif
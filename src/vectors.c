@@ -1,4 +1,5 @@
 #include <stdint.h>
+#include "irq.h"
 
 /* --- Symbols we need from other files -------------------------------------
     _stack_top comes from the linker script - the address of the top of RAM.
@@ -57,6 +58,8 @@ void PIO1_IRQ1_Handler(void)   __attribute__((weak, alias("Default_Handler")));
 void DMA_IRQ0_Handler(void)    __attribute__((weak, alias("Default_Handler")));
 void DMA_IRQ1_Handler(void)    __attribute__((weak, alias("Default_Handler")));
 void IO_IRQ_Handler(void)      __attribute__((weak, alias("Default_Handler")));
+void SIO_IRQ_PROC0_Handler(void) __attribute__((weak, alias("Default_Handler")));
+void SIO_IRQ_PROC1_Handler(void) __attribute__((weak, alias("Default_Handler")));
 void SPI0_IRQ_Handler(void)    __attribute__((weak, alias("Default_Handler")));
 void SPI1_IRQ_Handler(void)    __attribute__((weak, alias("Default_Handler")));
 void UART0_IRQ_Handler(void)   __attribute__((weak, alias("Default_Handler")));
@@ -77,13 +80,17 @@ void RTC_IRQ_Handler(void)     __attribute__((weak, alias("Default_Handler")));
 
     On cortex-M0+ the layout is fixed by the ARM architecture spec:
     entries 0-15 are system exceptions, entries 16+ are external IRQs.
+
+    The array is sized for all 32 NVIC lines so irq.c can copy it into RAM
+    as a whole (RAM_VECTOR_TABLE). Entries left out below are zero.
     ---------------------------------------------------------------------------*/
 
 __attribute__((section(".vectors")))
-const uint32_t vector_table[] = {
+const uint32_t vector_table[VECTOR_TABLE_ENTRIES] = {
     /* Entry 0 - Initial Stack pointer value
         Not a function pointer - the CPU loads this directly into SP register
-        _stack_top is the top of RAM (0X20042000) defined in linker.ld.      */
+        _stack_top is the top of SCRATCH_X (0X20041000) defined in linker.ld.
+        Core 1 ignores it: multicore_launch_core1() gives it its own SP.     */
     (uint32_t)&_stack_top,
 
     /* System exceptions — entries 1 to 15 */
@@ -119,8 +126,8 @@ const uint32_t vector_table[] = {
     (uint32_t)&DMA_IRQ1_Handler,   /* 28 - IRQ12 DMA 1                     */
     (uint32_t)&IO_IRQ_Handler,     /* 29 - IRQ13 GPIO                      */
     0,                             /* 30 - IRQ14 QSPI                      */
-    0,                             /* 31 - IRQ15 SIO PROC0                 */
-    0,                             /* 32 - IRQ16 SIO PROC1                 */
+    (uint32_t)&SIO_IRQ_PROC0_Handler, /* 31 - IRQ15 SIO FIFO, core 0     */
+    (uint32_t)&SIO_IRQ_PROC1_Handler, /* 32 - IRQ16 SIO FIFO, core 1     */
     0,                             /* 33 - IRQ17 Clocks                    */
     (uint32_t)&SPI0_IRQ_Handler,   /* 34 - IRQ18 SPI0                      */
     (uint32_t)&SPI1_IRQ_Handler,   /* 35 - IRQ19 SPI1                      */
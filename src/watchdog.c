@@ -0,0 +1,142 @@
+#include <stdint.h>
+#include "rp2040.h"
+#include "irq.h"
+#include "print.h"
+#include "swtimer.h"
+#include "timer.h"
+#include "watchdog.h"
+
+/* What the supervisor leaves in the scratch registers when a client misses */
+#define WATCHDOG_MISS_MAGIC     0x11E6A7C4u
+#define SCRATCH_MISS_MAGIC      0u
+#define SCRATCH_MISS_NAME       1u
+#define SCRATCH_MISS_LATE_US    2u
+#define SCRATCH_MISS_DEADLINE   3u
+
+/* A name is only printed if it still points into the image's Flash        */
+#define WATCHDOG_FLASH_START    0x10000000u
+#define WATCHDOG_FLASH_END      0x10200000u
+
+static struct watchdog_client *clients;
+static struct swtimer check_timer;
+static uint32_t load_value;
+static volatile int tripped;
+
+/* The TIMER_IRQ_0 callback: feed only if nobody is late                   */
+static void supervise(struct swtimer *timer) {
+    const uint32_t now = time_us_32();
+    (void)timer;
+
+    for (struct watchdog_client *c = clients; c; c = c->next) {
+        const uint32_t gap = now - c->last_us;
+        if (gap <= c->deadline_us) {
+            continue;
+        }
+        c->misses++;
+        if (!tripped) {
+            tripped = 1;
+            WATCHDOG_SCRATCH(SCRATCH_MISS_NAME) = (uint32_t)c->name;
+            WATCHDOG_SCRATCH(SCRATCH_MISS_LATE_US) = gap - c->deadline_us;
+            WATCHDOG_SCRATCH(SCRATCH_MISS_DEADLINE) = c->deadline_us;
+            WATCHDOG_SCRATCH(SCRATCH_MISS_MAGIC) = WATCHDOG_MISS_MAGIC;
+        }
+    }
+
+    if (!tripped) {
+        WATCHDOG_LOAD = FIELD_PREP(WATCHDOG_LOAD, load_value);
+    }
+}
+
+void watchdog_supervisor_start(uint32_t timeout_ms) {
+    if (timeout_ms > WATCHDOG_MAX_TIMEOUT_MS) {
+        timeout_ms = WATCHDOG_MAX_TIMEOUT_MS;
+    }
+    load_value = 2u * 1000u * timeout_ms;       /* RP2040-E1               */
+    WATCHDOG_SCRATCH(SCRATCH_MISS_MAGIC) = 0;
+
+    PSM_WDSEL = PSM_WDSEL_ALL & ~(PSM_WDSEL_ROSC | PSM_WDSEL_XOSC);
+    WATCHDOG_LOAD = FIELD_PREP(WATCHDOG_LOAD, load_value);
+    WATCHDOG_CTRL = WATCHDOG_CTRL_ENABLE | WATCHDOG_CTRL_PAUSE_JTAG
+                  | WATCHDOG_CTRL_PAUSE_DBG0 | WATCHDOG_CTRL_PAUSE_DBG1;
+
+    const uint32_t period_us = 250u * timeout_ms;
+    swtimer_start(&check_timer, period_us, period_us, supervise, 0);
+}
+
+void watchdog_client_register(struct watchdog_client *c, const char *name,
+                              uint32_t deadline_us) {
+    c->name = name;
+    c->deadline_us = deadline_us;
+    c->last_us = time_us_32();
+    c->checkins = 0;
+    c->min_period_us = 0xFFFFFFFFu;
+    c->max_period_us = 0;
+    c->total_period_us = 0;
+    c->misses = 0;
+
+    /* supervise() walks the list from the timer interrupt                  */
+    const uint32_t primask = save_and_disable_interrupts();
+    c->next = clients;
+    clients = c;
+    restore_interrupts(primask);
+}
+
+void watchdog_checkin(struct watchdog_client *c) {
+    const uint32_t now = time_us_32();
+    const uint32_t period = now - c->last_us;
+
+    c->last_us = now;
+    c->checkins++;
+    c->total_period_us += period;
+    if (period < c->min_period_us) {
+        c->min_period_us = period;
+    }
+    if (period > c->max_period_us) {
+        c->max_period_us = period;
+    }
+}
+
+void watchdog_report(putc_fn out) {
+    for (const struct watchdog_client *c = clients; c; c = c->next) {
+        const uint32_t n = c->checkins;
+        print_str(out, "W ");
+        print_str(out, c->name);
+        print_str(out, " checkins=");
+        print_dec(out, n);
+        print_str(out, " min=");
+        print_dec(out, n ? c->min_period_us : 0);
+        print_str(out, " avg=");
+        print_dec(out, n ? (uint32_t)(c->total_period_us / n) : 0);
+        print_str(out, " max=");
+        print_dec(out, c->max_period_us);
+        print_str(out, " deadline=");
+        print_dec(out, c->deadline_us);
+        print_str(out, " misses=");
+        print_dec(out, c->misses);
+        print_str(out, "\r\n");
+    }
+}
+
+int watchdog_report_reset(putc_fn out) {
+    if (!(watchdog_reset_reason() & WATCHDOG_REASON_TIMER)) {
+        return 0;
+    }
+
+    print_str(out, "watchdog reset");
+    if (WATCHDOG_SCRATCH(SCRATCH_MISS_MAGIC) == WATCHDOG_MISS_MAGIC) {
+        const uint32_t name = WATCHDOG_SCRATCH(SCRATCH_MISS_NAME);
+        print_str(out, ": ");
+        if (name >= WATCHDOG_FLASH_START && name < WATCHDOG_FLASH_END) {
+            print_str(out, (const char *)name);
+        } else {
+            print_hex(out, name);
+        }
+        print_str(out, " late_us=");
+        print_dec(out, WATCHDOG_SCRATCH(SCRATCH_MISS_LATE_US));
+        print_str(out, " deadline_us=");
+        print_dec(out, WATCHDOG_SCRATCH(SCRATCH_MISS_DEADLINE));
+        WATCHDOG_SCRATCH(SCRATCH_MISS_MAGIC) = 0;
+    }
+    print_str(out, "\r\n");
+    return 1;
+}
@@ -0,0 +1,123 @@
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include <stdint.h>
+#include "rp2040.h"
+#include "print.h"
+
+/* ── WATCHDOG ────────────────────────────────────────────────────────────────
+   CTRL:    TIME [23:0] — the count, decremented once per tick
+            PAUSE_JTAG / PAUSE_DBG0 / PAUSE_DBG1 — stop counting while a
+            debugger holds a core, so a breakpoint is not a reboot
+            ENABLE — count; reaching 0 resets the chip
+            TRIGGER — reset the chip now (self-clearing)
+   LOAD:    writing it reloads TIME — "feeding" the watchdog
+   REASON:  why the last reset happened: TIMER (ran out) or FORCE (TRIGGER);
+            0 after a power-on or RUN-pin reset
+   SCRATCH: 8 words that survive a watchdog reset. SCRATCH4-7 are read by
+            the bootrom on the way back up, so leave them alone.
+   TICK:    the 1 µs tick from clk_ref that both the watchdog and the TIMER
+            count (started by clocks_init)
+
+   Which blocks a watchdog reset actually resets is chosen in the PSM's
+   WDSEL register: everything but the oscillators, as the SDK does.
+   ────────────────────────────────────────────────────────────────────────── */
+#define WATCHDOG_BASE             0x40058000u
+#define WATCHDOG_CTRL             MMIO32(WATCHDOG_BASE + 0x00)
+#define WATCHDOG_LOAD             MMIO32(WATCHDOG_BASE + 0x04)
+#define WATCHDOG_REASON           MMIO32(WATCHDOG_BASE + 0x08)
+#define WATCHDOG_SCRATCH(n)       MMIO32(WATCHDOG_BASE + 0x0C + 4u * (n))
+#define WATCHDOG_TICK             MMIO32(WATCHDOG_BASE + 0x2C)
+
+#define WATCHDOG_CTRL_TIME_LSB    0
+#define WATCHDOG_CTRL_TIME_MASK   (0xFFFFFFu << WATCHDOG_CTRL_TIME_LSB)
+#define WATCHDOG_CTRL_PAUSE_JTAG  (1u << 24)
+#define WATCHDOG_CTRL_PAUSE_DBG0  (1u << 25)
+#define WATCHDOG_CTRL_PAUSE_DBG1  (1u << 26)
+#define WATCHDOG_CTRL_ENABLE      (1u << 30)
+#define WATCHDOG_CTRL_TRIGGER     (1u << 31)
+
+#define WATCHDOG_LOAD_LSB         0
+#define WATCHDOG_LOAD_MASK        (0xFFFFFFu << WATCHDOG_LOAD_LSB)
+
+#define WATCHDOG_REASON_TIMER     (1u << 0)
+#define WATCHDOG_REASON_FORCE     (1u << 1)
+
+#define WATCHDOG_TICK_CYCLES_LSB  0
+#define WATCHDOG_TICK_CYCLES_MASK (0x1FFu << WATCHDOG_TICK_CYCLES_LSB)
+#define WATCHDOG_TICK_ENABLE      (1u << 9)
+
+#define PSM_WDSEL                 MMIO32(0x40010000u + 0x008)
+#define PSM_WDSEL_ALL             0x0001FFFFu
+#define PSM_WDSEL_ROSC            (1u << 0)
+#define PSM_WDSEL_XOSC            (1u << 1)
+
+/* Reset the chip at once. Inline and register-only, so it is safe from a
+   fault handler whatever state XIP and the stacks are in.                 */
+static inline __attribute__((always_inline, noreturn))
+void watchdog_reboot_now(void) {
+    PSM_WDSEL = PSM_WDSEL_ALL & ~(PSM_WDSEL_ROSC | PSM_WDSEL_XOSC);
+    WATCHDOG_CTRL = WATCHDOG_CTRL_TRIGGER;
+    while (1);
+}
+
+/* WATCHDOG_REASON_* bits for the reset that started this boot             */
+static inline uint32_t watchdog_reset_reason(void) {
+    return WATCHDOG_REASON;
+}
+
+/* ── Supervisor ──────────────────────────────────────────────────────────────
+   The watchdog is not fed by whoever happens to run; it is fed by a
+   periodic software timer, and only while every registered client (a
+   task, core 1's loop, a polling loop in main) has checked in within its
+   own deadline. One stuck or overrunning client stops the feeding and the
+   chip resets one timeout later. A dead timer interrupt, or interrupts
+   masked for good, stops it too.
+
+   The first client to miss is written into WATCHDOG_SCRATCH0-3, which
+   survive the reset; watchdog_report_reset() names it on the next boot.
+   Every check-in also updates the client's loop period statistics, so the
+   same hooks measure how close each loop runs to its deadline.
+
+   RP2040-E1: the counter decrements twice per tick, so LOAD holds twice
+   the timeout in µs — at most 0xFFFFFF, i.e. a timeout of 8.3 s.
+
+   Register clients on core 0 before they check in; check in from either
+   core. Time counts from registration, so a client is not late before its
+   first check-in until a whole deadline has passed.
+   ────────────────────────────────────────────────────────────────────────── */
+#define WATCHDOG_MAX_TIMEOUT_MS   (WATCHDOG_LOAD_MASK / 2000u)
+
+struct watchdog_client {
+    const char *name;
+    uint32_t deadline_us;               /* longest allowed check-in gap    */
+    volatile uint32_t last_us;          /* time of the last check-in       */
+    uint32_t checkins;                  /* gaps measured so far            */
+    uint32_t min_period_us;
+    uint32_t max_period_us;
+    uint64_t total_period_us;
+    volatile uint32_t misses;           /* checks that found it late       */
+    struct watchdog_client *next;
+};
+
+/* Enable the watchdog with the given timeout and start supervising, a
+   check every quarter timeout. Call after swtimer_init(). The timeout has
+   to cover the longest stretch with interrupts masked (a flash sector
+   erase, see flash.h).                                                     */
+void watchdog_supervisor_start(uint32_t timeout_ms);
+
+void watchdog_client_register(struct watchdog_client *c, const char *name,
+                              uint32_t deadline_us);
+
+/* "Still alive". Call once per loop iteration.                           */
+void watchdog_checkin(struct watchdog_client *c);
+
+/* One line per client:
+       W name checkins= min= avg= max= deadline= misses=                   */
+void watchdog_report(putc_fn out);
+
+/* If the last reset was the watchdog running out, say so and name the
+   client that missed (if one did). Returns 1 if it printed.               */
+int  watchdog_report_reset(putc_fn out);
+
+#endif
@@ -0,0 +1,67 @@
+#include <stdint.h>
+#include "rp2040.h"
+#include "dma.h"
+#include "xip.h"
+
+static void stream_fifo_drain(void) {
+    while (!(XIP_STAT & XIP_STAT_FIFO_EMPTY)) {
+        (void)XIP_STREAM_FIFO;
+    }
+}
+
+void xip_cache_set_enabled(int enabled) {
+    if (enabled) {
+        xip_cache_flush();
+        hw_set_bits(&XIP_CTRL, XIP_CTRL_EN);
+    } else {
+        hw_clear_bits(&XIP_CTRL, XIP_CTRL_EN);
+    }
+}
+
+void *xip_cache_pin(uint32_t xip_addr, uint32_t size) {
+    volatile uint32_t *p = (volatile uint32_t *)xip_addr;
+
+    for (uint32_t i = 0; i < size / 4u; i++) {
+        p[i] = 0;
+    }
+    return (void *)xip_addr;
+}
+
+int xip_stream_start(uint32_t ch, const void *src, void *dst,
+                     uint32_t words) {
+    /* STREAM_CTR holds 22 bits: a longer stream would stop short and leave
+       the channel waiting on its DREQ for good                            */
+    if (words > XIP_STREAM_CTR_MAX) {
+        return -1;
+    }
+
+    /* A stream left running (or its leftovers) would feed the new channel */
+    XIP_STREAM_CTR = 0;
+    stream_fifo_drain();
+
+    dma_channel_config c = dma_channel_get_default_config(ch);
+    channel_config_set_read_increment(&c, 0);
+    channel_config_set_write_increment(&c, 1);
+    channel_config_set_dreq(&c, DREQ_XIP_STREAM);
+    dma_channel_configure(ch, &c, dst, (const volatile void *)XIP_AUX_BASE,
+                          words, 1);
+
+    /* Writing the count is what starts the fetches                        */
+    XIP_STREAM_ADDR = (uint32_t)src;
+    XIP_STREAM_CTR = FIELD_PREP(XIP_STREAM_CTR, words);
+    return 0;
+}
+
+int xip_stream_is_busy(uint32_t ch) {
+    return dma_channel_is_busy(ch);
+}
+
+void xip_stream_wait(uint32_t ch) {
+    dma_channel_wait_for_finish_blocking(ch);
+}
+
+void xip_stream_abort(uint32_t ch) {
+    XIP_STREAM_CTR = 0;
+    dma_channel_abort(ch);
+    stream_fifo_drain();
+}
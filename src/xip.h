@@ -0,0 +1,138 @@
+#ifndef XIP_H
+#define XIP_H
+
+#include <stdint.h>
+#include "rp2040.h"
+
+/* ── XIP address windows ─────────────────────────────────────────────────────
+   The same flash contents appear at four aliases with different cache
+   behaviour:
+   0x10000000  cached, allocating      — normal code and rodata fetches
+   0x11000000  cached, no allocate     — hits are served, misses are not
+                                         cached: read a big table without
+                                         evicting the code around it
+   0x12000000  no cache, allocating
+   0x13000000  no cache, no allocate   — every access goes to the QSPI bus
+
+   The cache itself is 16 KiB, two-way set associative, 8-byte lines. With
+   it disabled its memory appears as plain SRAM at 0x15000000.
+   ────────────────────────────────────────────────────────────────────────── */
+#define XIP_BASE                    0x10000000u
+#define XIP_NOALLOC_BASE            0x11000000u
+#define XIP_NOCACHE_BASE            0x12000000u
+#define XIP_NOCACHE_NOALLOC_BASE    0x13000000u
+#define XIP_SRAM_BASE               0x15000000u
+#define XIP_ALIAS_MASK              0x00FFFFFFu     /* offset within a window */
+
+#define XIP_CACHE_SIZE              (16u * 1024u)
+#define XIP_CACHE_WAY_SIZE          (8u * 1024u)
+#define XIP_CACHE_LINE_SIZE         8u
+
+/* ── XIP_CTRL ────────────────────────────────────────────────────────────────
+   CTRL:   EN   — cache enabled; 0 turns it into SRAM and sends every
+                  access to flash
+   FLUSH:  writing 1 invalidates every tag (pinned lines included); reading
+           it back stalls until the flush has completed
+   STAT:   FIFO_EMPTY / FIFO_FULL for the stream FIFO
+   CTR_HIT / CTR_ACC: cache hits / all cacheable accesses, write to clear
+   STREAM_ADDR / STREAM_CTR / STREAM_FIFO: the streaming interface below
+   ────────────────────────────────────────────────────────────────────────── */
+#define XIP_CTRL_BASE               0x14000000u
+#define XIP_CTRL                    MMIO32(XIP_CTRL_BASE + 0x00)
+#define XIP_FLUSH                   MMIO32(XIP_CTRL_BASE + 0x04)
+#define XIP_STAT                    MMIO32(XIP_CTRL_BASE + 0x08)
+#define XIP_CTR_HIT                 MMIO32(XIP_CTRL_BASE + 0x0C)
+#define XIP_CTR_ACC                 MMIO32(XIP_CTRL_BASE + 0x10)
+#define XIP_STREAM_ADDR             MMIO32(XIP_CTRL_BASE + 0x14)
+#define XIP_STREAM_CTR              MMIO32(XIP_CTRL_BASE + 0x18)
+#define XIP_STREAM_FIFO             MMIO32(XIP_CTRL_BASE + 0x1C)
+
+#define XIP_CTRL_EN                 (1u << 0)
+#define XIP_STAT_FIFO_EMPTY         (1u << 1)
+#define XIP_STAT_FIFO_FULL          (1u << 2)
+#define XIP_STREAM_CTR_LSB          0
+#define XIP_STREAM_CTR_MASK         (0x3FFFFFu << XIP_STREAM_CTR_LSB)
+#define XIP_STREAM_CTR_MAX          (XIP_STREAM_CTR_MASK >> XIP_STREAM_CTR_LSB)
+
+/* The stream FIFO again, on the DMA's fast AHB port                        */
+#define XIP_AUX_BASE                0x50400000u
+#define DREQ_XIP_STREAM             37u
+
+/* ── Cache control ───────────────────────────────────────────────────────── */
+
+/* Inline so a TIME_CRITICAL caller does not branch back into Flash         */
+static inline __attribute__((always_inline)) void xip_cache_flush(void) {
+    XIP_FLUSH = 1;
+    (void)XIP_FLUSH;
+}
+
+/* Disabling leaves code running from Flash at raw QSPI speed, and makes the
+   whole 16 KiB available at XIP_SRAM_BASE. Enabling again starts from a
+   flushed cache: the SRAM contents are not valid tags.                    */
+void xip_cache_set_enabled(int enabled);
+
+/* Counters since the last xip_cache_reset_counters()                       */
+static inline uint32_t xip_cache_hits(void) {
+    return XIP_CTR_HIT;
+}
+
+static inline uint32_t xip_cache_accesses(void) {
+    return XIP_CTR_ACC;
+}
+
+static inline void xip_cache_reset_counters(void) {
+    XIP_CTR_HIT = 0;
+    XIP_CTR_ACC = 0;
+}
+
+/* The no-allocate view of a flash pointer: reads hit the cache if the data
+   happens to be there but never bring new lines in                        */
+static inline const void *xip_noalloc_ptr(const void *p) {
+    return (const void *)(((uint32_t)p & XIP_ALIAS_MASK) | XIP_NOALLOC_BASE);
+}
+
+/* ── Pinned lines as SRAM ────────────────────────────────────────────────────
+   With the cache enabled, a write through the cached window allocates the
+   line and pins it: it is never evicted and never written back, so it
+   behaves as RAM at that address while the rest of the cache keeps serving
+   code. xip_cache_pin() zero-fills [xip_addr, xip_addr + size) that way and
+   returns it as a pointer.
+
+   Each 8 KiB of address space maps onto one way of the cache. A pinned
+   region of up to 8 KiB costs code one way in the sets it covers; more than
+   that leaves those sets with no way for code at all. Pick an address the
+   image does not use (XIP_PIN_DEFAULT_ADDR is at the top of the 16 MiB
+   window, far above the 2 MiB of flash) and keep it 8-byte aligned.
+
+   A flush (xip_cache_flush(), or xip_cache_set_enabled()) drops the pins
+   and their contents.
+   ────────────────────────────────────────────────────────────────────────── */
+#define XIP_PIN_DEFAULT_ADDR        (XIP_BASE + 0x00FF0000u)
+
+void *xip_cache_pin(uint32_t xip_addr, uint32_t size);
+
+/* ── Streaming ───────────────────────────────────────────────────────────────
+   STREAM_ADDR/STREAM_CTR make the XIP controller fetch words from flash
+   into a 2-entry FIFO in the gaps between code fetches, bypassing the cache
+   entirely; a DMA channel paced by DREQ_XIP_STREAM empties it. Big assets
+   reach RAM without evicting a single line of hot code, and the CPU keeps
+   running while they do.
+
+       xip_stream_start(ch, wave_table, buf, sizeof(buf) / 4);
+       ... other work ...
+       xip_stream_wait(ch);
+
+   One stream at a time. src must be word-aligned flash (any XIP window).
+   words is at most XIP_STREAM_CTR_MAX (just under 16 MiB); returns 0, or
+   -1 without starting anything for a longer stream.
+   ────────────────────────────────────────────────────────────────────────── */
+int  xip_stream_start(uint32_t ch, const void *src, void *dst, uint32_t words);
+
+int  xip_stream_is_busy(uint32_t ch);
+
+void xip_stream_wait(uint32_t ch);
+
+/* Stop a stream early and leave the FIFO empty for the next one            */
+void xip_stream_abort(uint32_t ch);
+
+#endif
@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+"""Decode DLOG() records (src/dlog.h) using the format strings in the ELF.
+
+    tools/dlog_decode.py firmware.elf capture.bin
+    stty -F /dev/ttyUSB0 115200 raw && tools/dlog_decode.py firmware.elf /dev/ttyUSB0
+
+Each record is: 0xD1, id (u16), nargs (u8), time_us (u32), nargs x u32,
+little-endian. The id is the string's offset in the ELF's .dlog section.
+Bytes that do not start a valid record are skipped, so the decoder
+resynchronises after a glitch or when attached mid-stream.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+SYNC = 0xD1
+HEADER = 8
+MAX_ARGS = 8
+
+SPEC = re.compile(r"%([-+ 0#]*\d*(?:\.\d+)?)(?:hh|h|ll|l|z|j|t)?([diuxXocfeEgGp%])")
+
+
+def load_strings(path):
+    """Map id -> format string from the .dlog section of an ELF32 file."""
+    with open(path, "rb") as f:
+        elf = f.read()
+    if elf[:4] != b"\x7fELF" or elf[4] != 1 or elf[5] != 1:
+        sys.exit(path + ": not a little-endian ELF32 file")
+
+    shoff, = struct.unpack_from("<I", elf, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from("<HHH", elf, 0x2E)
+
+    def header(i):
+        return struct.unpack_from("<IIIIII", elf, shoff + i * shentsize)
+
+    strtab = header(shstrndx)
+    names = elf[strtab[4]:strtab[4] + strtab[5]]
+
+    for i in range(shnum):
+        name, _type, _flags, addr, offset, size = header(i)
+        if names[name:names.index(b"\0", name)] == b".dlog":
+            data = elf[offset:offset + size]
+            break
+    else:
+        sys.exit(path + ": no .dlog section (no DLOG() call sites?)")
+
+    strings = {}
+    pos = 0
+    while pos < len(data):
+        end = data.index(b"\0", pos)
+        strings[addr + pos] = data[pos:end].decode("utf-8", "replace")
+        pos = end + 1
+        while pos < len(data) and data[pos] == 0:    # alignment padding
+            pos += 1
+    return strings
+
+
+def arg_count(fmt):
+    return sum(1 for m in SPEC.finditer(fmt) if m.group(2) != "%")
+
+
+def render(fmt, args):
+    args = list(args)
+
+    def one(m):
+        flags, conv = m.group(1), m.group(2)
+        if conv == "%":
+            return "%"
+        v = args.pop(0)
+        if conv in "di":
+            v = v - (1 << 32) if v & 0x80000000 else v
+            conv = "d"
+        elif conv == "u":
+            conv = "d"
+        elif conv == "p":
+            return "0x%08x" % v
+        elif conv in "feEgG":
+            v, = struct.unpack("<f", struct.pack("<I", v))
+        elif conv == "c":
+            v = chr(v & 0xFF)
+        return ("%" + flags + conv) % v
+
+    return SPEC.sub(one, fmt)
+
+
+def records(stream, strings):
+    buf = b""
+    while True:
+        chunk = stream.read(256)
+        if not chunk:
+            return
+        buf += chunk
+        while True:
+            start = buf.find(bytes([SYNC]))
+            if start < 0:
+                buf = b""
+                break
+            buf = buf[start:]
+            if len(buf) < HEADER:
+                break
+            ident, nargs, time_us = struct.unpack_from("<HBI", buf, 1)
+            fmt = strings.get(ident)
+            if fmt is None or nargs > MAX_ARGS or arg_count(fmt) != nargs:
+                buf = buf[1:]                       # not a record: resync
+                continue
+            length = HEADER + 4 * nargs
+            if len(buf) < length:
+                break
+            args = struct.unpack_from("<%dI" % nargs, buf, HEADER)
+            buf = buf[length:]
+            yield time_us, render(fmt, args)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("elf", help="firmware .elf with the .dlog section")
+    ap.add_argument("input", nargs="?", default="-",
+                    help="captured bytes or a serial device (default stdin)")
+    args = ap.parse_args()
+
+    strings = load_strings(args.elf)
+    stream = sys.stdin.buffer if args.input == "-" else open(args.input, "rb",
+                                                             buffering=0)
+    for time_us, text in records(stream, strings):
+        print("%10.6f %s" % (time_us / 1e6, text), flush=True)
+
+
+if __name__ == "__main__":
+    main()
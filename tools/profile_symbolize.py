@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""Turn sampling-profiler PCs into a per-function histogram.
+
+Input is either the text printed by profile_dump() (the "S 0x........"
+lines; anything else is ignored) or, with --raw, a binary dump of
+profile_samples[] read over SWD, e.g. from gdb:
+
+    dump binary memory samples.bin &profile_samples[0] &profile_samples[1024]
+
+Symbols come from the ELF via arm-none-eabi-nm, or from the linker map
+file when no toolchain is at hand.
+
+    tools/profile_symbolize.py firmware.elf capture.txt
+    tools/profile_symbolize.py firmware.map --raw samples.bin
+"""
+
+import argparse
+import bisect
+import re
+import struct
+import subprocess
+import sys
+
+
+def symbols_from_elf(path, nm):
+    out = subprocess.run([nm, "-n", "-S", "--defined-only", path],
+                         check=True, capture_output=True, text=True).stdout
+    syms = []
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) == 4 and parts[2] in "tTwW":
+            syms.append((int(parts[0], 16), int(parts[1], 16), parts[3]))
+        elif len(parts) == 3 and parts[1] in "tTwW":
+            syms.append((int(parts[0], 16), 0, parts[2]))
+    return syms
+
+
+# ".text.name  0xADDR  0xSIZE  file.o" — the name may wrap onto its own line
+MAP_SECTION = re.compile(r"^\s*\.(?:text|time_critical)\.(\S+)\s*$")
+MAP_ENTRY = re.compile(r"^\s*(?:\.(?:text|time_critical)\.(\S+))?\s+"
+                       r"0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+\S+\.o\b")
+
+
+def symbols_from_map(path):
+    syms = []
+    pending = None
+    with open(path) as f:
+        for line in f:
+            m = MAP_SECTION.match(line)
+            if m:
+                pending = m.group(1)
+                continue
+            m = MAP_ENTRY.match(line)
+            if m:
+                name = m.group(1) or pending
+                size = int(m.group(3), 16)
+                if name and size:
+                    syms.append((int(m.group(2), 16), size, name))
+            pending = None
+    return syms
+
+
+def read_samples(path, raw):
+    if raw:
+        with open(path, "rb") as f:
+            data = f.read()
+        pcs = struct.unpack("<%dI" % (len(data) // 4), data[:len(data) & ~3])
+        return [pc for pc in pcs if pc]
+    pcs = []
+    with open(path, errors="replace") as f:
+        for line in f:
+            m = re.match(r"^S (0x[0-9a-fA-F]+)", line.strip())
+            if m:
+                pcs.append(int(m.group(1), 16))
+    return pcs
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("symbols", help="firmware .elf or .map")
+    ap.add_argument("samples", help="profile_dump() output, or --raw dump")
+    ap.add_argument("--raw", action="store_true",
+                    help="samples file is little-endian uint32 PCs")
+    ap.add_argument("--nm", default="arm-none-eabi-nm")
+    ap.add_argument("--top", type=int, default=30)
+    args = ap.parse_args()
+
+    if args.symbols.endswith(".map"):
+        syms = symbols_from_map(args.symbols)
+    else:
+        syms = symbols_from_elf(args.symbols, args.nm)
+    syms.sort()
+    starts = [s[0] for s in syms]
+
+    pcs = read_samples(args.samples, args.raw)
+    if not pcs:
+        sys.exit("no samples found in " + args.samples)
+
+    hist = {}
+    for pc in pcs:
+        pc &= ~1
+        i = bisect.bisect_right(starts, pc) - 1
+        name = "?"
+        if i >= 0:
+            addr, size, sym = syms[i]
+            if size == 0 or pc < addr + size:
+                name = sym
+        if name == "?":
+            name = "? 0x%08x" % pc
+        hist[name] = hist.get(name, 0) + 1
+
+    total = len(pcs)
+    print("%d samples" % total)
+    for name, n in sorted(hist.items(), key=lambda kv: -kv[1])[:args.top]:
+        print("%6d %5.1f%%  %s" % (n, 100.0 * n / total, name))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""Size and hot-path report for a firmware ELF, printed after every link.
+
+    tools/size_report.py pico-baremetal.elf [--top 15]
+
+Reads the section headers and the symbol table directly (no binutils
+needed) and prints:
+  - Flash and RAM use per section, against the linker.ld region sizes
+  - the largest functions and objects, the usual first targets for -Os
+  - every exception/interrupt handler with its size and whether it runs
+    from RAM or from Flash through the XIP cache (where a miss stalls the
+    handler for a QSPI transfer) — the static half of the speed report;
+    make bench measures the dynamic half on the device.
+"""
+
+import argparse
+import struct
+import sys
+
+FLASH_BYTES = (2048 - 64) * 1024 # linker.ld FLASH, KV_FLASH excluded
+RAM_BYTES = (256 - 32) * 1024   # striped RAM, SRAM_BANKn excluded
+STACK_BYTES = (4 + 4 + 4) * 1024  # STACK0_LOW, SCRATCH_X, SCRATCH_Y
+
+FLASH_SECTIONS = (".boot2", ".vectors", ".text", ".ramfunc", ".data")
+RAM_SECTIONS = (".ramfunc", ".data", ".bss", ".noinit")
+STACK_SECTIONS = (".stack0_low", ".scratch_x", ".scratch_y")
+
+STT_OBJECT, STT_FUNC = 1, 2
+
+
+def read_elf(path):
+    with open(path, "rb") as f:
+        elf = f.read()
+    if elf[:4] != b"\x7fELF" or elf[4] != 1 or elf[5] != 1:
+        sys.exit(path + ": not a little-endian ELF32 file")
+
+    shoff, = struct.unpack_from("<I", elf, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from("<HHH", elf, 0x2E)
+    headers = [struct.unpack_from("<IIIIIIIIII", elf, shoff + i * shentsize)
+               for i in range(shnum)]
+
+    def cstr(table, off):
+        return table[off:table.index(b"\0", off)].decode()
+
+    shstr = headers[shstrndx]
+    shstrtab = elf[shstr[4]:shstr[4] + shstr[5]]
+    sections = {cstr(shstrtab, h[0]): h for h in headers}
+
+    symbols = []
+    symtab = sections.get(".symtab")
+    if symtab:
+        strtab_h = headers[symtab[6]]
+        strtab = elf[strtab_h[4]:strtab_h[4] + strtab_h[5]]
+        for off in range(symtab[4], symtab[4] + symtab[5], 16):
+            name, value, size, info, _other, shndx = \
+                struct.unpack_from("<IIIBBH", elf, off)
+            kind = info & 0xF
+            if size and kind in (STT_OBJECT, STT_FUNC) and shndx:
+                symbols.append((cstr(strtab, name), value & ~1, size, kind))
+    return sections, symbols
+
+
+def section_size(sections, name):
+    h = sections.get(name)
+    return h[5] if h else 0
+
+
+def usage_line(label, used, total, names, sections):
+    detail = "  ".join("%s %d" % (n, section_size(sections, n))
+                       for n in names if section_size(sections, n))
+    print("%-6s %8d / %8d bytes (%5.1f%%)   %s"
+          % (label, used, total, 100.0 * used / total, detail))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("elf")
+    ap.add_argument("--top", type=int, default=10)
+    args = ap.parse_args()
+
+    sections, symbols = read_elf(args.elf)
+
+    flash = sum(section_size(sections, n) for n in FLASH_SECTIONS)
+    ram = sum(section_size(sections, n) for n in RAM_SECTIONS)
+    stacks = sum(section_size(sections, n) for n in STACK_SECTIONS)
+    usage_line("Flash", flash, FLASH_BYTES, FLASH_SECTIONS, sections)
+    usage_line("RAM", ram, RAM_BYTES, RAM_SECTIONS, sections)
+    usage_line("Stacks", stacks, STACK_BYTES, STACK_SECTIONS, sections)
+
+    # Weak aliases share an address with Default_Handler: report it once
+    seen = set()
+    unique = []
+    for sym in sorted(symbols, key=lambda s: (-s[2], s[0])):
+        if (sym[1], sym[3]) not in seen:
+            seen.add((sym[1], sym[3]))
+            unique.append(sym)
+
+    for kind, title in ((STT_FUNC, "functions"), (STT_OBJECT, "objects")):
+        print("\nLargest %s:" % title)
+        for name, addr, size, _ in [s for s in unique if s[3] == kind][:args.top]:
+            print("  %6d  0x%08x  %s" % (size, addr, name))
+
+    print("\nHandlers (RAM = no XIP cache misses on entry):")
+    by_addr = {}
+    for name, addr, size, kind in symbols:
+        if kind == STT_FUNC and name.endswith("_Handler"):
+            by_addr.setdefault((addr, size), []).append(name)
+    for (addr, size), names in sorted(by_addr.items(),
+                                      key=lambda kv: min(kv[1])):
+        names.sort()
+        # The unused vectors are weak aliases of one Default_Handler
+        label = names[0] if len(names) == 1 else \
+            "%s (+%d aliases)" % ("Default_Handler" if "Default_Handler"
+                                  in names else names[0], len(names) - 1)
+        where = "RAM" if addr >= 0x20000000 else "Flash"
+        print("  %6d  %-5s  %s" % (size, where, label))
+
+if __name__ == "__main__":
+    main()